@@ -12,7 +12,7 @@ independent of each other.
 	Each node is assigned to its own level. blah blah blah, pigeon-holes nodes too much
 
 	The 'cutline' method of reachability analysis builds on top of a topological traversal of the subraph. Hence
-the constituent functions are meant to be passed-in to a topological traversal function (see topological_traversal.h)
+the constituent functions make up a policy class with which the topological traversal is specialized (see topological_traversal.h)
 
 //TODO: how are levels calculated? etc
 */
@@ -26,6 +26,32 @@ using namespace std;
 
 
 
+/**** Classes ****/
+/* Topological traversal policy for the cutline method (see topological_traversal.h). The direction of traversal is a template parameter */
+template <e_traversal_dir TRAVERSAL_DIR> class Cutline_Policy{
+public:
+	static const e_traversal_dir traversal_dir = TRAVERSAL_DIR;
+
+	Cutline_Structs *structs;
+
+	Cutline_Policy(Cutline_Structs *set_structs){
+		this->structs = set_structs;
+	}
+
+	/* Called when node is popped from expansion queue during topological traversal */
+	void node_popped(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+	                 int max_path_weight, User_Options *user_opts);
+
+	/* Called when topological traversal is iterateing over a node's children */
+	bool child_iterated(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+	                    int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts);
+
+	/* Called once topological traversal is complete */
+	void traversal_done(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+	                    int max_path_weight, User_Options *user_opts);
+};
+
+
 /**** Function Declarations ****/
 /* adds specified node to the cutline probability structure according to the node's level in the topological traversal */
 static void add_node_to_cutline_structure(int node_ind, t_node_topo_inf &node_topo_inf, t_cutline_prob_struct &cutline_probability_struct);
@@ -38,18 +64,37 @@ static float connection_probability_cutlines(int from_node_ind, int to_node_ind,
 
 
 /**** Function Definitions ****/
+/* Runs the cutline analysis with a topological traversal from 'from_node_ind' towards 'to_node_ind' in the specified direction.
+   The traversal is specialized for the direction */
+void do_cutline_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+			Nodes_Waiting_Heap &nodes_waiting, e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts,
+			Cutline_Structs &cutline_structs){
+
+	if (traversal_dir == FORWARD_TRAVERSAL){
+		Cutline_Policy<FORWARD_TRAVERSAL> policy(&cutline_structs);
+		do_topological_traversal(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf, nodes_waiting, max_path_weight, user_opts, policy);
+	} else {
+		Cutline_Policy<BACKWARD_TRAVERSAL> policy(&cutline_structs);
+		do_topological_traversal(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf, nodes_waiting, max_path_weight, user_opts, policy);
+	}
+}
+
+
+/*==== Cutline_Policy Class ====*/
 /* Called when node is popped from expansion queue during topological traversal */
-void cutline_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
+template <e_traversal_dir TRAVERSAL_DIR>
+void Cutline_Policy<TRAVERSAL_DIR>::node_popped(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+			t_node_topo_inf &node_topo_inf, int max_path_weight, User_Options *user_opts){
 	
 	//cout << "popped node: " << popped_node << endl;
-	Cutline_Structs *cutline_structs = (Cutline_Structs*)user_data;
+	Cutline_Structs *cutline_structs = this->structs;
 	add_node_to_cutline_structure(popped_node, node_topo_inf, cutline_structs->cutline_prob_struct);
 }
 
 /* Called when topological traversal is iterateing over a node's children */
-bool cutline_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-                          e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data){
+template <e_traversal_dir TRAVERSAL_DIR>
+bool Cutline_Policy<TRAVERSAL_DIR>::child_iterated(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+			t_node_topo_inf &node_topo_inf, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts){
 
 	bool ignore_node = false;
 
@@ -60,14 +105,16 @@ bool cutline_child_iterated_func(int parent_ind, int parent_edge_ind, int node_i
 
 /* Called once topological traversal is complete.
    Calculates probability of a source/sink connection being routable */
-void cutline_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
+template <e_traversal_dir TRAVERSAL_DIR>
+void Cutline_Policy<TRAVERSAL_DIR>::traversal_done(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+			t_node_topo_inf &node_topo_inf, int max_path_weight, User_Options *user_opts){
 	
-	Cutline_Structs *cutline_structs = (Cutline_Structs*)user_data;
+	Cutline_Structs *cutline_structs = this->structs;
 	float prob_routable = connection_probability_cutlines(from_node_ind, to_node_ind, rr_node, node_topo_inf, cutline_structs, user_opts);
 
 	cutline_structs->prob_routable = prob_routable;
 }
+/*==== END Cutline_Policy Class ====*/
 
 
 /* adds specified node to the cutline probability structure according to the node's level in the topological traversal */
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include "wotan_types.h"
+#include "topological_traversal.h"
 
 
 /**** Typedefs ****/
@@ -23,17 +24,11 @@ public:
 
 
 /**** Function Declarations ****/
-/* Called when node is popped from expansion queue during topological traversal */
-void cutline_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
-
-/* Called when topological traversal is iterateing over a node's children */
-bool cutline_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-                          e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data);
-
-/* Called once topological traversal is complete */
-void cutline_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
+/* Runs the cutline analysis with a topological traversal from 'from_node_ind' towards 'to_node_ind' in the specified direction.
+   The traversal is specialized for the direction */
+void do_cutline_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+			Nodes_Waiting_Heap &nodes_waiting, e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts,
+			Cutline_Structs &cutline_structs);
 
 
 #endif
@@ -5,7 +5,7 @@ through the routing resource graph.
 	blah blah
 
 	The 'cutline recursive' method of reachability analysis builds on top of a topological traversal of the subraph. Hence
-the constituent functions are meant to be passed-in to a topological traversal function (see topological_traversal.h)
+the constituent functions make up a policy class with which the topological traversal is specialized (see topological_traversal.h)
 
 */
 
@@ -20,6 +20,32 @@ using namespace std;
 
 
 
+/**** Classes ****/
+/* Topological traversal policy for the 'cutline recursive' method (see topological_traversal.h). The direction of traversal is a template parameter */
+template <e_traversal_dir TRAVERSAL_DIR> class Cutline_Recursive_Policy{
+public:
+	static const e_traversal_dir traversal_dir = TRAVERSAL_DIR;
+
+	Cutline_Recursive_Structs *structs;
+
+	Cutline_Recursive_Policy(Cutline_Recursive_Structs *set_structs){
+		this->structs = set_structs;
+	}
+
+	/* Called when node is popped from expansion queue during topological traversal */
+	void node_popped(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+	                 int max_path_weight, User_Options *user_opts);
+
+	/* Called when topological traversal is iterateing over a node's children */
+	bool child_iterated(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+	                    int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts);
+
+	/* Called once topological traversal is complete */
+	void traversal_done(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+	                    int max_path_weight, User_Options *user_opts);
+};
+
+
 /**** Function Declarations ****/
 /* returns height of node based on node's corresponding ss_distances */
 static int get_node_height(SS_Distances &node_ss_distances);
@@ -37,11 +63,31 @@ static float connection_probability_cutlines(t_rr_node &rr_node, Cutline_Recursi
 
 
 /**** Function Definitions ****/
+/* Runs the 'cutline recursive' analysis with a topological traversal from 'from_node_ind' towards 'to_node_ind' in the specified direction.
+   The traversal is specialized for the direction */
+void do_cutline_recursive_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+			Nodes_Waiting_Heap &nodes_waiting, e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts,
+			Cutline_Recursive_Structs &cutline_rec_structs){
+
+	cutline_rec_structs.nodes_waiting = &nodes_waiting;
+
+	if (traversal_dir == FORWARD_TRAVERSAL){
+		Cutline_Recursive_Policy<FORWARD_TRAVERSAL> policy(&cutline_rec_structs);
+		do_topological_traversal(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf, nodes_waiting, max_path_weight, user_opts, policy);
+	} else {
+		Cutline_Recursive_Policy<BACKWARD_TRAVERSAL> policy(&cutline_rec_structs);
+		do_topological_traversal(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf, nodes_waiting, max_path_weight, user_opts, policy);
+	}
+}
+
+
+/*==== Cutline_Recursive_Policy Class ====*/
 /* Called when node is popped from expansion queue during topological traversal */
-void cutline_recursive_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
+template <e_traversal_dir TRAVERSAL_DIR>
+void Cutline_Recursive_Policy<TRAVERSAL_DIR>::node_popped(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+			t_node_topo_inf &node_topo_inf, int max_path_weight, User_Options *user_opts){
 
-	Cutline_Recursive_Structs *cutline_rec_structs = (Cutline_Recursive_Structs*)user_data;
+	Cutline_Recursive_Structs *cutline_rec_structs = this->structs;
 	int relative_level = UNDEFINED;
 
 	/* get node's height relative to root node of this traversal */
@@ -77,7 +123,7 @@ void cutline_recursive_node_popped_func(int popped_node, int from_node_ind, int
 			/* at same height as root --> level is relative hops from root */
 			relative_level = relative_source_hops;
 		} else {
-			if ( has_parents_of_height(popped_node, node_height, rr_node, ss_distances, traversal_dir, max_path_weight) ){
+			if ( has_parents_of_height(popped_node, node_height, rr_node, ss_distances, TRAVERSAL_DIR, max_path_weight) ){
 				/* not the first node of its height */
 				relative_level = relative_source_hops - relative_height;
 			} else {
@@ -92,17 +138,20 @@ void cutline_recursive_node_popped_func(int popped_node, int from_node_ind, int
 				new_cutline_rec_structs.sink_ind = cutline_rec_structs->sink_ind;
 				new_cutline_rec_structs.fill_type = cutline_rec_structs->fill_type;
 
+				/* the enclosing traversal's cycle-breaking heap is still in use, so the recursive traversal uses the heap
+				   nested in it. that heap is reused by every recursion at this depth */
+				Nodes_Waiting_Heap &recursive_nodes_waiting = cutline_rec_structs->nodes_waiting->get_nested_heap();
+				new_cutline_rec_structs.nodes_waiting = &recursive_nodes_waiting;
+
 				/* back up topo inf for this node */
 				Topo_Inf_Backup node_backup;
 				node_backup.backup(popped_node, node_topo_inf);
 				node_backup.clear_node_topo_inf(node_topo_inf);
 
 				/* RECURSE on this node */
-				do_topological_traversal(popped_node, to_node_ind, rr_node, ss_distances, node_topo_inf, traversal_dir,
-							max_path_weight, user_opts, (void*)&new_cutline_rec_structs,
-							cutline_recursive_node_popped_func,
-						 	cutline_recursive_child_iterated_func,
-							cutline_recursive_traversal_done_func);
+				Cutline_Recursive_Policy<TRAVERSAL_DIR> recursive_policy(&new_cutline_rec_structs);
+				do_topological_traversal(popped_node, to_node_ind, rr_node, ss_distances, node_topo_inf, recursive_nodes_waiting,
+							max_path_weight, user_opts, recursive_policy);
 
 				/* resture this node's backed up info */
 				node_backup.restore(node_topo_inf);
@@ -146,10 +195,11 @@ void cutline_recursive_node_popped_func(int popped_node, int from_node_ind, int
 
 
 /* Called when topological traversal is iterateing over a node's children */
-bool cutline_recursive_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-                          e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data){
+template <e_traversal_dir TRAVERSAL_DIR>
+bool Cutline_Recursive_Policy<TRAVERSAL_DIR>::child_iterated(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+			t_node_topo_inf &node_topo_inf, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts){
 
-	Cutline_Recursive_Structs *cutline_rec_structs = (Cutline_Recursive_Structs*)user_data;
+	Cutline_Recursive_Structs *cutline_rec_structs = this->structs;
 	bool ignore_node = false;
 
 	/* check height/levels of children */
@@ -201,15 +251,17 @@ bool cutline_recursive_child_iterated_func(int parent_ind, int parent_edge_ind,
 
 /* Called once topological traversal is complete.
    Calculates probability of a source/sink connection being routable */
-void cutline_recursive_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
+template <e_traversal_dir TRAVERSAL_DIR>
+void Cutline_Recursive_Policy<TRAVERSAL_DIR>::traversal_done(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+			t_node_topo_inf &node_topo_inf, int max_path_weight, User_Options *user_opts){
 	/* compute probability that connection is routable. also restore backed-up node inf's */
-	Cutline_Recursive_Structs *cutline_rec_structs = (Cutline_Recursive_Structs*)user_data;
+	Cutline_Recursive_Structs *cutline_rec_structs = this->structs;
 
 	float routable = connection_probability_cutlines(rr_node, cutline_rec_structs, node_topo_inf,
 	                                               cutline_rec_structs->topo_inf_backups, cutline_rec_structs->recurse_level, ss_distances, user_opts);
 	cutline_rec_structs->prob_routable = routable;
 }
+/*==== END Cutline_Recursive_Policy Class ====*/
 
 
 /* returns height of node based on node's corresponding ss_distances */
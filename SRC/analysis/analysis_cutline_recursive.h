@@ -4,6 +4,7 @@
 #include <vector>
 #include <map>
 #include "wotan_types.h"
+#include "topological_traversal.h"
 
 /**** Forward-Declares ****/
 class Topo_Inf_Backup;
@@ -64,22 +65,18 @@ public:
 	int sink_ind;
 	/* the physical type descriptor for the 'fill' type block (i.e. the CLB) */
 	Physical_Type_Descriptor *fill_type;
+	/* the cycle-breaking heap of the current topological traversal. recursive traversals use its nested heap */
+	Nodes_Waiting_Heap *nodes_waiting;
 
 };
 
 
 /**** Function Declarations ****/
-/* Called when node is popped from expansion queue during topological traversal */
-void cutline_recursive_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
-
-/* Called when topological traversal is iterateing over a node's children */
-bool cutline_recursive_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-                          e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data);
-
-/* Called once topological traversal is complete */
-void cutline_recursive_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
+/* Runs the 'cutline recursive' analysis with a topological traversal from 'from_node_ind' towards 'to_node_ind' in the specified direction.
+   The traversal is specialized for the direction */
+void do_cutline_recursive_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+			Nodes_Waiting_Heap &nodes_waiting, e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts,
+			Cutline_Recursive_Structs &cutline_rec_structs);
 
 
 #endif
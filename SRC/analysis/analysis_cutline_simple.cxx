@@ -5,7 +5,7 @@ through the routing resource graph.
 	blah blah blah
 
 	The 'cutline_simple' method of reachability analysis builds on top of a topological traversal of the subraph. Hence
-the constituent functions are meant to be passed-in to a topological traversal function (see topological_traversal.h)
+the constituent functions make up a policy class with which the topological traversal is specialized (see topological_traversal.h)
 
 */
 
@@ -19,17 +19,61 @@ using namespace std;
 
 
 
+/**** Classes ****/
+/* Topological traversal policy for the cutline_simple method (see topological_traversal.h). The direction of traversal is a template parameter */
+template <e_traversal_dir TRAVERSAL_DIR> class Cutline_Simple_Policy{
+public:
+	static const e_traversal_dir traversal_dir = TRAVERSAL_DIR;
+
+	Cutline_Simple_Structs *structs;
+
+	Cutline_Simple_Policy(Cutline_Simple_Structs *set_structs){
+		this->structs = set_structs;
+	}
+
+	/* Called when node is popped from expansion queue during topological traversal */
+	void node_popped(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+	                 int max_path_weight, User_Options *user_opts);
+
+	/* Called when topological traversal is iterateing over a node's children */
+	bool child_iterated(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+	                    int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts);
+
+	/* Called once topological traversal is complete */
+	void traversal_done(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+	                    int max_path_weight, User_Options *user_opts);
+};
+
+
 /**** Function Declarations ****/
 /* returns estimate of probability that sink is reachable from source */
 static float get_prob_reachable(t_rr_node &rr_node, int from_node_ind, int to_node_ind, Cutline_Simple_Structs *cutline_simple_structs, User_Options *user_opts);
 
 
 /**** Function Definitions ****/
+/* Runs the cutline_simple analysis with a topological traversal from 'from_node_ind' towards 'to_node_ind' in the specified direction.
+   The traversal is specialized for the direction */
+void do_cutline_simple_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+			Nodes_Waiting_Heap &nodes_waiting, e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts,
+			Cutline_Simple_Structs &cutline_simple_structs){
+
+	if (traversal_dir == FORWARD_TRAVERSAL){
+		Cutline_Simple_Policy<FORWARD_TRAVERSAL> policy(&cutline_simple_structs);
+		do_topological_traversal(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf, nodes_waiting, max_path_weight, user_opts, policy);
+	} else {
+		Cutline_Simple_Policy<BACKWARD_TRAVERSAL> policy(&cutline_simple_structs);
+		do_topological_traversal(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf, nodes_waiting, max_path_weight, user_opts, policy);
+	}
+}
+
+
+/*==== Cutline_Simple_Policy Class ====*/
 /* Called when node is popped from expansion queue during topological traversal */
-void cutline_simple_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
+template <e_traversal_dir TRAVERSAL_DIR>
+void Cutline_Simple_Policy<TRAVERSAL_DIR>::node_popped(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+			t_node_topo_inf &node_topo_inf, int max_path_weight, User_Options *user_opts){
 
-	Cutline_Simple_Structs *cutline_simple_structs = (Cutline_Simple_Structs*)user_data;
+	Cutline_Simple_Structs *cutline_simple_structs = this->structs;
 
 	if (popped_node == from_node_ind || popped_node == to_node_ind){
 		return;
@@ -83,8 +127,9 @@ void cutline_simple_node_popped_func(int popped_node, int from_node_ind, int to_
 }
 
 /* Called when topological traversal is iterateing over a node's children */
-bool cutline_simple_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-                          e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data){
+template <e_traversal_dir TRAVERSAL_DIR>
+bool Cutline_Simple_Policy<TRAVERSAL_DIR>::child_iterated(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+			t_node_topo_inf &node_topo_inf, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts){
 	bool ignore_node = false;
 
 	return ignore_node;
@@ -92,16 +137,18 @@ bool cutline_simple_child_iterated_func(int parent_ind, int parent_edge_ind, int
 
 /* Called once topological traversal is complete.
    Calculates probability of a source/sink connection being routable */
-void cutline_simple_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
+template <e_traversal_dir TRAVERSAL_DIR>
+void Cutline_Simple_Policy<TRAVERSAL_DIR>::traversal_done(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+			t_node_topo_inf &node_topo_inf, int max_path_weight, User_Options *user_opts){
 
-	Cutline_Simple_Structs *cutline_simple_structs = (Cutline_Simple_Structs*)user_data;
+	Cutline_Simple_Structs *cutline_simple_structs = this->structs;
 
 
 	float prob_routable = get_prob_reachable( rr_node, from_node_ind, to_node_ind, cutline_simple_structs, user_opts );
 
 	cutline_simple_structs->prob_routable = prob_routable;
 }
+/*==== END Cutline_Simple_Policy Class ====*/
 
 
 /* returns estimate of probability that sink is reachable from source */
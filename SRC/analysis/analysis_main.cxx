@@ -1,11 +1,16 @@
 
 #include <cstdlib>
+#include <cstring>
 #include <cmath>
 #include <algorithm>
 #include <queue>
 #include <set>
+#include <map>
 #include <utility>
 #include <functional>
+#include <sstream>
+#include <atomic>
+#include <chrono>
 #include <pthread.h>
 #include <malloc.h>
 #include "globals.h"
@@ -53,9 +58,30 @@ using namespace std;
 
 #define FRACTION_CONNS 0.1
 
+/* number of source/sink pairs that a thread claims at a time from its own (or another thread's) list of connections */
+#define PAIR_CHUNK_SIZE 4
+
+/* used to keep data written by different threads on separate cache lines */
+#define CACHE_LINE_SIZE 64
+
+/* megabytes of distance fields kept by each thread's distance cache in the modes where connections are analyzed again with the same
+   node weights, unless the user specifies otherwise (see get_distance_cache_mb) */
+#define DEFAULT_DISTANCE_CACHE_MB 64
+
+/* the demand multiplier search (see search_for_demand_multiplier) starts at this multiplier, unless the user provides a starting
+   point. from there it grows/shrinks the multiplier by the given factor until the target reliability is bracketed. a user-provided
+   starting point is usually close (i.e. the result for a neighbouring architecture), so a narrower factor is used in that case */
+#define SEARCH_DEFAULT_START_MULTIPLIER 100.0
+#define SEARCH_BRACKET_FACTOR 2.0
+#define SEARCH_WARM_START_BRACKET_FACTOR 1.25
+/* the search gives up once the bracket around the required multiplier is narrower than this fraction of the multiplier
+   (reliability is not a continuous function of the multiplier because node weights are rounded) */
+#define SEARCH_MIN_BRACKET_FRACTION 1e-4
+
 
 /************ Forward-Declarations ************/
 class Conn_Info;
+class Source_Batch;
 
 
 
@@ -88,18 +114,21 @@ enum e_probability_mode{
 typedef vector< t_ss_distances > t_thread_ss_distances;
 /* a t_node_topo_inf structure for each thread */
 typedef vector< t_node_topo_inf > t_thread_node_topo_inf;
-/* a list of nodes visited during path enumeration */
-typedef vector< int > t_nodes_visited;
-/* a t_nodes_visited structure for each thread */
-typedef vector< t_nodes_visited > t_thread_nodes_visited;
+/* priority queue used to set source/sink distances of nodes (see set_node_distances) */
+typedef My_Monotone_Bucket_Queue< int > t_distance_pq;
+/* a t_distance_pq structure for each thread */
+typedef vector< t_distance_pq > t_thread_distance_pqs;
 /* contains pthread info for each thread */
 typedef vector< pthread_t > t_threads;
 
-/* A structure that is used to break cycles during topological traversal. Objects of the
-   Node_Waiting class are put on this sorted structure, and if the traditional expansion queue 
-   becomes empty during topological traversal, this structure is used to get the next node on which
-   to expand */
-typedef set< Node_Waiting > t_nodes_waiting;
+/* a heap used to break cycles during topological traversal (see Nodes_Waiting_Heap), for each thread */
+typedef vector< Nodes_Waiting_Heap > t_thread_nodes_waiting;
+
+/* the batch of connections whose source distances are currently shared (see Source_Batch), for each thread */
+typedef vector< Source_Batch > t_thread_source_batches;
+
+/* a cache of the distance fields of recently analyzed connections (see Distance_Cache), for each thread */
+typedef vector< Distance_Cache > t_thread_distance_caches;
 
 /* used to analyze reachability by looking at a percentile of the least routable connections at each length */
 typedef My_Fixed_Size_PQ< float, less<float> > t_lowest_probs_pq;
@@ -118,32 +147,167 @@ public:
 	int sink_ind;
 	int ss_length;		//TODO this and below variable should be computed in "enumerate_paths_from_source". but i was lazy here so i'm wasting memory
 	int source_conns_at_length;
+	int tile_class_ind;	/* if not UNDEFINED, demands enumerated for this connection are replicated to the tiles of this tile class that picked it */
+	vector<int> picking_members;		/* indices (into the members of the tile class) of the tiles that picked this connection. a tile that picked
+						   the connection more than once is listed once per pick (tile symmetry only) */
 };
 
-/* used for multithreading of path enumeration / probability analysis.
-   defines the problem parameters for each thread */
-class Conn_Info{
+/* the connections of one source of a test tile. the connections of a source are always put into the same pair list, in the order
+   in which they were generated (see User_Options::task_order) */
+class Source_Task{
 public:
+	Coordinate tile_coord;
+	e_pin_type pin_type;				/* DRIVER for a regular source, RECEIVER for the virtual source of a sink */
 	vector<Source_Sink_Pair> source_sink_pairs;
-	User_Options *user_opts;
-	Analysis_Settings *analysis_settings;
-	Arch_Structs *arch_structs;
-	Routing_Structs *routing_structs;
-	t_ss_distances *ss_distances;
-	t_node_topo_inf *node_topo_inf;
-	t_nodes_visited *nodes_visited;
-	e_topological_mode topological_mode;
 };
 
+/* a batch of connections that share the distances of nodes from their source (see User_Options::share_source_distances). a batch is
+   a run of consecutive connections of a pair list that have the same source. the distances are found by a single forward traversal
+   which only skips nodes that can't lie on a legal path of any of the batch's connections, and are kept in the thread's t_ss_distances
+   as shared source distances. only valid while node weights don't change */
+class Source_Batch{
+public:
+	vector<Source_Sink_Pair> *source_sink_pairs;	/* the batch is made up of connections [start_pair, end_pair) of this list. NULL if there
+							   is no current batch */
+	int start_pair;
+	int end_pair;
+	int source_ind;
+	bool has_distances;		/* false if the shared distances weren't found because the fields of all connections of the batch were
+					   in the thread's distance cache. connections then find their own source distances on a cache miss */
 
-/* Contains path enumeration & probability analysis results */
-class Analysis_Results{
+	Source_Batch(){
+		this->clear();
+	}
+
+	void clear(){
+		this->source_sink_pairs = NULL;
+		this->start_pair = UNDEFINED;
+		this->end_pair = UNDEFINED;
+		this->source_ind = UNDEFINED;
+		this->has_distances = false;
+	}
+};
+
+/* the connections to be enumerated during one round of path enumeration (see User_Options::enumerate_rounds). 
+   threads claim connections from this structure until none are left */
+class Enumerate_Round{
 public:
-	/* mutex for threads wishing to add to the results */
-	pthread_mutex_t thread_mutex;
-	pthread_barrier_t thread_barrier;
-	int active_threads;
+	vector<Source_Sink_Pair> *source_sink_pairs;
+	int start_pair;				/* the round consists of connections [start_pair, end_pair) of the above list */
+	int end_pair;
+	std::atomic<int> next_pair;		/* next connection to be claimed by a thread */
+
+	/* demands enumerated for each connection of this round [0..end_pair-start_pair-1] */
+	vector< t_demand_increments > demand_increments;
+
+	/* claims the next connection of the round. if 'whole_source' is set, the connections after it that have the same source are
+	   claimed along with it (so that they can share a forward distance traversal). returns false if no connections are left */
+	bool claim(bool whole_source, int *claimed_start_pair, int *claimed_end_pair){
+		int claimed_start = this->next_pair.load();
+		int claimed_end;
+		do {
+			if (claimed_start >= this->end_pair){
+				return false;
+			}
+			claimed_end = claimed_start + 1;
+			if (whole_source){
+				vector<Source_Sink_Pair> &pairs = *this->source_sink_pairs;
+				while (claimed_end < this->end_pair && pairs[claimed_end].source_ind == pairs[claimed_start].source_ind){
+					claimed_end++;
+				}
+			}
+		} while ( !this->next_pair.compare_exchange_weak(claimed_start, claimed_end) );
+
+		*claimed_start_pair = claimed_start;
+		*claimed_end_pair = claimed_end;
+		return true;
+	}
+};
+
+/* the not-yet-claimed part [next_pair, end_pair) of a thread's list of source/sink pairs. the owning thread claims chunks
+   of pairs from the front; threads that have run out of their own pairs steal chunks from the back */
+class Pair_Queue{
+public:
+	int next_pair;
+	int end_pair;
+	pthread_mutex_t mutex;
+
+	Pair_Queue(){
+		this->next_pair = 0;
+		this->end_pair = 0;
+		pthread_mutex_init(&this->mutex, NULL);
+	}
+	Pair_Queue(const Pair_Queue &obj){
+		this->next_pair = obj.next_pair;
+		this->end_pair = obj.end_pair;
+		pthread_mutex_init(&this->mutex, NULL);
+	}
+	~Pair_Queue(){
+		pthread_mutex_destroy(&this->mutex);
+	}
+
+	/* claims up to 'num_pairs' pairs from the front (or back) of the queue. returns false if the queue is empty */
+	bool claim(int num_pairs, bool from_front, int *start_pair, int *end_pair_claimed){
+		bool claimed = false;
+		pthread_mutex_lock(&this->mutex);
+		int num_claimed = min(num_pairs, this->end_pair - this->next_pair);
+		if (num_claimed > 0){
+			if (from_front){
+				*start_pair = this->next_pair;
+				this->next_pair += num_claimed;
+			} else {
+				this->end_pair -= num_claimed;
+				*start_pair = this->end_pair;
+			}
+			*end_pair_claimed = *start_pair + num_claimed;
+			claimed = true;
+		}
+		pthread_mutex_unlock(&this->mutex);
+		return claimed;
+	}
+};
+
+/* per-thread work statistics */
+class Thread_Work_Stats{
+public:
+	double busy_seconds;		/* time spent analyzing connections */
+	int num_pairs;			/* number of source/sink pairs analyzed */
+	int num_stolen_pairs;		/* number of those pairs that were taken from other threads' lists */
+
+	/* locality of the analyzed connections. the closer together the sources of consecutive connections are, the more of the
+	   same nodes those connections go through while their data is still in the CPU caches */
+	int last_source_ind;		/* source of the last connection analyzed */
+	int num_source_changes;		/* number of connections whose source differed from that of the previous connection */
+	long source_change_tiles;	/* sum of the manhattan distances (in tiles) between the two sources at each of those changes */
+
+	Thread_Work_Stats(){
+		this->busy_seconds = 0;
+		this->num_pairs = 0;
+		this->num_stolen_pairs = 0;
+		this->last_source_ind = UNDEFINED;
+		this->num_source_changes = 0;
+		this->source_change_tiles = 0;
+	}
+
+	/* records that the next connection analyzed by the thread starts at the specified source */
+	void record_source(int source_ind, t_rr_node &rr_node){
+		if (source_ind == this->last_source_ind){
+			return;
+		}
 
+		if (this->last_source_ind != UNDEFINED){
+			RR_Node &last_source = rr_node[this->last_source_ind];
+			RR_Node &source = rr_node[source_ind];
+			this->num_source_changes++;
+			this->source_change_tiles += abs(source.get_xlow() - last_source.get_xlow()) + abs(source.get_ylow() - last_source.get_ylow());
+		}
+		this->last_source_ind = source_ind;
+	}
+};
+
+/* probability totals of the routability analysis */
+class Probability_Totals{
+public:
 	/* maximum possible total weighted probability is ALL connections have a 100% chance of routing (used to normalize analysis) */
 	double max_possible_total_prob_drivers;
 	double max_possible_total_prob_fanout;
@@ -152,36 +316,154 @@ public:
 	double total_prob_drivers;
 	double total_prob_fanout;
 
+	Probability_Totals(){
+		this->max_possible_total_prob_drivers = 0;
+		this->max_possible_total_prob_fanout = 0;
+		this->total_prob_drivers = 0;
+		this->total_prob_fanout = 0;
+	}
+
+	void add(const Probability_Totals &obj){
+		this->max_possible_total_prob_drivers += obj.max_possible_total_prob_drivers;
+		this->max_possible_total_prob_fanout += obj.max_possible_total_prob_fanout;
+		this->total_prob_drivers += obj.total_prob_drivers;
+		this->total_prob_fanout += obj.total_prob_fanout;
+	}
+};
+
+/* Contains path enumeration & probability analysis results */
+class Analysis_Results{
+public:
+	pthread_barrier_t thread_barrier;
+	int active_threads;
+
+	Probability_Totals totals;
+
 	/* used to analyze routability by looking at only x% worst possible (least routable) connections at
 	   each length. the idea is that bad routability of a minor fraction of all connections is sufficient
 	   to make an architecture unroutable */
 	vector< t_lowest_probs_pq > lowest_probs_pqs_drivers;	/* for paths enumerated from drivers (i.e. regular sources + opins) */
 	vector< t_lowest_probs_pq > lowest_probs_pqs_fanout;	/* for paths enumerated for fanout purposes (via virtual sources */
 
+	/* the same queues for each demand multiplier of User_Options::demand_multiplier_list [0..num_multipliers-1][0..max_conn_length] */
+	vector< vector<t_lowest_probs_pq> > multiplier_lowest_probs_pqs_drivers;
+	vector< vector<t_lowest_probs_pq> > multiplier_lowest_probs_pqs_fanout;
 
 	/* total number of connections that we WANT to analyze */
 	int desired_conns;
 	/* total number of connections that we ACTUALLY analyzed (maybe some connections were unroutable so we just couldn't enumerate paths from them, etc) */
 	int num_conns;
 
+	/* sum of the (adjusted) maximum path weights of the enumerated connections */
+	double total_adjusted_enum_path_weight;
+
+	/* differences between the connection probabilities computed with single- and double-precision buckets
+	   (only kept if User_Options::bucket_precision is PRECISION_COMPARE) */
+	int precision_conns;			/* number of connections analyzed at both precisions */
+	double precision_abs_error_sum;		/* sum of the absolute differences */
+	double precision_max_abs_error;		/* largest absolute difference */
+
 	/* constructor to initialize constituent variables to 0 */
 	Analysis_Results(){
 
-		this->max_possible_total_prob_drivers = 0;
-		this->max_possible_total_prob_fanout = 0;
-		this->total_prob_drivers = 0;
-		this->total_prob_fanout = 0;
 		this->desired_conns = 0;
 		this->num_conns = 0;
+		this->total_adjusted_enum_path_weight = 0;
+		this->precision_conns = 0;
+		this->precision_abs_error_sum = 0;
+		this->precision_max_abs_error = 0;
+	}
+};
+
+/* the analysis results of a single thread, which are merged into the overall results once all threads are done.
+   padded so that they don't share a cache line with data written by other threads */
+class Partial_Analysis_Results{
+public:
+	char front_padding[CACHE_LINE_SIZE];
+	Analysis_Results results;
+	char back_padding[CACHE_LINE_SIZE];
+};
+
+/* used for multithreading of path enumeration / probability analysis.
+   defines the problem parameters for each thread */
+class Conn_Info{
+public:
+	vector<Source_Sink_Pair> source_sink_pairs;
+	Pair_Queue pair_queue;			/* the pairs of 'source_sink_pairs' that haven't been claimed by any thread yet */
+	Enumerate_Round *enumerate_round;	/* if not NULL, the thread enumerates connections of this round instead of those in 'source_sink_pairs' */
+	int thread_ind;
+	vector<Conn_Info> *thread_conn_info;	/* problem parameters of all threads. used to steal pairs from other threads */
+	Thread_Work_Stats work_stats;
+	Partial_Analysis_Results partial_results;	/* results of the connections analyzed by this thread */
+	vector<Probability_Totals> pair_totals;		/* probability totals of each pair in 'source_sink_pairs' (written by whichever thread analyzed the pair) */
+	User_Options *user_opts;
+	Analysis_Settings *analysis_settings;
+	Arch_Structs *arch_structs;
+	Routing_Structs *routing_structs;
+	t_ss_distances *ss_distances;
+	t_node_topo_inf *node_topo_inf;
+	t_distance_pq *distance_pq;
+	Nodes_Waiting_Heap *nodes_waiting;
+	Source_Batch *source_batch;		/* NULL if each connection does its own forward distance traversal */
+	Distance_Cache *distance_cache;		/* NULL if distance fields aren't cached */
+	e_topological_mode topological_mode;
+};
+
+
+/* A pool of worker threads that is kept for the duration of the analysis. Each analysis phase (path enumeration, probability
+   analysis, enumeration rounds, demand multiplier search iterations) posts a job to the pool instead of creating new threads.
+   The pool also owns the per-thread structures used to analyze connections */
+class Thread_Pool{
+public:
+	t_threads threads;
+	vector<int> thread_inds;	/* argument passed to each worker thread */
+
+	pthread_mutex_t mutex;
+	pthread_cond_t job_cond;	/* signalled when a new job is posted, or when the pool is being shut down */
+	pthread_cond_t done_cond;	/* signalled when the last thread finishes its part of the current job */
+	t_thread_conn_info *job;	/* problem parameters of the current job, for each thread */
+	int job_number;			/* incremented with each job that is posted */
+	int num_threads_done;		/* number of threads that have finished the current job */
+	bool shutting_down;
+
+	/* per-thread workspaces. these are cleaned after each connection is analyzed (see clean_node_data_structs),
+	   so they can be reused between jobs without reallocation */
+	t_thread_ss_distances thread_ss_distances;
+	t_thread_node_topo_inf thread_node_topo_inf;
+	t_thread_distance_pqs thread_distance_pqs;
+	t_thread_nodes_waiting thread_nodes_waiting;
+	t_thread_source_batches thread_source_batches;
+	t_thread_distance_caches thread_distance_caches;
+	int workspace_num_nodes;
+	int workspace_max_path_weight_bound;
+
+	Thread_Pool(){
+		pthread_mutex_init(&this->mutex, NULL);
+		pthread_cond_init(&this->job_cond, NULL);
+		pthread_cond_init(&this->done_cond, NULL);
+		this->job = NULL;
+		this->job_number = 0;
+		this->num_threads_done = 0;
+		this->shutting_down = false;
+		this->workspace_num_nodes = UNDEFINED;
+		this->workspace_max_path_weight_bound = UNDEFINED;
+	}
+	~Thread_Pool(){
+		pthread_cond_destroy(&this->done_cond);
+		pthread_cond_destroy(&this->job_cond);
+		pthread_mutex_destroy(&this->mutex);
 	}
 };
 
 
 /************ File-Scope Variables ************/
 /* Structure containing relevant results for path enumeration and routability analysis.
-   It can be written to by different threads with the help of the thread_mutex member variable */
+   Threads accumulate their own partial results, which are merged into this structure once the threads are done */
 static Analysis_Results f_analysis_results = Analysis_Results();
 
+/* Worker threads (and their workspaces) used for path enumeration & probability analysis */
+static Thread_Pool f_thread_pool;
+
 
 /************ Function Declarations ************/
 /* performs routability analysis on an FPGA architecture */
@@ -192,6 +474,14 @@ static void analyze_fpga_architecture(User_Options *user_opts, Analysis_Settings
 static void analyze_simple_graph(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, 
 			Routing_Structs *routing_structs);
 
+/* searches for the demand multiplier at which reliability is equal to user_opts->target_reliability */
+static void search_for_demand_multiplier(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, 
+			Routing_Structs *routing_structs);
+
+/* resets node demands and analyzes the architecture at the specified demand multiplier. returns the resulting reliability */
+static float analyze_at_demand_multiplier(double demand_multiplier, int try_num, User_Options *user_opts, Analysis_Settings *analysis_settings,
+			Arch_Structs *arch_structs, Routing_Structs *routing_structs);
+
 /* enumerates paths from test tiles */
 float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, 
 			Routing_Structs *routing_structs, e_topological_mode topological_mode);
@@ -200,8 +490,57 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 static void get_corresponding_sink_ids(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, Routing_Structs *routing_structs,
 		int source_node_ind, Coordinate tile_coord, vector<int> &sink_indices, vector<int> &ss_length, vector<int> &source_conns_at_length);
 
-/* launched the specified number of threads to perform path enumeration */
-void launch_pthreads(t_thread_conn_info &thread_conn_info, t_threads &threads, int num_threads);
+/* picks the sinks of a source at the representative of a tile class the same way as it is done for every tile of the class, and returns the
+   union of the picked connections (relative to the representative). 'picking_members' is set to the class tiles that picked each connection */
+static void get_tile_class_sink_ids(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, Routing_Structs *routing_structs,
+		int source_node_ind, Tile_Class &tile_class, vector<int> &sink_indices, vector<int> &ss_length, vector<int> &source_conns_at_length,
+		vector< vector<int> > &picking_members);
+
+/* starts the specified number of worker threads in the thread pool (if the pool isn't already running with that many threads) */
+static void start_thread_pool(int num_threads);
+
+/* shuts down the worker threads of the thread pool and frees the per-thread workspaces */
+static void stop_thread_pool();
+
+/* loop run by each worker thread of the thread pool. waits for jobs and analyzes this thread's part of each job */
+static void* thread_pool_worker( void *ptr );
+
+/* returns the number of megabytes of distance fields that each thread's distance cache should keep */
+static int get_distance_cache_mb(User_Options *user_opts);
+
+/* allocates the per-thread workspaces of the thread pool, unless workspaces of the right size already exist */
+static void alloc_thread_workspaces(User_Options *user_opts, Routing_Structs *routing_structs, Arch_Structs *arch_structs, int max_path_weight_bound);
+
+/* has the threads of the thread pool perform path enumeration / probability analysis. returns once all threads are done */
+void launch_pthreads(t_thread_conn_info &thread_conn_info);
+
+/* claims the next chunk of source/sink pairs to be analyzed by the specified thread -- from the thread's own list if any are left, or else
+   from the list of another thread. returns false if no pairs are left */
+static bool claim_pairs(Conn_Info *conn_info, Conn_Info **pair_owner, int *start_pair, int *end_pair);
+
+/* prints how long each thread was busy/idle while analyzing connections */
+static void print_thread_work_stats(t_thread_conn_info &thread_conn_info, double elapsed_seconds);
+
+/* prints how far apart, on average, the sources of consecutive connections of a thread were */
+static void print_task_locality_stats(t_thread_conn_info &thread_conn_info);
+
+/* puts the connections of the specified sources into the first 'num_pair_lists' pair lists of the threads, in the order given by
+   'task_order' */
+static void assign_source_tasks(vector<Source_Task> &source_tasks, e_task_order task_order, int grid_size_x, int grid_size_y,
+			t_thread_conn_info &thread_conn_info, int num_pair_lists);
+/* tells the distance cache of each thread (if any) which node weights the upcoming job analyzes connections with */
+static void set_distance_cache_weight_snapshots(t_thread_conn_info &thread_conn_info, t_rr_node &rr_node);
+
+/* prints how many of the distance field lookups of the last job hit the thread distance caches, and resets the counts */
+static void print_distance_cache_stats(t_thread_conn_info &thread_conn_info);
+
+/* enumerates paths for the specified connections in rounds. node weights are fixed during each round; demands enumerated during
+   a round are added to the nodes, in connection order, once the round is done */
+static void enumerate_paths_in_rounds(vector<Source_Sink_Pair> &source_sink_pairs, t_thread_conn_info &thread_conn_info,
+			int num_threads, User_Options *user_opts, Analysis_Settings *analysis_settings, Routing_Structs *routing_structs);
+/* adds a demand increment enumerated from the representative of a tile class to the equivalent nodes of each class tile that picked the connection */
+static void replicate_demand_increment(Node_Demand_Increment &increment, Tile_Class &tile_class, vector<int> &picking_members, User_Options *user_opts,
+			Routing_Structs *routing_structs, double *replicated_demand, double *dropped_demand);
 
 /* enumerate paths from specified node at specified tile.  */
 void* enumerate_paths_from_source( void *ptr );
@@ -210,58 +549,83 @@ void* enumerate_paths_from_source( void *ptr );
 void alloc_thread_ss_distances(t_thread_ss_distances &thread_ss_distances, int num_threads, int num_nodes);
 
 /* allocates node topological traversal info vector for each thread */
-void alloc_thread_node_topo_inf(t_thread_node_topo_inf &thread_node_topo_inf, int num_threads, int max_path_weight_bound, t_rr_node &rr_node, int num_nodes);
+void alloc_thread_node_topo_inf(User_Options *user_opts, t_thread_node_topo_inf &thread_node_topo_inf, int num_threads, int num_nodes);
 
 /* allocated any structures needed to keep track of self-congestion effects */
 void alloc_self_congestion_structs(User_Options *user_opts, Routing_Structs *routing_structs, Arch_Structs *arch_structs,
 				t_thread_node_topo_inf &thread_node_topo_inf, int num_threads, int max_path_weight_bound, int num_nodes);
 
-/* allocates a t_nodes_visited structure for each thread */
-void alloc_thread_nodes_visited(t_thread_nodes_visited &thread_nodes_visited, int num_threads, int num_nodes);
-
 /* allocates a Enumerate_Conn_Info structure for each thread */
 void alloc_thread_conn_info(t_thread_conn_info &thread_conn_info, int num_threads);
 
 /* allocates a pthread_t entry for each thread */
 void alloc_threads( t_threads &threads, int num_threads );
 
+
 /* analyzes specified connection between source/sink by calling the 'analyze_connection' function. other than that, 
    this function also computes scaling factors necessary for the call to 'analyze_connection', and updates probability
    metrics as necessary */
 static void analyze_connection(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
 			Routing_Structs *routing_structs, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int conn_length,
-			int number_conns_at_length, t_nodes_visited &nodes_visited, e_topological_mode topological_mode, User_Options *user_opts);
+			int number_conns_at_length, t_distance_pq &distance_pq, Nodes_Waiting_Heap &nodes_waiting,
+			Source_Batch *source_batch, Distance_Cache *distance_cache, e_topological_mode topological_mode, User_Options *user_opts,
+			t_demand_increments *demand_increments, Analysis_Results *results);
 
-/* Enumerates paths between specified source/sink nodes. */
+/* Enumerates paths between specified source/sink nodes. If 'demand_increments' is not NULL, node demands are recorded there
+   instead of being added to the nodes. Connection counts are added to 'results' */
 void enumerate_connection_paths(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
 			Routing_Structs *routing_structs, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int conn_length,
-			t_nodes_visited &nodes_visited, User_Options *user_opts, float scaling_factor_for_enumerate);
+			t_distance_pq &distance_pq, Nodes_Waiting_Heap &nodes_waiting, Source_Batch *source_batch, Distance_Cache *distance_cache,
+			User_Options *user_opts, float scaling_factor_for_enumerate, t_demand_increments *demand_increments, Analysis_Results *results);
 
-/* Estimates the likelyhood (based on node demands) that the specified source/sink connection can be routed */
+/* Estimates the likelyhood (based on node demands) that the specified source/sink connection can be routed. If 'probs_at_multipliers'
+   is not NULL, it is set to the connection's probability at each demand multiplier of user_opts->demand_multiplier_list.
+   If 'float_buckets' is true, probabilities are propagated through single-precision node buckets (PROPAGATE mode only) */
 float estimate_connection_probability(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
 			Routing_Structs *routing_structs, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int conn_length,
-			t_nodes_visited &nodes_visited, User_Options *user_opts);
+			t_distance_pq &distance_pq, Nodes_Waiting_Heap &nodes_waiting, Source_Batch *source_batch, Distance_Cache *distance_cache,
+			User_Options *user_opts, vector<float> *probs_at_multipliers, bool float_buckets);
+/* sets the source buckets (and multiplier buckets, if any) of the source node to a probability of 1 at path weight 0 */
+template <typename T> static void init_source_node_probabilities(Node_Buckets<T> &source_node_buckets, int num_multipliers);
 
 /* fills the t_ss_distances structures according to source & sink distances to intermediate nodes. 
    also returns an adjusted maximum path weight (to be further passed on to path enumeration / probability analysis functions)
    based on the distance from the source to the sink */
 bool get_ss_distances_and_adjust_max_path_weight(int source_node_ind, int sink_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
-                                int max_path_weight, t_nodes_visited &nodes_visited, int *adjusted_max_path_weight, int *source_sink_dist);
+                                int max_path_weight, t_distance_pq &distance_pq, Source_Batch *source_batch,
+				Distance_Cache *distance_cache, int *adjusted_max_path_weight, int *source_sink_dist);
 
 /* adjusts maximum path weight based on the minimum distance of the current source/sink pair.
    note that the adjusted max path weight SHOULD stay in effect for only the current source/sink pair analysis
    and is reset afterwards. */
 int adjust_max_path_weight_based_on_ss_dist(int min_dist_sink, int current_max_path_weight);
 
+/* makes sure that the current source batch of a thread is the batch that pair 'ipair' of the specified list belongs to, finding the
+   shared source distances of a new batch if it isn't (and if the fields of its connections aren't all in 'distance_cache').
+   the batch doesn't extend past pairs [from_pair, to_pair) of the list */
+static void update_source_batch(vector<Source_Sink_Pair> &source_sink_pairs, int ipair, int from_pair, int to_pair,
+			Analysis_Settings *analysis_settings, t_rr_node &rr_node, t_ss_distances &ss_distances, t_distance_pq &distance_pq,
+			Distance_Cache *distance_cache, Source_Batch &source_batch);
+
+/* returns whether the specified node, which terminates a path of weight 'node_path_weight' from the source of the batch, has a
+   chance to reach the sink of any of the batch's connections */
+static bool node_has_chance_to_reach_batch_sink(int node_ind, int node_path_weight, Source_Batch &source_batch,
+			Analysis_Settings *analysis_settings, t_rr_node &rr_node);
+
+/* returns the number of source/sink buckets each node needs during the analysis of a connection with the specified
+   maximum path weight */
+static int get_num_node_buckets(int max_path_weight);
+
 /* traverses graph from 'from_node_ind' and for each node traversed, sets distance to the source/sink node from
-   which the traversal started (based on traversal_dir) */
+   which the traversal started (based on traversal_dir). if 'visited_nodes' is not NULL, the nodes marked as visited are added to it */
 void set_node_distances(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
-			int max_path_weight, e_traversal_dir traversal_dir, t_nodes_visited &nodes_visited);
+			int max_path_weight, e_traversal_dir traversal_dir, t_distance_pq &distance_pq, vector<int> *visited_nodes);
 
 /* enqueues nodes belonging to specified edge list onto the bonded priority queue. the weight of the 
    enqueued nodes will be base_weight + their own weight */
 void put_children_on_pq_and_set_ss_distance(int num_edges, int *edge_list, int base_weight, t_ss_distances &ss_distances,
-			int max_path_weight, e_traversal_dir traversal_dir, t_rr_node &rr_node, int to_node_ind, My_Bounded_Priority_Queue<int> *PQ);
+			int max_path_weight, e_traversal_dir traversal_dir, t_rr_node &rr_node, int to_node_ind, t_distance_pq *PQ,
+			vector<int> *visited_nodes);
 
 /* returns whether or not the specified node has a chance to reach the specified destination node */
 bool node_has_chance_to_reach_destination(int node_ind, int destx, int desty, int node_path_weight, int max_path_weight, t_rr_node &rr_node);
@@ -271,14 +635,13 @@ bool node_has_chance_to_reach_destination(int node_ind, int destx, int desty, in
 void set_node_hops(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
 			int max_path_weight, e_traversal_dir traversal_dir);
 
-/* resets data structures associated with nodes that have been visited during the previous path traversals */
-void clean_node_data_structs(t_nodes_visited &nodes_visited, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int max_path_weight);
-
-/* clears ss_distances structure according to nodes that have been visited during graph traversal */
-void clean_ss_distances(t_ss_distances &ss_distances, t_nodes_visited &nodes_visited);
+/* sets the source and sink hops of the legal nodes of a connection, unless they were restored from 'distance_cache' along with the
+   connection's distances. if the connection's distances are cached, the hops are cached with them */
+static void set_connection_hops(int source_node_ind, int sink_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+			int max_path_weight, Distance_Cache *distance_cache);
 
-/* clears node_buckets structure according to nodes that have been visited during graph traversal */
-void clean_node_topo_inf(t_node_topo_inf &node_topo_inf, t_nodes_visited &nodes_visited, int max_path_weight);
+/* resets data structures associated with nodes that have been visited during the previous path traversals */
+void clean_node_data_structs(t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf);
 
 /* returns the sum of pin probabilities over all the pins that the specified source node represents */
 void get_sum_of_source_probabilities(int source_node_ind, t_rr_node &rr_node, t_prob_list &pin_probs,
@@ -289,9 +652,9 @@ int get_num_sinks(int sink_node_ind, t_rr_node &rr_node, Physical_Type_Descripto
 /* returns number of sources corresponding to the specified super-source node */
 int get_num_sources(int source_node_ind, t_rr_node &rr_node, Physical_Type_Descriptor &fill_block_type);
 
-/* function for a thread to increment the probability metric */
+/* function for a thread to increment the probability metric of its (partial) analysis results */
 void increment_probability_metric(float probability_increment, int connection_length, int source_node_ind, int sink_node_ind,
-				int num_subsources, int num_subsinks, e_pin_type source_pin_type);
+				int num_subsources, int num_subsinks, e_pin_type source_pin_type, Analysis_Results *results);
 /* returns the number of CHANX/CHANY nodes in the graph */
 static int get_num_routing_nodes(t_rr_node &rr_node);
 /* returns a 'reachability' metric based on routing node demands */
@@ -304,8 +667,22 @@ static void get_conn_length_stats(User_Options *user_opts, Analysis_Settings *an
 /* returns number of connections from tile at the specified coordinates at specified length */
 static int conns_at_distance_from_tile(int tile_x, int tile_y, int length, t_grid &grid, 
 				int grid_size_x, int grid_size_y, t_block_type &block_type, int fill_type_ind);
-/* at each length, sums the probabilities of the x% worst possible connections */
-static float analyze_lowest_probs_pqs( vector< t_lowest_probs_pq > &lowest_probs_pqs);
+/* pushes a connection's (scaled) probability onto the lowest-probability queue of its length */
+static void push_connection_probability(float probability_increment, int connection_length, int num_subsources, int num_subsinks,
+				vector<t_lowest_probs_pq> &lowest_probs_pqs);
+/* at each length, sums the probabilities of the x% worst possible connections. the sum at each length is printed if 'print' is set */
+static float analyze_lowest_probs_pqs( vector< t_lowest_probs_pq > &lowest_probs_pqs, bool print);
+/* computes the routability metric from the worst-connection queues and the probability totals of 'analysis_results' */
+static float get_routability_metric(User_Options *user_opts, Analysis_Results &analysis_results, vector<t_lowest_probs_pq> &lowest_probs_pqs_drivers,
+				vector<t_lowest_probs_pq> &lowest_probs_pqs_fanout, bool print);
+/* empties each of the specified queues (their size limits are kept) */
+static void clear_lowest_probs_pqs(vector<t_lowest_probs_pq> &lowest_probs_pqs);
+/* resets the partial results of each thread, and sizes each thread's per-pair probability totals */
+static void init_partial_results(t_thread_conn_info &thread_conn_info, Analysis_Results &analysis_results);
+/* merges the partial results of each thread into 'analysis_results' */
+static void merge_partial_results(t_thread_conn_info &thread_conn_info, Analysis_Results &analysis_results);
+/* pushes the entries of each 'from' queue onto the 'to' queue of the same length. the 'from' queues are emptied */
+static void merge_lowest_probs_pqs(vector<t_lowest_probs_pq> &from_pqs, vector<t_lowest_probs_pq> &to_pqs);
 
 
 /************ Function Definitions ************/
@@ -313,16 +690,26 @@ static float analyze_lowest_probs_pqs( vector< t_lowest_probs_pq > &lowest_probs
 void run_analysis(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, 
 			Routing_Structs *routing_structs){
 
-	switch( user_opts->rr_structs_mode ){
-		case RR_STRUCTS_VPR:
-			analyze_fpga_architecture(user_opts, analysis_settings, arch_structs, routing_structs);
-			break;
-		case RR_STRUCTS_SIMPLE:
-			analyze_simple_graph(user_opts, analysis_settings, arch_structs, routing_structs);
-			break;
-		default:
-			WTHROW(EX_PATH_ENUM, "Encountered unrecognized rr_structs_mode: " << user_opts->rr_structs_mode); 
+	try{
+		switch( user_opts->rr_structs_mode ){
+			case RR_STRUCTS_VPR:
+			case RR_STRUCTS_VPR_XML:
+				analyze_fpga_architecture(user_opts, analysis_settings, arch_structs, routing_structs);
+				break;
+			case RR_STRUCTS_SIMPLE:
+				analyze_simple_graph(user_opts, analysis_settings, arch_structs, routing_structs);
+				break;
+			default:
+				WTHROW(EX_PATH_ENUM, "Encountered unrecognized rr_structs_mode: " << user_opts->rr_structs_mode); 
+		}
+	} catch (...){
+		/* whatever went wrong (i.e. bad_alloc as well as wotan exceptions), idle worker threads would otherwise still be waiting
+		   on the pool's condition variables when these are destroyed at exit */
+		stop_thread_pool();
+		throw;
 	}
+
+	stop_thread_pool();
 }
 
 /* performs routability analysis on an FPGA architecture */
@@ -333,45 +720,176 @@ static void analyze_fpga_architecture(User_Options *user_opts, Analysis_Settings
 		analyze_test_tile_connections(user_opts, analysis_settings, arch_structs, routing_structs, ENUMERATE);
 		analyze_test_tile_connections(user_opts, analysis_settings, arch_structs, routing_structs, PROBABILITY);
 	} else {
-		//XXX: binary search doesn't actually work right now. Seems to be bugged out right now. Probably some structures aren't being reset.
-		/* perform a binary search to find the demand_multiplier value required to achieve the target level of reliability */
-		int max_tries = 20;
-		float target_tolerance = 0.02;
-		float multiplier_high = 200.0;
-		float multiplier_low = 0.0;
-		float reliability = -1;
-
-		int try_num = 1;
-		while ( abs(reliability - user_opts->target_reliability) > target_tolerance ){
-			if (try_num > max_tries){
-				cout << "WARNING! Search has taken more than " << max_tries << " tries! Using last multiplier value." << endl;
-				break;
-			}
+		search_for_demand_multiplier(user_opts, analysis_settings, arch_structs, routing_structs);
+	}
+
+	update_screen(routing_structs, arch_structs, user_opts);
+}
 
-			user_opts->demand_multiplier = (multiplier_high + multiplier_low) / 2;
+/* searches for the demand multiplier at which reliability is equal to user_opts->target_reliability (within user_opts->search_tolerance).
+   reliability decreases as the demand multiplier increases, so the root of f(multiplier) = reliability - target is found:
+	1) starting from user_opts->search_start_multiplier (if specified), the multiplier is stepped up (down) while reliability is too
+	   high (low), until f changes sign. the multiplier stays within user_opts->search_min_multiplier/search_max_multiplier (if specified)
+	2) the resulting bracket is narrowed with Brent's method -- inverse quadratic interpolation or secant steps, with bisection
+	   whenever these don't shrink the bracket quickly enough.
+   each try is a full analysis (see analyze_at_demand_multiplier) */
+static void search_for_demand_multiplier(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, 
+			Routing_Structs *routing_structs){
 
-			//TODO: ideally, the enumerate part should only be done once, with the demand multiplier then being re-applied to all
-			//      nodes.
-			analyze_test_tile_connections(user_opts, analysis_settings, arch_structs, routing_structs, ENUMERATE);
-			reliability = analyze_test_tile_connections(user_opts, analysis_settings, arch_structs, routing_structs, PROBABILITY);
+	float target = user_opts->target_reliability;
+	float tolerance = user_opts->search_tolerance;
 
-			/* perform search and get result... */
+	double start_multiplier = SEARCH_DEFAULT_START_MULTIPLIER;
+	double bracket_factor = SEARCH_BRACKET_FACTOR;
+	if (user_opts->search_start_multiplier != UNDEFINED){
+		start_multiplier = user_opts->search_start_multiplier;
+		bracket_factor = SEARCH_WARM_START_BRACKET_FACTOR;
+	}
+	double min_multiplier = user_opts->search_min_multiplier;
+	double max_multiplier = user_opts->search_max_multiplier;
+	if (max_multiplier != UNDEFINED){
+		start_multiplier = min(start_multiplier, max_multiplier);
+	}
+	if (min_multiplier != UNDEFINED){
+		start_multiplier = max(start_multiplier, min_multiplier);
+	}
+	int max_tries = user_opts->search_max_tries;
+
+	/* 'b' is always the best estimate so far; [a, b] is the bracket once f(a) and f(b) have different signs */
+	int try_num = 1;
+	double b = start_multiplier;
+	double fb = analyze_at_demand_multiplier(b, try_num, user_opts, analysis_settings, arch_structs, routing_structs) - target;
+	double a = b;
+	double fa = fb;
+	bool converged = (fabs(fb) <= tolerance);
+
+	/* step away from the starting point until the target is bracketed */
+	while (!converged && fa*fb > 0 && try_num < max_tries){
+		a = b;
+		fa = fb;
+		if (fa > 0){
+			b = a * bracket_factor;
+		} else {
+			b = a / bracket_factor;
+		}
 
-			if (reliability < user_opts->target_reliability){
-				multiplier_high = user_opts->demand_multiplier;
+		/* the target can't be bracketed if the previous try was already at the bound in the direction of the step */
+		if (max_multiplier != UNDEFINED){
+			b = min(b, max_multiplier);
+		}
+		if (min_multiplier != UNDEFINED){
+			b = max(b, min_multiplier);
+		}
+		if (b == a){
+			break;
+		}
+
+		try_num++;
+		fb = analyze_at_demand_multiplier(b, try_num, user_opts, analysis_settings, arch_structs, routing_structs) - target;
+		converged = (fabs(fb) <= tolerance);
+	}
+
+	/* narrow the bracket */
+	if (!converged && fa*fb < 0){
+		if (fabs(fa) < fabs(fb)){
+			swap(a, b);
+			swap(fa, fb);
+		}
+
+		double c = a;
+		double fc = fa;
+		double d = c;
+		bool bisected = true;
+		while (try_num < max_tries){
+			double min_bracket = SEARCH_MIN_BRACKET_FRACTION * fabs(b);
+
+			double s;
+			if (fa != fc && fb != fc){
+				/* inverse quadratic interpolation */
+				s = a*fb*fc / ((fa-fb)*(fa-fc)) + b*fa*fc / ((fb-fa)*(fb-fc)) + c*fa*fb / ((fc-fa)*(fc-fb));
 			} else {
-				multiplier_low = user_opts->demand_multiplier;
+				/* secant */
+				s = b - fb*(b-a) / (fb-fa);
+			}
+
+			/* bisect if the step falls outside of [(3a+b)/4, b], or if the previous steps aren't converging quickly enough */
+			if ( (s - (3*a+b)/4) * (s - b) >= 0 ||
+			     ( bisected && fabs(s-b) >= fabs(b-c)/2) ||
+			     (!bisected && fabs(s-b) >= fabs(c-d)/2) ||
+			     ( bisected && fabs(b-c) < min_bracket) ||
+			     (!bisected && fabs(c-d) < min_bracket) ){
+				s = (a + b) / 2;
+				bisected = true;
+			} else {
+				bisected = false;
+			}
+
+			try_num++;
+			double fs = analyze_at_demand_multiplier(s, try_num, user_opts, analysis_settings, arch_structs, routing_structs) - target;
+
+			d = c;
+			c = b;
+			fc = fb;
+			if (fa*fs < 0){
+				b = s;
+				fb = fs;
+			} else {
+				a = s;
+				fa = fs;
+			}
+			if (fabs(fa) < fabs(fb)){
+				swap(a, b);
+				swap(fa, fb);
+			}
+
+			if (fabs(fb) <= tolerance){
+				converged = true;
+				break;
+			}
+			if (fabs(b-a) < min_bracket){
+				break;
 			}
 		}
+	}
 
-		cout << endl;
-		cout << "Required demand multiplier: " << user_opts->demand_multiplier << endl;
-		cout << "Absolute routability metric: " << 1.0/user_opts->demand_multiplier << endl;
+	if (!converged){
+		cout << "WARNING! Search did not reach the target reliability after " << try_num << " tries! Using the closest multiplier value." << endl;
 	}
 
-	update_screen(routing_structs, arch_structs, user_opts);
+	/* report the best multiplier found. note that node demands are those of the last try, which isn't necessarily the best one */
+	user_opts->demand_multiplier = b;
+	float reliability = fb + target;
+
+	cout << endl;
+	cout << "Required demand multiplier: " << user_opts->demand_multiplier << endl;
+	cout << "Absolute routability metric: " << 1.0/user_opts->demand_multiplier << endl;
+
+	/* single-line summary for scripts */
+	cout.precision(6);
+	cout << "search_result: demand_multiplier=" << user_opts->demand_multiplier << " reliability=" << reliability <<
+		" tries=" << try_num << " converged=" << (converged ? 1 : 0) << endl;
 }
 
+
+/* resets node demands and analyzes the architecture at the specified demand multiplier. returns the resulting reliability */
+static float analyze_at_demand_multiplier(double demand_multiplier, int try_num, User_Options *user_opts, Analysis_Settings *analysis_settings,
+			Arch_Structs *arch_structs, Routing_Structs *routing_structs){
+
+	user_opts->demand_multiplier = demand_multiplier;
+
+	/* node weights during path enumeration depend on the demand multiplier, so paths have to be enumerated again.
+	   the random sink selection is restarted as well so that each try analyzes the same connections as a separate run would */
+	routing_structs->clear_rr_node_demands();
+	srand(user_opts->seed);
+	analyze_test_tile_connections(user_opts, analysis_settings, arch_structs, routing_structs, ENUMERATE);
+	float reliability = analyze_test_tile_connections(user_opts, analysis_settings, arch_structs, routing_structs, PROBABILITY);
+
+	cout << "Search try " << try_num << ": demand multiplier " << user_opts->demand_multiplier << ", reliability " << reliability << endl;
+
+	return reliability;
+}
+
+
 /* performs routability analysis on a simple one-source/one-sink graph */
 static void analyze_simple_graph(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, 
 			Routing_Structs *routing_structs){
@@ -418,17 +936,15 @@ static void analyze_simple_graph(User_Options *user_opts, Analysis_Settings *ana
 	}
 
 	/* allocate structures for getting source/sink distances */
-	t_nodes_visited nodes_visited;
-	nodes_visited.reserve(num_rr_nodes);
+	t_distance_pq distance_pq;
+	Nodes_Waiting_Heap nodes_waiting;
 	t_ss_distances ss_distances;
-	ss_distances.assign(num_rr_nodes, SS_Distances());
+	ss_distances.assign(num_rr_nodes);
 
 	/* allocate structures for topological traversal */
 	t_node_topo_inf node_topo_inf;
-	node_topo_inf.assign(num_rr_nodes, Node_Topological_Info());
+	node_topo_inf.assign(num_rr_nodes);
 	for (int inode = 0; inode < num_rr_nodes; inode++){
-		node_topo_inf[inode].buckets.alloc_source_sink_buckets(large_max_path_weight+1, large_max_path_weight+1);
-		node_topo_inf[inode].demand_discounts.assign(large_max_path_weight+1, 0.0);
 		rr_node[inode].alloc_child_demand_contributions(large_max_path_weight+1);
 	}
 
@@ -451,7 +967,7 @@ static void analyze_simple_graph(User_Options *user_opts, Analysis_Settings *ana
 
 	/* perform path enumeration */
 	enumerate_connection_paths(source_node_ind, sink_node_ind, analysis_settings, arch_structs, routing_structs, ss_distances,
-	                     node_topo_inf, large_connection_length, nodes_visited, user_opts, (float)UNDEFINED);
+	                     node_topo_inf, large_connection_length, distance_pq, nodes_waiting, NULL, NULL, user_opts, (float)UNDEFINED, NULL, &f_analysis_results);
 
 	/* print how many paths run through each node */
 	cout << "Node demands: " << endl;
@@ -461,12 +977,12 @@ static void analyze_simple_graph(User_Options *user_opts, Analysis_Settings *ana
 	}
 
 	/* clean structures in preparation for probability estimation */
-	clean_node_data_structs(nodes_visited, ss_distances, node_topo_inf, large_max_path_weight);
+	clean_node_data_structs(ss_distances, node_topo_inf);
 
 	/* estimate probability of routing from source to sink */
 	float connection_probability = estimate_connection_probability(source_node_ind, sink_node_ind, analysis_settings, arch_structs,
 	                                                   routing_structs, ss_distances, node_topo_inf, large_connection_length,
-							   nodes_visited, user_opts);
+							   distance_pq, nodes_waiting, NULL, NULL, user_opts, NULL, false);
 
 	/* print connection probability */
 	cout << "Connection probability: " << connection_probability << endl;
@@ -512,20 +1028,39 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 	/* allocate appropriate data structures for each thread */
 	int max_path_weight_bound = analysis_settings->get_max_path_weight( user_opts->max_connection_length ) * PATH_FLEXIBILITY_FACTOR;
 	int num_threads = user_opts->num_threads;
-	t_thread_ss_distances thread_ss_distances;
-	t_thread_node_topo_inf thread_node_topo_inf;
-	t_thread_nodes_visited thread_nodes_visited;
 	t_thread_conn_info thread_conn_info;
-	t_threads threads;
 
 	cout << "absolute max possible path weight is: " << max_path_weight_bound << endl;
 
-	alloc_thread_ss_distances(thread_ss_distances, num_threads, (int)routing_structs->get_num_rr_nodes());
-	alloc_thread_node_topo_inf(thread_node_topo_inf, num_threads, max_path_weight_bound, routing_structs->rr_node, (int)routing_structs->get_num_rr_nodes());
-	alloc_self_congestion_structs(user_opts, routing_structs, arch_structs, thread_node_topo_inf, num_threads, max_path_weight_bound, (int)routing_structs->get_num_rr_nodes());
-	alloc_thread_nodes_visited(thread_nodes_visited, num_threads, (int)routing_structs->get_num_rr_nodes());
+	/* threads and their workspaces are kept between calls to this function */
+	start_thread_pool(num_threads);
+	alloc_thread_workspaces(user_opts, routing_structs, arch_structs, max_path_weight_bound);
+	t_thread_ss_distances &thread_ss_distances = f_thread_pool.thread_ss_distances;
+	t_thread_node_topo_inf &thread_node_topo_inf = f_thread_pool.thread_node_topo_inf;
+	t_thread_distance_pqs &thread_distance_pqs = f_thread_pool.thread_distance_pqs;
+	t_thread_nodes_waiting &thread_nodes_waiting = f_thread_pool.thread_nodes_waiting;
+	t_thread_source_batches &thread_source_batches = f_thread_pool.thread_source_batches;
+	t_thread_distance_caches &thread_distance_caches = f_thread_pool.thread_distance_caches;
+
 	alloc_thread_conn_info(thread_conn_info, num_threads);
-	alloc_threads(threads, num_threads);
+
+	/* connection counts are reported for each enumeration pass (results of the probability pass are reset below) */
+	if (topological_mode == ENUMERATE){
+		f_analysis_results = Analysis_Results();
+	}
+
+	/* when enumerating in rounds, all connections are put into the first list so that their order doesn't depend on the number of threads */
+	bool use_enumerate_rounds = (topological_mode == ENUMERATE && user_opts->enumerate_rounds != UNDEFINED);
+	int num_pair_lists = use_enumerate_rounds ? 1 : num_threads;
+
+	/* node weights don't change while the threads are running, unless paths are enumerated without rounds (demands are added after
+	   each connection), or the probability analysis enumerates paths itself */
+	bool weights_fixed = (topological_mode == PROBABILITY && PROBABILITY_MODE != RELIABILITY_POLYNOMIAL) || use_enumerate_rounds;
+
+	/* connections of the same source can then share one forward distance traversal, and the distance fields of connections can be
+	   cached for when a connection is analyzed again with the same weights */
+	bool share_source_distances = user_opts->share_source_distances && weights_fixed;
+	bool cache_distances = weights_fixed && thread_distance_caches[0].is_enabled();
 
 	/* set parameters that will not change for each thread */
 	for (int ithread = 0; ithread < num_threads; ithread++){
@@ -535,17 +1070,40 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 		thread_conn_info[ithread].routing_structs = routing_structs;
 		thread_conn_info[ithread].ss_distances = &thread_ss_distances[ithread];
 		thread_conn_info[ithread].node_topo_inf = &thread_node_topo_inf[ithread];
-		thread_conn_info[ithread].nodes_visited = &thread_nodes_visited[ithread];
+		thread_conn_info[ithread].distance_pq = &thread_distance_pqs[ithread];
+		thread_conn_info[ithread].nodes_waiting = &thread_nodes_waiting[ithread];
+		thread_conn_info[ithread].source_batch = NULL;
+		if (share_source_distances){
+			thread_conn_info[ithread].source_batch = &thread_source_batches[ithread];
+		}
+		thread_conn_info[ithread].distance_cache = NULL;
+		if (cache_distances){
+			thread_conn_info[ithread].distance_cache = &thread_distance_caches[ithread];
+		}
 		thread_conn_info[ithread].topological_mode = topological_mode;
+		thread_conn_info[ithread].enumerate_round = NULL;
+		thread_conn_info[ithread].thread_ind = ithread;
+		thread_conn_info[ithread].thread_conn_info = &thread_conn_info;
 	}
 
-	int ithread_source = 0;
-	int ithread_sink = 0;
+	/* with tile symmetry, paths are only enumerated from the representative tile of each tile class */
+	bool use_tile_classes = (topological_mode == ENUMERATE && user_opts->tile_symmetry);
+	int num_tiles = use_tile_classes ? (int)analysis_settings->tile_classes.size() : (int)analysis_settings->test_tile_coords.size();
+
+	/* the connections of each source, in row-major tile order. they are handed to the threads once all of them are known */
+	vector<Source_Task> source_tasks;
+
 	/* for each test tile */
-	vector< Coordinate >::const_iterator it;
-	for (it = analysis_settings->test_tile_coords.begin(); it != analysis_settings->test_tile_coords.end(); it++){
+	for (int itile = 0; itile < num_tiles; itile++){
 
-		Coordinate tile_coord = (*it);
+		Coordinate tile_coord;
+		int tile_class_ind = UNDEFINED;
+		if (use_tile_classes){
+			tile_coord = analysis_settings->tile_classes[itile].representative;
+			tile_class_ind = itile;
+		} else {
+			tile_coord = analysis_settings->test_tile_coords[itile];
+		}
 
 		/* the user may have specified that only the core region of the FPGA is to be used for probability analysis. in that case
 		   probability analysis will be performed for all tiles that are within the region that is CORE_OFFSET tiles from the FPGA perimeter */
@@ -577,8 +1135,19 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 				vector<int> sink_indices;
 				vector<int> ss_length;
 				vector<int> source_conns_at_length;
-				get_corresponding_sink_ids(user_opts, analysis_settings, arch_structs, routing_structs, source_node_index, tile_coord, sink_indices,
-								ss_length, source_conns_at_length);
+				vector< vector<int> > picking_members;
+				if (use_tile_classes){
+					get_tile_class_sink_ids(user_opts, analysis_settings, arch_structs, routing_structs, source_node_index, analysis_settings->tile_classes[itile],
+								sink_indices, ss_length, source_conns_at_length, picking_members);
+				} else {
+					get_corresponding_sink_ids(user_opts, analysis_settings, arch_structs, routing_structs, source_node_index, tile_coord, sink_indices,
+									ss_length, source_conns_at_length);
+				}
+
+				source_tasks.push_back( Source_Task() );
+				Source_Task &source_task = source_tasks.back();
+				source_task.tile_coord = tile_coord;
+				source_task.pin_type = DRIVER;
 
 				for (int isink = 0; isink < (int)sink_indices.size(); isink++){
 					Source_Sink_Pair ss_pair;
@@ -586,13 +1155,12 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 					ss_pair.sink_ind = sink_indices[isink];
 					ss_pair.ss_length = ss_length[isink];
 					ss_pair.source_conns_at_length = source_conns_at_length[isink];
+					ss_pair.tile_class_ind = tile_class_ind;
+					if (use_tile_classes){
+						ss_pair.picking_members = picking_members[isink];
+					}
 					
-					thread_conn_info[ithread_source].source_sink_pairs.push_back(ss_pair);
-				}
-
-				ithread_source++;	
-				if (ithread_source == num_threads){
-					ithread_source = 0;
+					source_task.source_sink_pairs.push_back(ss_pair);
 				}
 
 			} else if (pin_class->get_pin_type() == RECEIVER){
@@ -607,8 +1175,19 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 					vector<int> sink_indices;
 					vector<int> ss_length;
 					vector<int> source_conns_at_length;
-					get_corresponding_sink_ids(user_opts, analysis_settings, arch_structs, routing_structs, virtual_source_ind, tile_coord, sink_indices,
-									ss_length, source_conns_at_length);
+					vector< vector<int> > picking_members;
+					if (use_tile_classes){
+						get_tile_class_sink_ids(user_opts, analysis_settings, arch_structs, routing_structs, virtual_source_ind, analysis_settings->tile_classes[itile],
+									sink_indices, ss_length, source_conns_at_length, picking_members);
+					} else {
+						get_corresponding_sink_ids(user_opts, analysis_settings, arch_structs, routing_structs, virtual_source_ind, tile_coord, sink_indices,
+										ss_length, source_conns_at_length);
+					}
+
+					source_tasks.push_back( Source_Task() );
+					Source_Task &source_task = source_tasks.back();
+					source_task.tile_coord = tile_coord;
+					source_task.pin_type = RECEIVER;
 
 					for (int isink = 0; isink < (int)sink_indices.size(); isink++){
 						Source_Sink_Pair ss_pair;
@@ -616,13 +1195,12 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 						ss_pair.sink_ind = sink_indices[isink];
 						ss_pair.ss_length = ss_length[isink];
 						ss_pair.source_conns_at_length = source_conns_at_length[isink];
+						ss_pair.tile_class_ind = tile_class_ind;
+						if (use_tile_classes){
+							ss_pair.picking_members = picking_members[isink];
+						}
 
-						thread_conn_info[ithread_sink].source_sink_pairs.push_back(ss_pair);
-					}
-
-					ithread_sink++;
-					if (ithread_sink == num_threads){
-						ithread_sink = 0;
+						source_task.source_sink_pairs.push_back(ss_pair);
 					}
 				}
 			} else {
@@ -630,6 +1208,7 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 			}
 		}
 	}
+	assign_source_tasks(source_tasks, user_opts->task_order, grid_size_x, grid_size_y, thread_conn_info, num_pair_lists);
 
 
 	if (topological_mode == PROBABILITY){
@@ -656,19 +1235,49 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 				f_analysis_results.lowest_probs_pqs_fanout[ilen].set_properties( receiver_entries_limit );
 			}
 		}
+
+		/* and the same (still empty) queues at each demand multiplier of the routability curve */
+		int num_multipliers = (int)user_opts->demand_multiplier_list.size();
+		if (num_multipliers > 0 && PROBABILITY_MODE != PROPAGATE){
+			WTHROW(EX_PATH_ENUM, "The -demand_multiplier_list option can currently only be used with the PROPAGATE probability mode");
+		}
+		if (user_opts->bucket_precision != PRECISION_DOUBLE && PROBABILITY_MODE != PROPAGATE){
+			WTHROW(EX_PATH_ENUM, "The -bucket_precision option can currently only be used with the PROPAGATE probability mode");
+		}
+		f_analysis_results.multiplier_lowest_probs_pqs_drivers.assign( num_multipliers, f_analysis_results.lowest_probs_pqs_drivers );
+		f_analysis_results.multiplier_lowest_probs_pqs_fanout.assign( num_multipliers, f_analysis_results.lowest_probs_pqs_fanout );
 	}
 
 
 	f_analysis_results.active_threads = num_threads;
-	/* initialize mutex that will be used for synchronizing threads' updates to shared variables */
-	pthread_mutex_init(&f_analysis_results.thread_mutex, NULL);
+	/* each thread adds to its own results, which are merged once all threads are done */
+	init_partial_results(thread_conn_info, f_analysis_results);
 	/* initialize thread semaphore */
 	pthread_barrier_init(&f_analysis_results.thread_barrier, 0, f_analysis_results.active_threads);
 
 	/* launch the threads */
-	launch_pthreads(thread_conn_info, threads, num_threads);
+	chrono::steady_clock::time_point launch_time = chrono::steady_clock::now();
+	if (use_enumerate_rounds){
+		enumerate_paths_in_rounds(thread_conn_info[0].source_sink_pairs, thread_conn_info, num_threads, user_opts, analysis_settings, routing_structs);
+	} else {
+		for (int ithread = 0; ithread < num_threads; ithread++){
+			thread_conn_info[ithread].pair_queue.next_pair = 0;
+			thread_conn_info[ithread].pair_queue.end_pair = (int)thread_conn_info[ithread].source_sink_pairs.size();
+		}
+		set_distance_cache_weight_snapshots(thread_conn_info, routing_structs->rr_node);
+		launch_pthreads(thread_conn_info);
+	}
+	double launch_seconds = chrono::duration<double>(chrono::steady_clock::now() - launch_time).count();
 
-	pthread_mutex_destroy(&f_analysis_results.thread_mutex);
+	if (num_threads > 1){
+		print_thread_work_stats(thread_conn_info, launch_seconds);
+	}
+	print_task_locality_stats(thread_conn_info);
+	if (cache_distances){
+		print_distance_cache_stats(thread_conn_info);
+	}
+
+	merge_partial_results(thread_conn_info, f_analysis_results);
 	pthread_barrier_destroy(&f_analysis_results.thread_barrier);
 
 
@@ -717,45 +1326,52 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 
 		result = normalized_demand;
 	} else {
-		float opin_prob = user_opts->opin_probability;
-		float ipin_prob = user_opts->ipin_probability;
-
 		cout << "Demand multiplier: " << user_opts->demand_multiplier << endl;
 
 		cout.setf(ios::fixed);
 		cout.precision(4);
 
-		/* compute the two parts of the routability metric (driver & fanout) */
-		float worst_probabilities_driver = 0;
-		float worst_probabilities_fanout = 0;
-		float driver_prob_metric = 0;
-		float fanout_prob_metric = 0;
-		if (opin_prob != 0){
-			worst_probabilities_driver = analyze_lowest_probs_pqs( f_analysis_results.lowest_probs_pqs_drivers );
-			driver_prob_metric = worst_probabilities_driver / (f_analysis_results.max_possible_total_prob_drivers * WORST_ROUTABILITY_PERCENTILE_DRIVERS);
-		}
+		float routability_metric = get_routability_metric(user_opts, f_analysis_results, f_analysis_results.lowest_probs_pqs_drivers,
+		                                                  f_analysis_results.lowest_probs_pqs_fanout, true);
 
-		if (ipin_prob != 0){
-			worst_probabilities_fanout = analyze_lowest_probs_pqs( f_analysis_results.lowest_probs_pqs_fanout );
-			fanout_prob_metric = worst_probabilities_fanout / (f_analysis_results.max_possible_total_prob_fanout * WORST_ROUTABILITY_PERCENTILE_FANOUT);
-		}
+		cout << "Routability metric: " << routability_metric << endl;
 
-		cout << "Driver metric: " << driver_prob_metric << endl;
-		cout << "Fanout metric: " << fanout_prob_metric << endl;
+		result = routability_metric;
 
-		/* combine the two parts of the routability metric into a single number */
-		float driver_prob_weight = 1;
-		float fanout_prob_weight = 1;
-		if (opin_prob > 0 && ipin_prob > 0){
-			driver_prob_weight = DRIVER_PROB_WEIGHT;
-			fanout_prob_weight = FANOUT_PROB_WEIGHT;
+		/* the routability metric at each demand multiplier of the routability curve (paths were enumerated at the demand multiplier above) */
+		int num_multipliers = (int)user_opts->demand_multiplier_list.size();
+		if (num_multipliers > 0){
+			stringstream curve_line;
+			curve_line.setf(ios::fixed);
+			curve_line.precision(6);
+
+			cout << "Routability curve:" << endl;
+			for (int imult = 0; imult < num_multipliers; imult++){
+				double multiplier = user_opts->demand_multiplier_list[imult];
+				float multiplier_metric = get_routability_metric(user_opts, f_analysis_results, f_analysis_results.multiplier_lowest_probs_pqs_drivers[imult],
+				                                                 f_analysis_results.multiplier_lowest_probs_pqs_fanout[imult], false);
+
+				cout << "  demand multiplier " << multiplier << ": routability metric " << multiplier_metric << endl;
+				curve_line << " " << multiplier << "=" << multiplier_metric;
+			}
+			cout << "routability_curve:" << curve_line.str() << endl;
 		}
-		
-		float routability_metric = (driver_prob_weight * driver_prob_metric) + (fanout_prob_weight * fanout_prob_metric);
 
-		cout << "Routability metric: " << routability_metric << endl;
+		/* how far the single-precision connection probabilities were from the double-precision ones */
+		if (user_opts->bucket_precision == PRECISION_COMPARE){
+			double mean_abs_error = 0;
+			if (f_analysis_results.precision_conns > 0){
+				mean_abs_error = f_analysis_results.precision_abs_error_sum / (double)f_analysis_results.precision_conns;
+			}
 
-		result = routability_metric;
+			stringstream report_line;
+			report_line.setf(ios::scientific);
+			report_line.precision(3);
+			report_line << "precision_report: conns=" << f_analysis_results.precision_conns
+			            << " max_abs_error=" << f_analysis_results.precision_max_abs_error
+			            << " mean_abs_error=" << mean_abs_error;
+			cout << report_line.str() << endl;
+		}
 	}
 
 	malloc_trim(0);
@@ -887,6 +1503,65 @@ static void get_corresponding_sink_ids(User_Options *user_opts, Analysis_Setting
 }
 
 
+/* picks the sinks of a source at the representative of a tile class the same way as it is done for every tile of the class, and returns the
+   union of the picked connections (relative to the representative). 'picking_members' is set to the class tiles that picked each connection,
+   so that adding the demands of a connection to just those tiles places the same demands on each tile as picking and enumerating
+   connections separately at each tile would */
+static void get_tile_class_sink_ids(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, Routing_Structs *routing_structs,
+		int source_node_ind, Tile_Class &tile_class, vector<int> &sink_indices, vector<int> &ss_length, vector<int> &source_conns_at_length,
+		vector< vector<int> > &picking_members){
+
+	if (sink_indices.size() != 0){
+		WTHROW(EX_PATH_ENUM, "Sink indices vector must initially be empty");
+	}
+
+	int num_members = (int)tile_class.members.size();
+	int num_picked_conns = 0;
+
+	/* position of each picked sink (of the representative) in the output lists */
+	map<int, int> sink_position;
+
+	for (int imember = 0; imember < num_members; imember++){
+		Coordinate &member = tile_class.members[imember];
+		int dx = member.x - tile_class.representative.x;
+		int dy = member.y - tile_class.representative.y;
+
+		int member_source_ind = routing_structs->get_translated_node(source_node_ind, dx, dy);
+		if (member_source_ind == UNDEFINED){
+			WTHROW(EX_PATH_ENUM, "Tile " << member << " has no source equivalent to source " << source_node_ind << " of tile class representative " << tile_class.representative);
+		}
+
+		vector<int> member_sink_indices;
+		vector<int> member_ss_length;
+		vector<int> member_source_conns_at_length;
+		get_corresponding_sink_ids(user_opts, analysis_settings, arch_structs, routing_structs, member_source_ind, member, member_sink_indices,
+						member_ss_length, member_source_conns_at_length);
+		num_picked_conns += (int)member_sink_indices.size();
+
+		for (int isink = 0; isink < (int)member_sink_indices.size(); isink++){
+			int sink_ind = routing_structs->get_translated_node(member_sink_indices[isink], -dx, -dy);
+			if (sink_ind == UNDEFINED){
+				WTHROW(EX_PATH_ENUM, "Tile class representative " << tile_class.representative << " has no sink equivalent to sink " <<
+				                     member_sink_indices[isink] << " of tile " << member);
+			}
+
+			map<int, int>::iterator it = sink_position.find(sink_ind);
+			if (it == sink_position.end()){
+				it = sink_position.insert( make_pair(sink_ind, (int)sink_indices.size()) ).first;
+				sink_indices.push_back(sink_ind);
+				ss_length.push_back(member_ss_length[isink]);
+				source_conns_at_length.push_back(member_source_conns_at_length[isink]);
+				picking_members.push_back( vector<int>() );
+			}
+			picking_members[it->second].push_back(imember);
+		}
+	}
+
+	/* connections picked by more than one tile of the class are only enumerated once */
+	f_analysis_results.desired_conns -= num_picked_conns - (int)sink_indices.size();
+}
+
+
 /* returns the number of CHANX/CHANY nodes in the graph */
 static int get_num_routing_nodes(t_rr_node &rr_node){
 	int num_routing_nodes = 0;
@@ -921,45 +1596,270 @@ static float node_demand_metric(User_Options *user_opts, t_rr_node &rr_node){
 		RR_Node &node = rr_node[inode];
 		e_rr_type node_type = node.get_rr_type();
 
-		/* only want to record demand for routing nodes (of CHANX/CHANY type) */
-		if (node_type != CHANX && node_type != CHANY){
-			continue;
-		}
+		/* only want to record demand for routing nodes (of CHANX/CHANY type) */
+		if (node_type != CHANX && node_type != CHANY){
+			continue;
+		}
+
+		analysis_nodes.push( node.get_demand(user_opts) );
+	}
+
+	/* now we have a set of x% largest-demand nodes. add up that demand */
+	int num_elements = analysis_nodes.size();
+	float summed_demand = 0;
+	for (int i = 0; i < num_elements; i++){
+		float node_demand = analysis_nodes.top();
+		summed_demand += node_demand;
+		analysis_nodes.pop();
+	}
+
+	float normalized_demand = summed_demand / (float)num_elements;
+
+	return normalized_demand;
+}
+
+/* starts the specified number of worker threads in the thread pool (if the pool isn't already running with that many threads) */
+static void start_thread_pool(int num_threads){
+	Thread_Pool &pool = f_thread_pool;
+
+	if ((int)pool.threads.size() == num_threads){
+		return;
+	}
+	stop_thread_pool();
+
+	/* workers start out waiting for job number 1 -- a job may well be posted before a worker gets to run */
+	pool.shutting_down = false;
+	pool.job = NULL;
+	pool.job_number = 0;
+	alloc_threads(pool.threads, num_threads);
+	pool.thread_inds.assign(num_threads, UNDEFINED);
+
+	for (int ithread = 0; ithread < num_threads; ithread++){
+		pool.thread_inds[ithread] = ithread;
+
+		/* create pthread with default attributes */
+		int result = pthread_create(&pool.threads[ithread], NULL, thread_pool_worker, (void*) &pool.thread_inds[ithread]);
+		if (result != 0){
+			WTHROW(EX_PATH_ENUM, "Failed to create thread!");
+		}
+	}
+}
+
+
+/* shuts down the worker threads of the thread pool and frees the per-thread workspaces */
+static void stop_thread_pool(){
+	Thread_Pool &pool = f_thread_pool;
+
+	pthread_mutex_lock(&pool.mutex);
+	pool.shutting_down = true;
+	pthread_cond_broadcast(&pool.job_cond);
+	pthread_mutex_unlock(&pool.mutex);
+
+	/* wait for threads to exit */
+	for (int ithread = 0; ithread < (int)pool.threads.size(); ithread++){
+		int result = pthread_join(pool.threads[ithread], NULL);
+		if (result != 0){
+			WTHROW(EX_PATH_ENUM, "Failed to join thread!");
+		}
+	}
+	pool.threads.clear();
+
+	pool.thread_ss_distances.clear();
+	pool.thread_node_topo_inf.clear();
+	pool.thread_distance_pqs.clear();
+	pool.thread_nodes_waiting.clear();
+	pool.workspace_num_nodes = UNDEFINED;
+	pool.workspace_max_path_weight_bound = UNDEFINED;
+}
+
+
+/* loop run by each worker thread of the thread pool. waits for jobs and analyzes this thread's part of each job */
+static void* thread_pool_worker( void *ptr ){
+	Thread_Pool &pool = f_thread_pool;
+	int ithread = *(int*)ptr;
+
+	int last_job_number = 0;
+
+	pthread_mutex_lock(&pool.mutex);
+	while (true){
+		while (pool.job_number == last_job_number && !pool.shutting_down){
+			pthread_cond_wait(&pool.job_cond, &pool.mutex);
+		}
+		if (pool.shutting_down){
+			break;
+		}
+		last_job_number = pool.job_number;
+		Conn_Info *conn_info = &(*pool.job)[ithread];
+		pthread_mutex_unlock(&pool.mutex);
+
+		enumerate_paths_from_source( (void*) conn_info );
+
+		pthread_mutex_lock(&pool.mutex);
+		pool.num_threads_done++;
+		if (pool.num_threads_done == (int)pool.threads.size()){
+			pthread_cond_signal(&pool.done_cond);
+		}
+	}
+	pthread_mutex_unlock(&pool.mutex);
+
+	return (void*) NULL;
+}
+
+
+/* returns the number of megabytes of distance fields that each thread's distance cache should keep. unless the user specified a size,
+   the cache is only kept in the modes where connections are analyzed again with the same node weights -- elsewhere every lookup misses,
+   and the cache would only cost time and memory */
+static int get_distance_cache_mb(User_Options *user_opts){
+	if (user_opts->distance_cache_mb != UNDEFINED){
+		return user_opts->distance_cache_mb;
+	}
+
+	if (user_opts->target_reliability != UNDEFINED || user_opts->bucket_precision == PRECISION_COMPARE){
+		return DEFAULT_DISTANCE_CACHE_MB;
+	}
+	return 0;
+}
+
+
+/* allocates the per-thread workspaces of the thread pool, unless workspaces of the right size already exist */
+static void alloc_thread_workspaces(User_Options *user_opts, Routing_Structs *routing_structs, Arch_Structs *arch_structs, int max_path_weight_bound){
+	Thread_Pool &pool = f_thread_pool;
+	int num_threads = (int)pool.threads.size();
+	int num_nodes = routing_structs->get_num_rr_nodes();
+
+	if ((int)pool.thread_ss_distances.size() == num_threads && pool.workspace_num_nodes == num_nodes &&
+	    pool.workspace_max_path_weight_bound == max_path_weight_bound){
+		return;
+	}
+
+	alloc_thread_ss_distances(pool.thread_ss_distances, num_threads, num_nodes);
+	alloc_thread_node_topo_inf(user_opts, pool.thread_node_topo_inf, num_threads, num_nodes);
+	alloc_self_congestion_structs(user_opts, routing_structs, arch_structs, pool.thread_node_topo_inf, num_threads, max_path_weight_bound, num_nodes);
+	pool.thread_distance_pqs.assign(num_threads, t_distance_pq());
+	pool.thread_nodes_waiting.assign(num_threads, Nodes_Waiting_Heap());
+	pool.thread_source_batches.assign(num_threads, Source_Batch());
+	pool.thread_distance_caches.assign(num_threads, Distance_Cache());
+	for (int ithread = 0; ithread < num_threads; ithread++){
+		pool.thread_distance_caches[ithread].set_max_bytes( (size_t)get_distance_cache_mb(user_opts) * 1024 * 1024 );
+	}
+
+	pool.workspace_num_nodes = num_nodes;
+	pool.workspace_max_path_weight_bound = max_path_weight_bound;
+}
+
+
+/* has the threads of the thread pool perform path enumeration / probability analysis. returns once all threads are done */
+void launch_pthreads(t_thread_conn_info &thread_conn_info){
+	Thread_Pool &pool = f_thread_pool;
+
+	if (thread_conn_info.size() != pool.threads.size()){
+		WTHROW(EX_PATH_ENUM, "Expected problem parameters for " << pool.threads.size() << " threads, got " << thread_conn_info.size());
+	}
+
+	/* post the job */
+	pthread_mutex_lock(&pool.mutex);
+	pool.job = &thread_conn_info;
+	pool.num_threads_done = 0;
+	pool.job_number++;
+	pthread_cond_broadcast(&pool.job_cond);
+
+	/* wait for threads to complete */
+	while (pool.num_threads_done < (int)pool.threads.size()){
+		pthread_cond_wait(&pool.done_cond, &pool.mutex);
+	}
+	pool.job = NULL;
+	pthread_mutex_unlock(&pool.mutex);
+}
+
+
+/* enumerates paths for the specified connections in rounds. node weights are fixed during each round; demands enumerated during
+   a round are added to the nodes, in connection order, once the round is done */
+static void enumerate_paths_in_rounds(vector<Source_Sink_Pair> &source_sink_pairs, t_thread_conn_info &thread_conn_info,
+			int num_threads, User_Options *user_opts, Analysis_Settings *analysis_settings, Routing_Structs *routing_structs){
+
+	t_rr_node &rr_node = routing_structs->rr_node;
+	int num_pairs = (int)source_sink_pairs.size();
+	int num_rounds = min(user_opts->enumerate_rounds, max(num_pairs, 1));
+
+	cout << "Enumerating " << num_pairs << " connections in " << num_rounds << " rounds" << endl;
 
-		analysis_nodes.push( node.get_demand(user_opts) );
+	/* totals of demand replicated to the other tiles of tile classes, and of demand which could not be replicated */
+	double replicated_demand = 0;
+	double dropped_demand = 0;
+
+	Enumerate_Round enumerate_round;
+	enumerate_round.source_sink_pairs = &source_sink_pairs;
+	for (int ithread = 0; ithread < num_threads; ithread++){
+		thread_conn_info[ithread].enumerate_round = &enumerate_round;
 	}
 
-	/* now we have a set of x% largest-demand nodes. add up that demand */
-	int num_elements = analysis_nodes.size();
-	float summed_demand = 0;
-	for (int i = 0; i < num_elements; i++){
-		float node_demand = analysis_nodes.top();
-		summed_demand += node_demand;
-		analysis_nodes.pop();
+	for (int iround = 0; iround < num_rounds; iround++){
+		enumerate_round.start_pair = (int)( (long)num_pairs * iround / num_rounds );
+		enumerate_round.end_pair = (int)( (long)num_pairs * (iround+1) / num_rounds );
+		enumerate_round.next_pair = enumerate_round.start_pair;
+		enumerate_round.demand_increments.assign(enumerate_round.end_pair - enumerate_round.start_pair, t_demand_increments());
+
+		/* node weights don't change while the threads are running */
+		set_distance_cache_weight_snapshots(thread_conn_info, rr_node);
+		launch_pthreads(thread_conn_info);
+
+		/* add this round's demands to the nodes. this also updates the node weights to be used during the next round */
+		for (int ipair = 0; ipair < (int)enumerate_round.demand_increments.size(); ipair++){
+			t_demand_increments &demand_increments = enumerate_round.demand_increments[ipair];
+
+			/* demands of connections enumerated from the representative of a tile class go to the tiles of the class that picked them */
+			Source_Sink_Pair &ss_pair = source_sink_pairs[enumerate_round.start_pair + ipair];
+			Tile_Class *tile_class = NULL;
+			if (ss_pair.tile_class_ind != UNDEFINED){
+				tile_class = &analysis_settings->tile_classes[ss_pair.tile_class_ind];
+			}
+
+			for (int iinc = 0; iinc < (int)demand_increments.size(); iinc++){
+				Node_Demand_Increment &increment = demand_increments[iinc];
+				if (tile_class != NULL){
+					replicate_demand_increment(increment, *tile_class, ss_pair.picking_members, user_opts, routing_structs,
+					                           &replicated_demand, &dropped_demand);
+				} else {
+					rr_node[increment.node_ind].increment_demand(increment.demand, user_opts->demand_multiplier);
+				}
+			}
+		}
 	}
 
-	float normalized_demand = summed_demand / (float)num_elements;
+	if (replicated_demand + dropped_demand > 0){
+		cout << "Replicated demand with no equivalent node in the target tile: " << dropped_demand / (replicated_demand + dropped_demand) << endl;
+	}
 
-	return normalized_demand;
+	for (int ithread = 0; ithread < num_threads; ithread++){
+		thread_conn_info[ithread].enumerate_round = NULL;
+	}
 }
 
-/* launched the specified number of threads to perform path enumeration */
-void launch_pthreads(t_thread_conn_info &thread_conn_info, t_threads &threads, int num_threads){
 
-	/* launch threads */
-	for (int ithread = 0; ithread < num_threads; ithread++){
-		/* create pthread with default attributes */
-		int result = pthread_create(&threads[ithread], NULL, enumerate_paths_from_source, (void*) &thread_conn_info[ithread]);
-		if (result != 0){
-			WTHROW(EX_PATH_ENUM, "Failed to create thread!");
+/* adds a demand increment enumerated from the representative of a tile class to the equivalent nodes of each class tile that picked the
+   connection (the representative's own node if the representative picked it). demand for which a tile has no equivalent node (near the
+   perimeter of the FPGA) is added to 'dropped_demand' instead */
+static void replicate_demand_increment(Node_Demand_Increment &increment, Tile_Class &tile_class, vector<int> &picking_members, User_Options *user_opts,
+			Routing_Structs *routing_structs, double *replicated_demand, double *dropped_demand){
+
+	t_rr_node &rr_node = routing_structs->rr_node;
+	Coordinate &representative = tile_class.representative;
+
+	for (int ipick = 0; ipick < (int)picking_members.size(); ipick++){
+		Coordinate &member = tile_class.members[ picking_members[ipick] ];
+		int dx = member.x - representative.x;
+		int dy = member.y - representative.y;
+		if (dx == 0 && dy == 0){
+			rr_node[increment.node_ind].increment_demand(increment.demand, user_opts->demand_multiplier);
+			continue;
 		}
-	}
 
-	/* wait for threads to complete */
-	for (int ithread = 0; ithread < num_threads; ithread++){
-		int result = pthread_join(threads[ithread], NULL);
-		if (result != 0){
-			WTHROW(EX_PATH_ENUM, "Failed to join thread!");
+		int node_ind = routing_structs->get_translated_node(increment.node_ind, dx, dy);
+		if (node_ind == UNDEFINED){
+			(*dropped_demand) += increment.demand;
+		} else {
+			rr_node[node_ind].increment_demand(increment.demand, user_opts->demand_multiplier);
+			(*replicated_demand) += increment.demand;
 		}
 	}
 }
@@ -970,31 +1870,98 @@ void* enumerate_paths_from_source( void *ptr ){
 
 	Conn_Info *conn_info = (Conn_Info*)ptr;
 	
-	vector<Source_Sink_Pair> &source_sink_pairs = conn_info->source_sink_pairs;
 	User_Options *user_opts = conn_info->user_opts;
 	Analysis_Settings *analysis_settings = conn_info->analysis_settings;
 	Arch_Structs *arch_structs = conn_info->arch_structs;
 	Routing_Structs *routing_structs = conn_info->routing_structs;
 	t_ss_distances &ss_distances = (*conn_info->ss_distances);
 	t_node_topo_inf &node_topo_inf = (*conn_info->node_topo_inf);
-	t_nodes_visited &nodes_visited = (*conn_info->nodes_visited);
+	t_distance_pq &distance_pq = (*conn_info->distance_pq);
+	Nodes_Waiting_Heap &nodes_waiting = (*conn_info->nodes_waiting);
+	Source_Batch *source_batch = conn_info->source_batch;
+	Distance_Cache *distance_cache = conn_info->distance_cache;
 	e_topological_mode topological_mode = conn_info->topological_mode;
+	Analysis_Results &partial_results = conn_info->partial_results.results;
+
+	/* node weights may have changed since source distances were last shared */
+	if (source_batch != NULL){
+		source_batch->clear();
+	}
+	ss_distances.reset_shared_source_distances();
+	ss_distances.reset();
 
 	try{
 		//can try randomly shuffling the order of the source/sink pairs being enumerated. I didn't see much improvement with this
 		//random_shuffle(source_sink_pairs.begin(), source_sink_pairs.end());
 
-		for (int ipair = 0; ipair < (int)source_sink_pairs.size(); ipair++){
-			Source_Sink_Pair ss_pair = source_sink_pairs[ipair];
-			int source_node_ind = ss_pair.source_ind;
-			int sink_node_ind = ss_pair.sink_ind;
-			int ss_length = ss_pair.ss_length;
-			int source_conns_at_length = ss_pair.source_conns_at_length;
+		if (conn_info->enumerate_round != NULL){
+			/* claim connections of the current enumeration round until none are left. demands are recorded separately for
+			   each connection, so it doesn't matter which thread gets which connection */
+			Enumerate_Round *enumerate_round = conn_info->enumerate_round;
+
+			vector<Source_Sink_Pair> &source_sink_pairs = (*enumerate_round->source_sink_pairs);
+			int start_pair, end_pair;
+			while ( enumerate_round->claim(source_batch != NULL, &start_pair, &end_pair) ){
+				chrono::steady_clock::time_point start_time = chrono::steady_clock::now();
+
+				for (int ipair = start_pair; ipair < end_pair; ipair++){
+					Source_Sink_Pair ss_pair = source_sink_pairs[ipair];
+					t_demand_increments *demand_increments = &enumerate_round->demand_increments[ipair - enumerate_round->start_pair];
+					conn_info->work_stats.record_source(ss_pair.source_ind, routing_structs->rr_node);
+
+					if (source_batch != NULL){
+						update_source_batch(source_sink_pairs, ipair, enumerate_round->start_pair, enumerate_round->end_pair,
+									analysis_settings, routing_structs->rr_node, ss_distances, distance_pq, distance_cache,
+									*source_batch);
+					}
+
+					analyze_connection(ss_pair.source_ind, ss_pair.sink_ind, analysis_settings, arch_structs, 
+								routing_structs, ss_distances, node_topo_inf, ss_pair.ss_length, 
+								ss_pair.source_conns_at_length, distance_pq, nodes_waiting, source_batch, distance_cache,
+								topological_mode, user_opts, demand_increments, &partial_results);
+				}
+
+				conn_info->work_stats.busy_seconds += chrono::duration<double>(chrono::steady_clock::now() - start_time).count();
+				conn_info->work_stats.num_pairs += end_pair - start_pair;
+			}
+		} else {
+			/* analyze pairs from this thread's list, then help other threads with theirs */
+			Conn_Info *pair_owner;
+			int start_pair, end_pair;
+			while ( claim_pairs(conn_info, &pair_owner, &start_pair, &end_pair) ){
+				chrono::steady_clock::time_point start_time = chrono::steady_clock::now();
+
+				for (int ipair = start_pair; ipair < end_pair; ipair++){
+					Source_Sink_Pair ss_pair = pair_owner->source_sink_pairs[ipair];
+					int source_node_ind = ss_pair.source_ind;
+					int sink_node_ind = ss_pair.sink_ind;
+					int ss_length = ss_pair.ss_length;
+					int source_conns_at_length = ss_pair.source_conns_at_length;
+					conn_info->work_stats.record_source(source_node_ind, routing_structs->rr_node);
+
+					/* the connections of a source that come one after another in the list share a forward distance traversal */
+					if (source_batch != NULL){
+						update_source_batch(pair_owner->source_sink_pairs, ipair, 0, (int)pair_owner->source_sink_pairs.size(),
+									analysis_settings, routing_structs->rr_node, ss_distances, distance_pq, distance_cache,
+									*source_batch);
+					}
+
+					/* analyze this source/sink connection. its probability totals are recorded with the pair rather than added to this
+					   thread's totals, so that they can later be summed in the same order regardless of which thread analyzed which pair */
+					partial_results.totals = Probability_Totals();
+					analyze_connection(source_node_ind, sink_node_ind, analysis_settings, arch_structs, 
+								routing_structs, ss_distances, node_topo_inf, ss_length, 
+								source_conns_at_length, distance_pq, nodes_waiting, source_batch, distance_cache,
+								topological_mode, user_opts, NULL, &partial_results);
+					pair_owner->pair_totals[ipair] = partial_results.totals;
+				}
 
-			/* analyze this source/sink connection */
-			analyze_connection(source_node_ind, sink_node_ind, analysis_settings, arch_structs, 
-						routing_structs, ss_distances, node_topo_inf, ss_length, 
-						source_conns_at_length, nodes_visited, topological_mode, user_opts);
+				conn_info->work_stats.busy_seconds += chrono::duration<double>(chrono::steady_clock::now() - start_time).count();
+				conn_info->work_stats.num_pairs += end_pair - start_pair;
+				if (pair_owner != conn_info){
+					conn_info->work_stats.num_stolen_pairs += end_pair - start_pair;
+				}
+			}
 		}
 
 	} catch (Wotan_Exception &e){
@@ -1008,6 +1975,158 @@ void* enumerate_paths_from_source( void *ptr ){
 }
 
 
+/* claims the next chunk of source/sink pairs to be analyzed by the specified thread -- from the thread's own list if any are left, or else
+   from the list of another thread. returns false if no pairs are left */
+static bool claim_pairs(Conn_Info *conn_info, Conn_Info **pair_owner, int *start_pair, int *end_pair){
+	/* own pairs are taken from the front of the list */
+	if ( conn_info->pair_queue.claim(PAIR_CHUNK_SIZE, true, start_pair, end_pair) ){
+		*pair_owner = conn_info;
+		return true;
+	}
+
+	/* steal from the back of the other threads' lists, starting with the next thread over. no new pairs are added once the threads
+	   are running, so if all lists are empty then there is nothing left to do */
+	t_thread_conn_info &thread_conn_info = (*conn_info->thread_conn_info);
+	int num_threads = (int)thread_conn_info.size();
+	for (int ioffset = 1; ioffset < num_threads; ioffset++){
+		Conn_Info &victim = thread_conn_info[ (conn_info->thread_ind + ioffset) % num_threads ];
+
+		if ( victim.pair_queue.claim(PAIR_CHUNK_SIZE, false, start_pair, end_pair) ){
+			*pair_owner = &victim;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/* prints how long each thread was busy/idle while analyzing connections */
+static void print_thread_work_stats(t_thread_conn_info &thread_conn_info, double elapsed_seconds){
+	cout << "Thread work (" << elapsed_seconds << " seconds elapsed):" << endl;
+	for (int ithread = 0; ithread < (int)thread_conn_info.size(); ithread++){
+		Thread_Work_Stats &work_stats = thread_conn_info[ithread].work_stats;
+
+		cout << "  thread " << ithread << ": busy " << work_stats.busy_seconds << " s, idle " << max(0.0, elapsed_seconds - work_stats.busy_seconds) <<
+			" s, " << work_stats.num_pairs << " connections (" << work_stats.num_stolen_pairs << " stolen)" << endl;
+	}
+}
+
+
+/* prints how far apart, on average, the sources of consecutive connections of a thread were */
+static void print_task_locality_stats(t_thread_conn_info &thread_conn_info){
+	long num_source_changes = 0;
+	long source_change_tiles = 0;
+	for (int ithread = 0; ithread < (int)thread_conn_info.size(); ithread++){
+		Thread_Work_Stats &work_stats = thread_conn_info[ithread].work_stats;
+		num_source_changes += work_stats.num_source_changes;
+		source_change_tiles += work_stats.source_change_tiles;
+	}
+
+	double mean_tiles = 0;
+	if (num_source_changes > 0){
+		mean_tiles = (double)source_change_tiles / (double)num_source_changes;
+	}
+	cout << "Task locality: " << num_source_changes << " source changes, " << mean_tiles << " tiles apart on average" << endl;
+}
+
+
+/* puts the connections of the specified sources into the first 'num_pair_lists' pair lists of the threads, in the order given by
+   'task_order'. the same connections end up in the lists either way -- only their order and their split between lists changes */
+static void assign_source_tasks(vector<Source_Task> &source_tasks, e_task_order task_order, int grid_size_x, int grid_size_y,
+			t_thread_conn_info &thread_conn_info, int num_pair_lists){
+
+	int num_tasks = (int)source_tasks.size();
+
+	if (task_order == TASK_ORDER_ROW){
+		/* tiles were visited row by row. regular sources and virtual sources are each dealt out to the lists round-robin */
+		int ilist_source = 0;
+		int ilist_sink = 0;
+		for (int itask = 0; itask < num_tasks; itask++){
+			Source_Task &source_task = source_tasks[itask];
+			int &ilist = (source_task.pin_type == DRIVER) ? ilist_source : ilist_sink;
+
+			vector<Source_Sink_Pair> &source_sink_pairs = thread_conn_info[ilist].source_sink_pairs;
+			source_sink_pairs.insert(source_sink_pairs.end(), source_task.source_sink_pairs.begin(), source_task.source_sink_pairs.end());
+
+			ilist++;
+			if (ilist == num_pair_lists){
+				ilist = 0;
+			}
+		}
+	} else if (task_order == TASK_ORDER_HILBERT){
+		int curve_size = get_hilbert_curve_size(grid_size_x, grid_size_y);
+
+		/* sort the sources by the curve index of their tile. the sources of a tile keep the order in which they were generated */
+		vector< pair<long, int> > task_order_keys;
+		int num_pairs = 0;
+		for (int itask = 0; itask < num_tasks; itask++){
+			Coordinate &tile_coord = source_tasks[itask].tile_coord;
+			task_order_keys.push_back( make_pair(get_hilbert_curve_index(tile_coord.x, tile_coord.y, curve_size), itask) );
+			num_pairs += (int)source_tasks[itask].source_sink_pairs.size();
+		}
+		sort(task_order_keys.begin(), task_order_keys.end());
+
+		/* and split them into contiguous blocks with about the same number of connections each */
+		int pairs_before = 0;
+		for (int ikey = 0; ikey < num_tasks; ikey++){
+			Source_Task &source_task = source_tasks[ task_order_keys[ikey].second ];
+			int ilist = 0;
+			if (num_pairs > 0){
+				ilist = (int)( (long)pairs_before * num_pair_lists / num_pairs );
+			}
+
+			vector<Source_Sink_Pair> &source_sink_pairs = thread_conn_info[ilist].source_sink_pairs;
+			source_sink_pairs.insert(source_sink_pairs.end(), source_task.source_sink_pairs.begin(), source_task.source_sink_pairs.end());
+			pairs_before += (int)source_task.source_sink_pairs.size();
+		}
+	} else {
+		WTHROW(EX_PATH_ENUM, "Unexpected task order: " << task_order);
+	}
+}
+
+
+/* tells the distance cache of each thread (if any) which node weights the upcoming job analyzes connections with. the weights are
+   identified by a hash of their values rather than by a counter, so that fields found during an earlier job with the same weights
+   (i.e. the first enumeration round of each try of a demand multiplier search, which starts from cleared demands) can still be used */
+static void set_distance_cache_weight_snapshots(t_thread_conn_info &thread_conn_info, t_rr_node &rr_node){
+	if (thread_conn_info[0].distance_cache == NULL){
+		return;
+	}
+
+	/* FNV-1a hash of the bits of each node weight */
+	unsigned long long snapshot = 14695981039346656037ULL;
+	int num_nodes = (int)rr_node.size();
+	for (int inode = 0; inode < num_nodes; inode++){
+		float weight = rr_node[inode].get_weight();
+		unsigned weight_bits;
+		memcpy(&weight_bits, &weight, sizeof(weight_bits));
+
+		snapshot ^= weight_bits;
+		snapshot *= 1099511628211ULL;
+	}
+
+	for (int ithread = 0; ithread < (int)thread_conn_info.size(); ithread++){
+		thread_conn_info[ithread].distance_cache->set_weight_snapshot(snapshot);
+	}
+}
+
+
+/* prints how many of the distance field lookups of the last job hit the thread distance caches, and resets the counts */
+static void print_distance_cache_stats(t_thread_conn_info &thread_conn_info){
+	long num_lookups = 0;
+	long num_hits = 0;
+	for (int ithread = 0; ithread < (int)thread_conn_info.size(); ithread++){
+		Distance_Cache *distance_cache = thread_conn_info[ithread].distance_cache;
+		num_lookups += distance_cache->get_num_lookups();
+		num_hits += distance_cache->get_num_hits();
+		distance_cache->reset_stats();
+	}
+
+	cout << "Distance cache: " << num_hits << " of " << num_lookups << " lookups hit" << endl;
+}
+
+
 /* returns from_x/to_x/from_y/to_y iteration limits (inclusive) of a 'core' FPGA region that is CORE_OFFSET tiles away from the FPGA perimeter */
 static void get_prob_analysis_tile_region(User_Options *user_opts, int grid_size_x, int grid_size_y, int *from_x, int *from_y, int *to_x, int *to_y){
 
@@ -1134,21 +2253,21 @@ static int conns_at_distance_from_tile(int tile_x, int tile_y, int length, t_gri
 
 /* allocates source/sink distance vector for each thread */
 void alloc_thread_ss_distances(t_thread_ss_distances &thread_ss_distances, int num_threads, int num_nodes){
-	thread_ss_distances.assign(num_threads, t_ss_distances(num_nodes, SS_Distances()));
+	thread_ss_distances.assign(num_threads, t_ss_distances(num_nodes));
 }
 
 
-/* allocates node topological traversal info vector for each thread */
-void alloc_thread_node_topo_inf(t_thread_node_topo_inf &thread_node_topo_inf, int num_threads, int max_path_weight_bound, t_rr_node &rr_node, int num_nodes){
-	thread_node_topo_inf.assign(num_threads, t_node_topo_inf(num_nodes, Node_Topological_Info()));
-
-	//giving a bit of extra leeway
-	max_path_weight_bound *= 3;
+/* allocates node topological traversal info vector for each thread. node buckets are allocated as each connection
+   is analyzed (see Node_Topo_Inf_Vector) */
+void alloc_thread_node_topo_inf(User_Options *user_opts, t_thread_node_topo_inf &thread_node_topo_inf, int num_threads, int num_nodes){
+	thread_node_topo_inf.assign(num_threads, t_node_topo_inf(num_nodes));
 
-	for (int inode = 0; inode < num_nodes; inode++){
-		for (int ithread = 0; ithread < num_threads; ithread++){
-			thread_node_topo_inf[ithread][inode].buckets.alloc_source_sink_buckets(max_path_weight_bound+1, max_path_weight_bound+1);
-		}
+	/* per-multiplier source buckets are used to compute the routability curve (see User_Options::demand_multiplier_list), and
+	   demand discounts to account for self-congestion with the path dependence method */
+	int num_multipliers = (int)user_opts->demand_multiplier_list.size();
+	bool use_demand_discounts = (user_opts->self_congestion_mode == MODE_PATH_DEPENDENCE);
+	for (int ithread = 0; ithread < num_threads; ithread++){
+		thread_node_topo_inf[ithread].set_bucket_options(num_multipliers, use_demand_discounts);
 	}
 }
 
@@ -1167,9 +2286,6 @@ void alloc_self_congestion_structs(User_Options *user_opts, Routing_Structs *rou
 
 	if (user_opts->self_congestion_mode == MODE_PATH_DEPENDENCE){
 		for (int inode = 0; inode < num_nodes; inode++){
-			for (int ithread = 0; ithread < num_threads; ithread++){
-				thread_node_topo_inf[ithread][inode].demand_discounts.assign(max_path_weight_bound+1, 0.0);
-			}
 			rr_node[inode].alloc_child_demand_contributions(max_path_weight_bound+1);
 		}
 	} else if (user_opts->self_congestion_mode == MODE_RADIUS){
@@ -1181,15 +2297,6 @@ void alloc_self_congestion_structs(User_Options *user_opts, Routing_Structs *rou
 }
 
 
-/* allocates a t_nodes_visited structure for each thread */
-void alloc_thread_nodes_visited(t_thread_nodes_visited &thread_nodes_visited, int num_threads, int num_nodes){
-	thread_nodes_visited.assign(num_threads, t_nodes_visited());
-	for (int ithread = 0; ithread < num_threads; ithread++){
-		thread_nodes_visited[ithread].reserve(num_nodes);
-	}
-}
-
-
 /* allocates a Enumerate_Conn_Info structure for each thread */
 void alloc_thread_conn_info(t_thread_conn_info &thread_conn_info, int num_threads){
 	thread_conn_info.assign(num_threads, Conn_Info());
@@ -1207,7 +2314,9 @@ void alloc_threads( t_threads &threads, int num_threads ){
    metrics as necessary */
 static void analyze_connection(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
 			Routing_Structs *routing_structs, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int conn_length,
-			int number_conns_at_length, t_nodes_visited &nodes_visited, e_topological_mode topological_mode, User_Options *user_opts){
+			int number_conns_at_length, t_distance_pq &distance_pq, Nodes_Waiting_Heap &nodes_waiting,
+			Source_Batch *source_batch, Distance_Cache *distance_cache, e_topological_mode topological_mode, User_Options *user_opts,
+			t_demand_increments *demand_increments, Analysis_Results *results){
 
 	t_rr_node &rr_node = routing_structs->rr_node;
 
@@ -1248,8 +2357,8 @@ static void analyze_connection(int source_node_ind, int sink_node_ind, Analysis_
 		float scaling_factor_for_enumerate = (float)num_sinks * source_probability * length_prob / (float)number_conns_at_length;
 		enumerate_connection_paths(source_node_ind, sink_node_ind, analysis_settings, arch_structs, 
 							routing_structs, ss_distances, node_topo_inf, conn_length, 
-							nodes_visited, user_opts,
-							scaling_factor_for_enumerate);
+							distance_pq, nodes_waiting, source_batch, distance_cache, user_opts,
+							scaling_factor_for_enumerate, demand_increments, results);
 
 	} else if (topological_mode == PROBABILITY){
 		/* check whether this source node corresponds to pins of 'driver' or 'receiver' type to figure out which part of the reachability
@@ -1258,10 +2367,28 @@ static void analyze_connection(int source_node_ind, int sink_node_ind, Analysis_
 		Pin_Class &source_pin_class = fill_block_type.class_inf[source_ptc];
 		e_pin_type source_pin_type = source_pin_class.get_pin_type();
 
-		/* estimate probability of connection being routable and increment the probability metric */
+		/* in compare mode the connection is first analyzed with double-precision buckets, for reference */
+		bool float_buckets = (user_opts->bucket_precision != PRECISION_DOUBLE);
+		float reference_probability = UNDEFINED;
+		if (user_opts->bucket_precision == PRECISION_COMPARE){
+			reference_probability = estimate_connection_probability(source_node_ind, sink_node_ind, analysis_settings, arch_structs,
+							routing_structs, ss_distances, node_topo_inf, conn_length,
+							distance_pq, nodes_waiting, source_batch, distance_cache, user_opts, NULL, false);
+			clean_node_data_structs(ss_distances, node_topo_inf);
+		}
+
+		/* estimate probability of connection being routable (also at the demand multipliers of the routability curve, if any) */
+		vector<float> probs_at_multipliers;
 		float probability_connection_routable = estimate_connection_probability(source_node_ind, sink_node_ind, analysis_settings, arch_structs, 
 							routing_structs, ss_distances, node_topo_inf, conn_length, 
-							nodes_visited, user_opts);
+							distance_pq, nodes_waiting, source_batch, distance_cache, user_opts, &probs_at_multipliers, float_buckets);
+
+		if (user_opts->bucket_precision == PRECISION_COMPARE){
+			double abs_error = fabs((double)probability_connection_routable - (double)reference_probability);
+			results->precision_conns++;
+			results->precision_abs_error_sum += abs_error;
+			results->precision_max_abs_error = max(results->precision_max_abs_error, abs_error);
+		}
 
 		/* increment the probability metric */
 		if (probability_connection_routable >= 0){
@@ -1271,34 +2398,42 @@ static void analyze_connection(int source_node_ind, int sink_node_ind, Analysis_
 			/* increment probability metric */
 			int num_subsources = num_sources;
 			int num_subsinks = num_sinks;
-			increment_probability_metric(probability_increment, conn_length, source_node_ind, sink_node_ind, num_subsources, num_subsinks, source_pin_type);
+			increment_probability_metric(probability_increment, conn_length, source_node_ind, sink_node_ind, num_subsources, num_subsinks, source_pin_type,
+			                             results);
+
+			/* the worst-connection queues of the routability curve */
+			for (int imult = 0; imult < (int)probs_at_multipliers.size(); imult++){
+				vector<t_lowest_probs_pq> &lowest_probs_pqs = (source_pin_type == DRIVER ?
+				                                               results->multiplier_lowest_probs_pqs_drivers[imult] :
+				                                               results->multiplier_lowest_probs_pqs_fanout[imult]);
+				push_connection_probability(scaling_factor * probs_at_multipliers[imult], conn_length, num_subsources, num_subsinks,
+				                            lowest_probs_pqs);
+			}
 
 			/* add this connection's ideal probability to the running total (for normalizing later) */
-			pthread_mutex_lock(&f_analysis_results.thread_mutex);
 			if (source_pin_type == DRIVER){
-				f_analysis_results.max_possible_total_prob_drivers += scaling_factor * 1.0;	//1.0 because that's the max probability a connection can have
+				results->totals.max_possible_total_prob_drivers += scaling_factor * 1.0;	//1.0 because that's the max probability a connection can have
 			} else if (source_pin_type == RECEIVER){
-				f_analysis_results.max_possible_total_prob_fanout += scaling_factor * 1.0;
+				results->totals.max_possible_total_prob_fanout += scaling_factor * 1.0;
 				//cout << probability_connection_routable << " " << probability_increment << endl;
 			} else {
 				WTHROW(EX_PATH_ENUM, "Unexpected source pin type: " << source_pin_type);
 			}
-			pthread_mutex_unlock(&f_analysis_results.thread_mutex);
 		} else {
 			WTHROW(EX_PATH_ENUM, "Got negative connection probability: " << probability_connection_routable);
 		}
 	}
 
-	int max_path_weight = analysis_settings->get_max_path_weight(conn_length);
-	clean_node_data_structs(nodes_visited, ss_distances, node_topo_inf, max_path_weight);
+	clean_node_data_structs(ss_distances, node_topo_inf);
 }
 
 
-/* Enumerates paths between specified source/sink nodes. */
+/* Enumerates paths between specified source/sink nodes. If 'demand_increments' is not NULL, node demands are recorded there
+   instead of being added to the nodes. Connection counts are added to 'results' */
 void enumerate_connection_paths(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
 			Routing_Structs *routing_structs, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int conn_length,
-			t_nodes_visited &nodes_visited, User_Options *user_opts,
-			float scaling_factor_for_enumerate){
+			t_distance_pq &distance_pq, Nodes_Waiting_Heap &nodes_waiting, Source_Batch *source_batch, Distance_Cache *distance_cache,
+			User_Options *user_opts, float scaling_factor_for_enumerate, t_demand_increments *demand_increments, Analysis_Results *results){
 
 	t_rr_node &rr_node = routing_structs->rr_node;
 	/* get maximum allowable path weight of this connection */
@@ -1306,29 +2441,28 @@ void enumerate_connection_paths(int source_node_ind, int sink_node_ind, Analysis
 	int min_dist = UNDEFINED;
 
 	if (!get_ss_distances_and_adjust_max_path_weight(source_node_ind, sink_node_ind, rr_node, ss_distances, max_path_weight,
-					nodes_visited, &max_path_weight, &min_dist)){
+					distance_pq, source_batch, distance_cache, &max_path_weight, &min_dist)){
 		//could not reach source or sink
 		return;
 	}
 
+	/* nodes are handed buckets sized to this connection as they are first visited */
+	node_topo_inf.set_num_buckets( get_num_node_buckets(max_path_weight), false );
+
 	
-	pthread_mutex_lock(&g_mutex);
-	g_total_adjusted_enum_path_weight += (float)max_path_weight;	//XXX is this needed?
-	pthread_mutex_unlock(&g_mutex);
+	results->total_adjusted_enum_path_weight += max_path_weight;	//XXX is this needed?
 
 	/* perform path enumeration */
 	if (max_path_weight > 0 && min_dist > 0){
 
 		Enumerate_Structs enumerate_structs;
 		enumerate_structs.mode = BY_PATH_WEIGHT;
+		enumerate_structs.demand_increments = demand_increments;
 
 		/* enumerate paths from sink */
 		node_topo_inf[sink_node_ind].buckets.sink_buckets[0] = 1;
-		do_topological_traversal(sink_node_ind, source_node_ind, rr_node, ss_distances, node_topo_inf, BACKWARD_TRAVERSAL,
-					max_path_weight, user_opts, (void*)&enumerate_structs,
-					enumerate_node_popped_func,
-					enumerate_child_iterated_func,
-					enumerate_traversal_done_func);
+		do_enumerate_traversal(sink_node_ind, source_node_ind, rr_node, ss_distances, node_topo_inf, nodes_waiting, BACKWARD_TRAVERSAL,
+					max_path_weight, user_opts, enumerate_structs);
 
 		/* compute the number of paths to be enumerated from source (which accounts for the scaling factor) */
 		int source_node_weight = rr_node[source_node_ind].get_weight();
@@ -1349,16 +2483,11 @@ void enumerate_connection_paths(int source_node_ind, int sink_node_ind, Analysis
 		/* enumerate paths from source */
 		enumerate_structs.num_routing_nodes_in_subgraph = 0;
 		node_topo_inf[source_node_ind].buckets.source_buckets[0] = scaled_starting_source_paths;
-		do_topological_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
-					max_path_weight, user_opts, (void*)&enumerate_structs,
-					enumerate_node_popped_func,
-					enumerate_child_iterated_func,
-					enumerate_traversal_done_func);
+		do_enumerate_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, nodes_waiting, FORWARD_TRAVERSAL,
+					max_path_weight, user_opts, enumerate_structs);
 
 		/* increment number of connections for which paths have so far been enumerated */
-		pthread_mutex_lock(&f_analysis_results.thread_mutex);
-		f_analysis_results.num_conns++;
-		pthread_mutex_unlock(&f_analysis_results.thread_mutex);
+		results->num_conns++;
 	}
 }
 
@@ -1366,7 +2495,14 @@ void enumerate_connection_paths(int source_node_ind, int sink_node_ind, Analysis
 /* Estimates the likelyhood (based on node demands) that the specified source/sink connection can be routed */
 float estimate_connection_probability(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
 			Routing_Structs *routing_structs, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int conn_length,
-			t_nodes_visited &nodes_visited, User_Options *user_opts){
+			t_distance_pq &distance_pq, Nodes_Waiting_Heap &nodes_waiting, Source_Batch *source_batch, Distance_Cache *distance_cache,
+			User_Options *user_opts, vector<float> *probs_at_multipliers, bool float_buckets){
+
+	/* the multiplier lanes are only propagated in PROPAGATE mode */
+	int num_multipliers = (int)user_opts->demand_multiplier_list.size();
+	if (probs_at_multipliers != NULL){
+		probs_at_multipliers->assign(num_multipliers, 0.0);
+	}
 	
 	//float probability_sink_reachable = UNDEFINED;	//some sources/sinks just have no chance of connecting within specified max_path_weight. in that case want to return 0
 	float probability_sink_reachable = 0;
@@ -1377,11 +2513,14 @@ float estimate_connection_probability(int source_node_ind, int sink_node_ind, An
 	int min_dist = UNDEFINED;
 
 	if (!get_ss_distances_and_adjust_max_path_weight(source_node_ind, sink_node_ind, rr_node, ss_distances, max_path_weight,
-					nodes_visited, &max_path_weight, &min_dist)){
+					distance_pq, source_batch, distance_cache, &max_path_weight, &min_dist)){
 		//could not reach source or sink
 		return 0.0;
 	}
 
+	/* nodes are handed buckets sized to this connection as they are first visited */
+	node_topo_inf.set_num_buckets( get_num_node_buckets(max_path_weight), float_buckets );
+
 	/* Get a pointer to the fill type block descriptor -- the one that describes a regular logic block.
 	   If a fill type descriptor has never been set (such as when the graph read-in by Wotan is 'simple' and
 	   doesn't represent an FPGA), the fill type pointer is set to NULL */
@@ -1407,17 +2546,13 @@ float estimate_connection_probability(int source_node_ind, int sink_node_ind, An
 
 			Cutline_Structs cutline_structs;
 			cutline_structs.fill_type = fill_type;
-			do_topological_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
-						max_path_weight, user_opts, (void*)&cutline_structs,
-						cutline_node_popped_func,
-						cutline_child_iterated_func,
-						cutline_traversal_done_func);
+			do_cutline_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, nodes_waiting, FORWARD_TRAVERSAL,
+						max_path_weight, user_opts, cutline_structs);
 
 			probability_sink_reachable = cutline_structs.prob_routable;
 
 		} else if ( PROBABILITY_MODE == CUTLINE_SIMPLE ){
-			set_node_hops(source_node_ind, sink_node_ind, rr_node, ss_distances, max_path_weight, FORWARD_TRAVERSAL);
-			set_node_hops(sink_node_ind, source_node_ind, rr_node, ss_distances, max_path_weight, BACKWARD_TRAVERSAL);
+			set_connection_hops(source_node_ind, sink_node_ind, rr_node, ss_distances, max_path_weight, distance_cache);
 
 			/* get hops from source to sink; size the cutline prob struct vector based on that */
 			int source_sink_hops = ss_distances[source_node_ind].get_sink_hops();	//hops from sink
@@ -1426,17 +2561,13 @@ float estimate_connection_probability(int source_node_ind, int sink_node_ind, An
 			cutline_simple_structs.cutline_simple_prob_struct.assign(source_sink_hops-1, vector<int>());
 			cutline_simple_structs.fill_type = fill_type;
 			
-			do_topological_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
-						max_path_weight, user_opts, (void*)&cutline_simple_structs,
-						cutline_simple_node_popped_func,
-						cutline_simple_child_iterated_func,
-						cutline_simple_traversal_done_func);
+			do_cutline_simple_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, nodes_waiting, FORWARD_TRAVERSAL,
+						max_path_weight, user_opts, cutline_simple_structs);
 
 			probability_sink_reachable = cutline_simple_structs.prob_routable;
 
 		} else if ( PROBABILITY_MODE == CUTLINE_RECURSIVE ){
-			set_node_hops(source_node_ind, sink_node_ind, rr_node, ss_distances, max_path_weight, FORWARD_TRAVERSAL);
-			set_node_hops(sink_node_ind, source_node_ind, rr_node, ss_distances, max_path_weight, BACKWARD_TRAVERSAL);
+			set_connection_hops(source_node_ind, sink_node_ind, rr_node, ss_distances, max_path_weight, distance_cache);
 
 			Cutline_Recursive_Structs cutline_rec_structs;
 
@@ -1448,35 +2579,48 @@ float estimate_connection_probability(int source_node_ind, int sink_node_ind, An
 			cutline_rec_structs.sink_ind = sink_node_ind;
 			cutline_rec_structs.fill_type = fill_type;
 
-			do_topological_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
-						max_path_weight, user_opts, (void*)&cutline_rec_structs,
-						cutline_recursive_node_popped_func,
-						cutline_recursive_child_iterated_func,
-						cutline_recursive_traversal_done_func);
+			do_cutline_recursive_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, nodes_waiting, FORWARD_TRAVERSAL,
+						max_path_weight, user_opts, cutline_rec_structs);
 
 			probability_sink_reachable = cutline_rec_structs.prob_routable;
 
 		} else if ( PROBABILITY_MODE == PROPAGATE ){
-			node_topo_inf[source_node_ind].buckets.source_buckets[0] = 1;
-
 			Propagate_Structs propagate_structs;
 			propagate_structs.fill_type = fill_type;
-			do_topological_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
-						max_path_weight, user_opts, (void*)&propagate_structs,
-						propagate_node_popped_func,
-						propagate_child_iterated_func,
-						propagate_traversal_done_func);
+			propagate_structs.float_buckets = float_buckets;
+
+			/* node demands at each multiplier of the routability curve are the current demands scaled by (multiplier / demand multiplier).
+			   the fixed demand set by -use_routing_node_demand doesn't depend on the multiplier (see RR_Node::get_demand) */
+			if (probs_at_multipliers != NULL){
+				for (int imult = 0; imult < num_multipliers; imult++){
+					double demand_scale = 1.0;
+					if (user_opts->use_routing_node_demand <= 0){
+						demand_scale = user_opts->demand_multiplier_list[imult] / user_opts->demand_multiplier;
+					}
+					propagate_structs.demand_scales.push_back( demand_scale );
+				}
+			}
+			int num_demand_scales = (int)propagate_structs.demand_scales.size();
+			if (float_buckets){
+				init_source_node_probabilities(node_topo_inf[source_node_ind].float_buckets, num_demand_scales);
+			} else {
+				init_source_node_probabilities(node_topo_inf[source_node_ind].buckets, num_demand_scales);
+			}
+			do_propagate_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, nodes_waiting, FORWARD_TRAVERSAL,
+						max_path_weight, user_opts, propagate_structs);
 			
 
 			probability_sink_reachable = propagate_structs.prob_routable;
+			if (probs_at_multipliers != NULL){
+				*probs_at_multipliers = propagate_structs.prob_routable_at_scale;
+			}
 
 		} else if ( PROBABILITY_MODE == RELIABILITY_POLYNOMIAL ){
 			if (user_opts->use_routing_node_demand == UNDEFINED){
 				WTHROW(EX_PATH_ENUM, "Probability mode was set to RELIABILITY_POLYNOMIAL. But user_opts->use_routing_node_demand was not set!");
 			}
 
-			set_node_hops(source_node_ind, sink_node_ind, rr_node, ss_distances, max_path_weight, FORWARD_TRAVERSAL);
-			set_node_hops(sink_node_ind, source_node_ind, rr_node, ss_distances, max_path_weight, BACKWARD_TRAVERSAL);
+			set_connection_hops(source_node_ind, sink_node_ind, rr_node, ss_distances, max_path_weight, distance_cache);
 
 			/* enumerate paths from source */
 			/* note -- this increments node demands a second time. but since we will be ignoring node demands completely, this is fine */
@@ -1484,14 +2628,11 @@ float estimate_connection_probability(int source_node_ind, int sink_node_ind, An
 			enumerate_structs.mode = BY_PATH_HOPS;
 
 			node_topo_inf[source_node_ind].buckets.source_buckets[0] = 1;	//one path at bucket 0 -- gotta start with something
-			do_topological_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
-						max_path_weight, user_opts, (void*)&enumerate_structs,
-						enumerate_node_popped_func,
-						enumerate_child_iterated_func,
-						enumerate_traversal_done_func);
+			do_enumerate_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, nodes_waiting, FORWARD_TRAVERSAL,
+						max_path_weight, user_opts, enumerate_structs);
 
 			int source_sink_hops = ss_distances[sink_node_ind].get_source_hops();
-			Node_Buckets &sink_node_buckets = node_topo_inf[sink_node_ind].buckets;
+			Node_Buckets<double> &sink_node_buckets = node_topo_inf[sink_node_ind].buckets;
 			double *source_buckets = sink_node_buckets.source_buckets;
 			int num_source_buckets = sink_node_buckets.get_num_source_buckets();
 
@@ -1516,7 +2657,8 @@ float estimate_connection_probability(int source_node_ind, int sink_node_ind, An
    also returns an adjusted maximum path weight (to be further passed on to path enumeration / probability analysis functions)
    based on the distance from the source to the sink */
 bool get_ss_distances_and_adjust_max_path_weight(int source_node_ind, int sink_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
-                                int max_path_weight, t_nodes_visited &nodes_visited, int *adjusted_max_path_weight, int *source_sink_dist){
+                                int max_path_weight, t_distance_pq &distance_pq, Source_Batch *source_batch,
+				Distance_Cache *distance_cache, int *adjusted_max_path_weight, int *source_sink_dist){
 	
 	/* 
 	XXX: initial max_path_weight passed to this function affects the final enumeration and probability analysis. I think this happens because
@@ -1529,26 +2671,58 @@ bool get_ss_distances_and_adjust_max_path_weight(int source_node_ind, int sink_n
 			- i've moved the BACKWARD_TRAVERSAL set_node_distances call *after* adjusting max path weight. will see how this affects things
 	*/
 
+	/* the fields may have been found before, with the same node weights */
+	int initial_max_path_weight = max_path_weight;
+	vector<int> *visited_nodes = NULL;
+	if (distance_cache != NULL){
+		Distance_Field *field = distance_cache->restore(source_node_ind, sink_node_ind, initial_max_path_weight, ss_distances);
+		if (field != NULL){
+			(*adjusted_max_path_weight) = field->adjusted_max_path_weight;
+			(*source_sink_dist) = field->source_sink_dist;
+			return field->reachable;
+		}
+
+		/* the nodes visited from the sink are the only ones that can be part of the legal subgraph, and are what gets cached */
+		visited_nodes = &distance_cache->visited_nodes;
+		visited_nodes->clear();
+	}
+
 	/* set node distances for potentially relevant portion of graph */
-	set_node_distances(source_node_ind, sink_node_ind, rr_node, ss_distances, max_path_weight, FORWARD_TRAVERSAL, nodes_visited);
+	if (source_batch != NULL && source_batch->has_distances){
+		/* the source distances were found for the whole batch of connections of this source, and nodes are handed them as they
+		   are accessed */
+		if (source_batch->source_ind != source_node_ind){
+			WTHROW(EX_PATH_ENUM, "Shared source distances are from node " << source_batch->source_ind << " rather than from source " << source_node_ind);
+		}
+	} else {
+		set_node_distances(source_node_ind, sink_node_ind, rr_node, ss_distances, max_path_weight, FORWARD_TRAVERSAL, distance_pq, NULL);
+	}
 
 	/* adjust maximum allowable path weight based on minimum distance. FIXME. this may not work well for multiple wirelengths */
 	int min_dist_sink = ss_distances[sink_node_ind].get_source_distance();
 
 	if (min_dist_sink < 0){
+		if (distance_cache != NULL){
+			distance_cache->store(source_node_ind, sink_node_ind, initial_max_path_weight, false, UNDEFINED, UNDEFINED,
+						*visited_nodes, ss_distances);
+		}
 		return false;
 	}
 
 	max_path_weight = adjust_max_path_weight_based_on_ss_dist(min_dist_sink, max_path_weight);
 
-
-	set_node_distances(sink_node_ind, source_node_ind, rr_node, ss_distances, max_path_weight, BACKWARD_TRAVERSAL, nodes_visited);
+	set_node_distances(sink_node_ind, source_node_ind, rr_node, ss_distances, max_path_weight, BACKWARD_TRAVERSAL, distance_pq, visited_nodes);
 	int min_dist_source = ss_distances[source_node_ind].get_sink_distance();
 	if (min_dist_sink != min_dist_source){
 		//commented because this can throw when we use dynamic node weights (in RR_Node::set_weight)
 		//WTHROW(EX_PATH_ENUM, "Distance to source doesn't match distance to sink. " << min_dist_source << " vs " << min_dist_sink << endl);
 	}
 
+	if (distance_cache != NULL){
+		distance_cache->store(source_node_ind, sink_node_ind, initial_max_path_weight, (min_dist_source >= 0), max_path_weight, min_dist_sink,
+					*visited_nodes, ss_distances);
+	}
+
 	if (min_dist_source < 0){
 		return false;
 	}
@@ -1572,13 +2746,148 @@ int adjust_max_path_weight_based_on_ss_dist(int min_dist_sink, int current_max_p
 }
 
 
+/* makes sure that the current source batch of a thread is the batch that pair 'ipair' of the specified list belongs to. the batch
+   doesn't extend past pairs [from_pair, to_pair) of the list. if a new batch has to be started, its source distances are found by a
+   forward traversal that goes up to the largest maximum path weight of the batch's connections, and that skips only the nodes that
+   can't reach any of the batch's sinks. these distances are then shared by the connections of the batch */
+static void update_source_batch(vector<Source_Sink_Pair> &source_sink_pairs, int ipair, int from_pair, int to_pair,
+			Analysis_Settings *analysis_settings, t_rr_node &rr_node, t_ss_distances &ss_distances, t_distance_pq &distance_pq,
+			Distance_Cache *distance_cache, Source_Batch &source_batch){
+
+	if (source_batch.source_sink_pairs == &source_sink_pairs && ipair >= source_batch.start_pair && ipair < source_batch.end_pair){
+		return;
+	}
+
+	/* the batch is the run of pairs with the same source around 'ipair' */
+	int source_node_ind = source_sink_pairs[ipair].source_ind;
+	int start_pair = ipair;
+	while (start_pair > from_pair && source_sink_pairs[start_pair-1].source_ind == source_node_ind){
+		start_pair--;
+	}
+	int end_pair = ipair + 1;
+	while (end_pair < to_pair && source_sink_pairs[end_pair].source_ind == source_node_ind){
+		end_pair++;
+	}
+
+	source_batch.source_sink_pairs = &source_sink_pairs;
+	source_batch.start_pair = start_pair;
+	source_batch.end_pair = end_pair;
+	source_batch.source_ind = source_node_ind;
+	source_batch.has_distances = false;
+
+	ss_distances.reset_shared_source_distances();
+
+	/* the shared distances aren't needed if the fields of all the batch's connections can be taken from the cache */
+	bool all_cached = (distance_cache != NULL);
+	int path_weight_bound = 0;
+	for (int jpair = start_pair; jpair < end_pair; jpair++){
+		int max_path_weight = analysis_settings->get_max_path_weight( source_sink_pairs[jpair].ss_length );
+		path_weight_bound = max(path_weight_bound, max_path_weight);
+
+		if (all_cached && !distance_cache->contains(source_node_ind, source_sink_pairs[jpair].sink_ind, max_path_weight)){
+			all_cached = false;
+		}
+	}
+	if (all_cached){
+		ss_distances.reset();
+		return;
+	}
+	source_batch.has_distances = true;
+
+	/* dijkstra's algorithm, as in set_node_distances. a node has been visited once it has a shared distance */
+
+	t_distance_pq &PQ = distance_pq;
+	PQ.reset( path_weight_bound*6 );
+
+	PQ.push(source_node_ind, 0);
+	ss_distances.set_shared_source_distance(source_node_ind, 0);
+
+	while(PQ.size() != 0){
+		int node_ind = PQ.top();
+		int node_path_weight = PQ.top_weight();
+		PQ.pop();
+
+		int *edge_list = rr_node[node_ind].out_edges;
+		int num_children = rr_node[node_ind].get_num_out_edges();
+		for (int iedge = 0; iedge < num_children; iedge++){
+			int child_ind = edge_list[iedge];
+			if (ss_distances.get_shared_source_distance(child_ind) != UNDEFINED){
+				continue;
+			}
+
+			int child_weight = rr_node[child_ind].get_weight();
+			int path_weight = node_path_weight + child_weight;
+			if (!node_has_chance_to_reach_batch_sink(child_ind, path_weight, source_batch, analysis_settings, rr_node)){
+				continue;
+			}
+
+			ss_distances.set_shared_source_distance(child_ind, path_weight);
+			PQ.push(child_ind, path_weight);
+		}
+	}
+
+	/* entries accessed from now on are handed the new shared distances */
+	ss_distances.reset();
+}
+
+
+/* returns whether the specified node, which terminates a path of weight 'node_path_weight' from the source of the batch, has a
+   chance to reach the sink of any of the batch's connections. any node that the forward traversal of set_node_distances would
+   keep for one of the connections is kept here as well. the connection's legal subgraph (see SS_Distances::is_legal) is therefore
+   unchanged: the extra nodes, which do get a source distance, are left without a sink distance by the connection's backward traversal */
+static bool node_has_chance_to_reach_batch_sink(int node_ind, int node_path_weight, Source_Batch &source_batch,
+			Analysis_Settings *analysis_settings, t_rr_node &rr_node){
+
+	vector<Source_Sink_Pair> &source_sink_pairs = *source_batch.source_sink_pairs;
+	bool is_ipin = (rr_node[node_ind].get_rr_type() == IPIN);
+
+	for (int ipair = source_batch.start_pair; ipair < source_batch.end_pair; ipair++){
+		int sink_node_ind = source_sink_pairs[ipair].sink_ind;
+		int destx = rr_node[sink_node_ind].get_xlow();
+		int desty = rr_node[sink_node_ind].get_ylow();
+
+		if (is_ipin){
+			if (rr_node[node_ind].get_xlow() != destx && rr_node[node_ind].get_ylow() != desty){
+				continue;
+			}
+		}
+
+		int max_path_weight = analysis_settings->get_max_path_weight( source_sink_pairs[ipair].ss_length );
+		if (node_has_chance_to_reach_destination(node_ind, destx, desty, node_path_weight, max_path_weight, rr_node)){
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/* sets the source buckets (and multiplier buckets, if any) of the source node to a probability of 1 at path weight 0 */
+template <typename T> static void init_source_node_probabilities(Node_Buckets<T> &source_node_buckets, int num_multipliers){
+	source_node_buckets.source_buckets[0] = 1;
+	for (int imult = 0; imult < num_multipliers; imult++){
+		source_node_buckets.multiplier_buckets[imult] = 1;
+	}
+}
+
+
+/* returns the number of source/sink buckets each node needs during the analysis of a connection with the specified
+   maximum path weight */
+static int get_num_node_buckets(int max_path_weight){
+	//giving a bit of extra leeway -- node weights can change during the connection, and paths counted by hops
+	//can be a few hops longer than the max path weight
+	return 3*(max_path_weight + 1);
+}
+
+
 /* traverses graph from 'from_node_ind' and for each node traversed, sets distance to the source/sink node from
-   which the traversal started (based on traversal_dir) */
+   which the traversal started (based on traversal_dir). if 'visited_nodes' is not NULL, the nodes marked as visited are added to it */
 void set_node_distances(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
-			int max_path_weight, e_traversal_dir traversal_dir, t_nodes_visited &nodes_visited){
+			int max_path_weight, e_traversal_dir traversal_dir, t_distance_pq &distance_pq, vector<int> *visited_nodes){
 	
-	/* define a bounded-height priority queue in which to store nodes during traversal */
-	My_Bounded_Priority_Queue< int > PQ( max_path_weight*6 );
+	/* the bucket priority queue in which nodes are stored during traversal is reused between traversals */
+	t_distance_pq &PQ = distance_pq;
+	PQ.reset( max_path_weight*6 );
 	int *edge_list;
 	int num_children;
 
@@ -1592,6 +2901,9 @@ void set_node_distances(int from_node_ind, int to_node_ind, t_rr_node &rr_node,
 		ss_distances[from_node_ind].set_sink_distance(0);
 		ss_distances[from_node_ind].set_visited_from_sink(true);
 	}
+	if (visited_nodes != NULL){
+		visited_nodes->push_back(from_node_ind);
+	}
 	
 	/* and now perform dijkstra's algorithm */
 	while(PQ.size() != 0){
@@ -1617,9 +2929,7 @@ void set_node_distances(int from_node_ind, int to_node_ind, t_rr_node &rr_node,
 
 		/* now iterate over children of this node and selectively push them onto the queue */
 		put_children_on_pq_and_set_ss_distance(num_children, edge_list, node_path_weight, ss_distances, max_path_weight, 
-						traversal_dir, rr_node, to_node_ind, &PQ);
-
-		nodes_visited.push_back( node_ind );
+						traversal_dir, rr_node, to_node_ind, &PQ, visited_nodes);
 	}
 }
 
@@ -1627,7 +2937,8 @@ void set_node_distances(int from_node_ind, int to_node_ind, t_rr_node &rr_node,
    enqueued nodes will be base_weight + their own weight.
    also... TODO */
 void put_children_on_pq_and_set_ss_distance(int num_edges, int *edge_list, int base_weight, t_ss_distances &ss_distances,
-		int max_path_weight, e_traversal_dir traversal_dir, t_rr_node &rr_node, int to_node_ind, My_Bounded_Priority_Queue<int> *PQ){
+		int max_path_weight, e_traversal_dir traversal_dir, t_rr_node &rr_node, int to_node_ind, t_distance_pq *PQ,
+		vector<int> *visited_nodes){
 
 	int dest_xlow, dest_xhigh, dest_ylow, dest_yhigh;
 	
@@ -1695,6 +3006,9 @@ void put_children_on_pq_and_set_ss_distance(int num_edges, int *edge_list, int b
 				continue;
 			}
 		}
+		if (visited_nodes != NULL){
+			visited_nodes->push_back(node_ind);
+		}
 		if (path_weight <= max_path_weight){
 			PQ->push(node_ind, path_weight);
 		}
@@ -1836,43 +3150,34 @@ void set_node_hops(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_
 }
 
 
-/* resets data structures associated with nodes that have been visited during the previous path traversals */
-void clean_node_data_structs(t_nodes_visited &nodes_visited, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int max_path_weight){
-
-	clean_ss_distances(ss_distances, nodes_visited);
-	clean_node_topo_inf(node_topo_inf, nodes_visited, max_path_weight);
-
-	nodes_visited.clear();
-}
+/* sets the source and sink hops of the legal nodes of a connection, unless they were restored from 'distance_cache' along with the
+   connection's distances. if the connection's distances are cached, the hops are cached with them */
+static void set_connection_hops(int source_node_ind, int sink_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+			int max_path_weight, Distance_Cache *distance_cache){
 
-/* clears ss_distances structure according to nodes that have been visited during graph traversal */
-void clean_ss_distances(t_ss_distances &ss_distances, t_nodes_visited &nodes_visited){
-	int num_nodes_visited = (int)nodes_visited.size();
+	/* the current field of the cache belongs to this connection (see get_ss_distances_and_adjust_max_path_weight) */
+	Distance_Field *field = NULL;
+	if (distance_cache != NULL){
+		field = distance_cache->get_current_field();
+	}
+	if (field != NULL && field->has_hops){
+		return;
+	}
 
-	for (int inode = 0; inode < num_nodes_visited; inode++){
-		int node_ind = nodes_visited[inode];
+	set_node_hops(source_node_ind, sink_node_ind, rr_node, ss_distances, max_path_weight, FORWARD_TRAVERSAL);
+	set_node_hops(sink_node_ind, source_node_ind, rr_node, ss_distances, max_path_weight, BACKWARD_TRAVERSAL);
 
-		/* clear distances of node to source/sink */
-		if (ss_distances[node_ind].get_visited_from_source() || 
-		    ss_distances[node_ind].get_visited_from_sink()){
-			ss_distances[node_ind].clear();
-		}
+	if (field != NULL){
+		distance_cache->store_hops(ss_distances);
 	}
 }
 
-/* clears node_buckets structure according to nodes that have been visited during graph traversal */
-void clean_node_topo_inf(t_node_topo_inf &node_topo_inf, t_nodes_visited &nodes_visited, int max_path_weight){
-	int num_nodes_visited = (int)nodes_visited.size();
 
-	for (int inode = 0; inode < num_nodes_visited; inode++){
-		int node_ind = nodes_visited[inode];
-
-		/* clear node buckets */
-		if (node_topo_inf[node_ind].get_was_visited()){
-			//node_topo_inf[node_ind].buckets.clear_up_to(max_path_weight);
-			node_topo_inf[node_ind].clear();
-		} 
-	}
+/* resets data structures associated with nodes that have been visited during the previous path traversals. the structures are
+   epoch-stamped, so this only starts a new epoch; the entries of visited nodes are cleared when they are next accessed */
+void clean_node_data_structs(t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf){
+	ss_distances.reset();
+	node_topo_inf.reset();
 }
 
 /* returns the sum of pin probabilities over all the pins that the specified source node represents */
@@ -1948,9 +3253,9 @@ int get_num_sources(int source_node_ind, t_rr_node &rr_node, Physical_Type_Descr
 	return num_sources;
 }
 
-/* function for a thread to increment the probability metric */
+/* function for a thread to increment the probability metric of its (partial) analysis results */
 void increment_probability_metric(float probability_increment, int connection_length, int source_node_ind, int sink_node_ind,
-				int num_subsources, int num_subsinks, e_pin_type source_pin_type){
+				int num_subsources, int num_subsinks, e_pin_type source_pin_type, Analysis_Results *results){
 
 	double *total_prob;
 	vector<t_lowest_probs_pq> *lowest_probs_pqs;
@@ -1959,31 +3264,35 @@ void increment_probability_metric(float probability_increment, int connection_le
 	   currently connections are analyzed separately from regular sources and 'virtual' sources which are
 	   attached alongside sinks and connect to the channel tracks from which the sink is immediately reachable (to account for fanout-like effects) */
 	if (source_pin_type == DRIVER){
-		total_prob = &f_analysis_results.total_prob_drivers;
-		lowest_probs_pqs = &f_analysis_results.lowest_probs_pqs_drivers;
+		total_prob = &results->totals.total_prob_drivers;
+		lowest_probs_pqs = &results->lowest_probs_pqs_drivers;
 	} else if (source_pin_type == RECEIVER){
-		total_prob = &f_analysis_results.total_prob_fanout;
-		lowest_probs_pqs = &f_analysis_results.lowest_probs_pqs_fanout;
+		total_prob = &results->totals.total_prob_fanout;
+		lowest_probs_pqs = &results->lowest_probs_pqs_fanout;
 	} else {
 		WTHROW(EX_PATH_ENUM, "Unexpected pin type: " << source_pin_type);
 	}
 
-	pthread_mutex_lock(&f_analysis_results.thread_mutex);
 	*total_prob += probability_increment;
 	
+	push_connection_probability(probability_increment, connection_length, num_subsources, num_subsinks, *lowest_probs_pqs);
+}
+
+
+/* pushes a connection's (scaled) probability onto the lowest-probability queue of its length */
+static void push_connection_probability(float probability_increment, int connection_length, int num_subsources, int num_subsinks,
+				vector<t_lowest_probs_pq> &lowest_probs_pqs){
 	/* account for multiple sources/sinks being present in a supersource/supersink */
 	int div_factor = num_subsources * num_subsinks;
 	float push_value = probability_increment / (float)div_factor;
 	for (int i = 0; i < div_factor; i++){
-		(*lowest_probs_pqs)[connection_length].push( push_value );
+		lowest_probs_pqs[connection_length].push( push_value );
 	}
-
-	pthread_mutex_unlock(&f_analysis_results.thread_mutex);
 }
 
 
 /* at each length, sums the probabilities of the x% worst possible connections */
-static float analyze_lowest_probs_pqs(vector<t_lowest_probs_pq> &lowest_probs_pqs){
+static float analyze_lowest_probs_pqs(vector<t_lowest_probs_pq> &lowest_probs_pqs, bool print){
 	float result = 0;
 
 	int num_lengths = (int)lowest_probs_pqs.size();
@@ -1999,13 +3308,128 @@ static float analyze_lowest_probs_pqs(vector<t_lowest_probs_pq> &lowest_probs_pq
 			lowest_probs_pqs[ilen].pop();
 		}
 
-		cout << "len" << ilen << " result: " << result_at_len << endl;
+		if (print){
+			cout << "len" << ilen << " result: " << result_at_len << endl;
+		}
 	}
 
 	return result;
 }
 
 
+/* computes the routability metric from the worst-connection queues and the probability totals of 'analysis_results'.
+   the queues are emptied */
+static float get_routability_metric(User_Options *user_opts, Analysis_Results &analysis_results, vector<t_lowest_probs_pq> &lowest_probs_pqs_drivers,
+				vector<t_lowest_probs_pq> &lowest_probs_pqs_fanout, bool print){
+	float opin_prob = user_opts->opin_probability;
+	float ipin_prob = user_opts->ipin_probability;
+
+	/* compute the two parts of the routability metric (driver & fanout) */
+	float worst_probabilities_driver = 0;
+	float worst_probabilities_fanout = 0;
+	float driver_prob_metric = 0;
+	float fanout_prob_metric = 0;
+	if (opin_prob != 0){
+		worst_probabilities_driver = analyze_lowest_probs_pqs( lowest_probs_pqs_drivers, print );
+		driver_prob_metric = worst_probabilities_driver / (analysis_results.totals.max_possible_total_prob_drivers * WORST_ROUTABILITY_PERCENTILE_DRIVERS);
+	}
+
+	if (ipin_prob != 0){
+		worst_probabilities_fanout = analyze_lowest_probs_pqs( lowest_probs_pqs_fanout, print );
+		fanout_prob_metric = worst_probabilities_fanout / (analysis_results.totals.max_possible_total_prob_fanout * WORST_ROUTABILITY_PERCENTILE_FANOUT);
+	}
+
+	if (print){
+		cout << "Driver metric: " << driver_prob_metric << endl;
+		cout << "Fanout metric: " << fanout_prob_metric << endl;
+	}
+
+	/* combine the two parts of the routability metric into a single number */
+	float driver_prob_weight = 1;
+	float fanout_prob_weight = 1;
+	if (opin_prob > 0 && ipin_prob > 0){
+		driver_prob_weight = DRIVER_PROB_WEIGHT;
+		fanout_prob_weight = FANOUT_PROB_WEIGHT;
+	}
+	
+	float routability_metric = (driver_prob_weight * driver_prob_metric) + (fanout_prob_weight * fanout_prob_metric);
+
+	return routability_metric;
+}
+
+
+/* empties each of the specified queues (their size limits are kept) */
+static void clear_lowest_probs_pqs(vector<t_lowest_probs_pq> &lowest_probs_pqs){
+	for (int ilen = 0; ilen < (int)lowest_probs_pqs.size(); ilen++){
+		lowest_probs_pqs[ilen].clear();
+	}
+}
+
+
+/* resets the partial results of each thread, and sizes each thread's per-pair probability totals. the partial lowest-probability
+   queues get the same size limits as those of 'analysis_results' -- the x% worst connections overall are always among the x% worst
+   connections of the thread that analyzed them */
+static void init_partial_results(t_thread_conn_info &thread_conn_info, Analysis_Results &analysis_results){
+	for (int ithread = 0; ithread < (int)thread_conn_info.size(); ithread++){
+		Conn_Info &conn_info = thread_conn_info[ithread];
+		Analysis_Results &partial_results = conn_info.partial_results.results;
+
+		partial_results = Analysis_Results();
+		partial_results.lowest_probs_pqs_drivers = analysis_results.lowest_probs_pqs_drivers;
+		partial_results.lowest_probs_pqs_fanout = analysis_results.lowest_probs_pqs_fanout;
+		clear_lowest_probs_pqs(partial_results.lowest_probs_pqs_drivers);
+		clear_lowest_probs_pqs(partial_results.lowest_probs_pqs_fanout);
+
+		partial_results.multiplier_lowest_probs_pqs_drivers = analysis_results.multiplier_lowest_probs_pqs_drivers;
+		partial_results.multiplier_lowest_probs_pqs_fanout = analysis_results.multiplier_lowest_probs_pqs_fanout;
+		for (int imult = 0; imult < (int)partial_results.multiplier_lowest_probs_pqs_drivers.size(); imult++){
+			clear_lowest_probs_pqs(partial_results.multiplier_lowest_probs_pqs_drivers[imult]);
+			clear_lowest_probs_pqs(partial_results.multiplier_lowest_probs_pqs_fanout[imult]);
+		}
+
+		conn_info.pair_totals.assign(conn_info.source_sink_pairs.size(), Probability_Totals());
+	}
+}
+
+
+/* merges the partial results of each thread into 'analysis_results'. probability totals are summed in thread list/pair order,
+   so the floating-point sums are the same on every run regardless of which thread analyzed which pair */
+static void merge_partial_results(t_thread_conn_info &thread_conn_info, Analysis_Results &analysis_results){
+	for (int ithread = 0; ithread < (int)thread_conn_info.size(); ithread++){
+		Conn_Info &conn_info = thread_conn_info[ithread];
+		Analysis_Results &partial_results = conn_info.partial_results.results;
+
+		for (int ipair = 0; ipair < (int)conn_info.pair_totals.size(); ipair++){
+			analysis_results.totals.add( conn_info.pair_totals[ipair] );
+		}
+
+		analysis_results.num_conns += partial_results.num_conns;
+		analysis_results.total_adjusted_enum_path_weight += partial_results.total_adjusted_enum_path_weight;
+		analysis_results.precision_conns += partial_results.precision_conns;
+		analysis_results.precision_abs_error_sum += partial_results.precision_abs_error_sum;
+		analysis_results.precision_max_abs_error = max(analysis_results.precision_max_abs_error, partial_results.precision_max_abs_error);
+
+		merge_lowest_probs_pqs(partial_results.lowest_probs_pqs_drivers, analysis_results.lowest_probs_pqs_drivers);
+		merge_lowest_probs_pqs(partial_results.lowest_probs_pqs_fanout, analysis_results.lowest_probs_pqs_fanout);
+		for (int imult = 0; imult < (int)partial_results.multiplier_lowest_probs_pqs_drivers.size(); imult++){
+			merge_lowest_probs_pqs(partial_results.multiplier_lowest_probs_pqs_drivers[imult], analysis_results.multiplier_lowest_probs_pqs_drivers[imult]);
+			merge_lowest_probs_pqs(partial_results.multiplier_lowest_probs_pqs_fanout[imult], analysis_results.multiplier_lowest_probs_pqs_fanout[imult]);
+		}
+	}
+}
+
+
+/* pushes the entries of each 'from' queue onto the 'to' queue of the same length. the 'from' queues are emptied */
+static void merge_lowest_probs_pqs(vector<t_lowest_probs_pq> &from_pqs, vector<t_lowest_probs_pq> &to_pqs){
+	for (int ilen = 0; ilen < (int)from_pqs.size(); ilen++){
+		while (from_pqs[ilen].size() > 0){
+			to_pqs[ilen].push( from_pqs[ilen].top() );
+			from_pqs[ilen].pop();
+		}
+	}
+}
+
+
 /* returns a node's demand, less the demand of the specified source/sink connection. if node didn't keep
    history of path counts due to this source/sink connection, or if 'fill_type' is specified as NULL, then node demand is unmodified */
 float get_node_demand_adjusted_for_path_history(int node_ind, t_rr_node &rr_node, int source_ind, int sink_ind, Physical_Type_Descriptor *fill_type,
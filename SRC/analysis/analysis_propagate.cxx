@@ -7,7 +7,7 @@ node probabilities from parent nodes to children nodes during traversal. TODO et
 
 
 	The 'propagate' method of reachability analysis builds on top of a topological traversal of the subraph. Hence
-the constituent functions are meant to be passed-in to a topological traversal function (see topological_traversal.h)
+the constituent functions make up a policy class with which the topological traversal is specialized (see topological_traversal.h)
 
 */
 
@@ -16,67 +16,198 @@ the constituent functions are meant to be passed-in to a topological traversal f
 #include "exception.h"
 #include "wotan_util.h"
 #include "globals.h"
+#include "bucket_kernels.h"
 
 using namespace std;
 
 
 
+/**** Classes ****/
+/* Topological traversal policy for the propagate method (see topological_traversal.h). The direction of traversal, the self-congestion mode
+   and the bucket type (see Propagate_Structs::float_buckets) are template parameters so that each combination gets its own traversal loop */
+template <e_traversal_dir TRAVERSAL_DIR, e_self_congestion_mode SELF_CONGESTION_MODE, typename T> class Propagate_Policy{
+public:
+	static const e_traversal_dir traversal_dir = TRAVERSAL_DIR;
+
+	Propagate_Structs *structs;
+
+	Propagate_Policy(Propagate_Structs *set_structs){
+		this->structs = set_structs;
+	}
+
+	/* Called when node is popped from expansion queue during topological traversal */
+	void node_popped(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+	                 int max_path_weight, User_Options *user_opts);
+
+	/* Called when topological traversal is iterateing over a node's children */
+	bool child_iterated(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+	                    int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts);
+
+	/* Called once topological traversal is complete */
+	void traversal_done(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+	                    int max_path_weight, User_Options *user_opts);
+};
+
+
 /**** Function Declarations ****/
-static void account_for_current_node_probability(int node_ind, int node_weight, float node_demand, t_node_topo_inf &node_topo_inf, t_rr_node &rr_node,
-                                                 e_self_congestion_mode self_congestion_mode, double demand_multiplier);
+/* runs the propagate traversal specialized for the specified bucket precision */
+template <e_traversal_dir TRAVERSAL_DIR, e_self_congestion_mode SELF_CONGESTION_MODE> static void do_propagate_traversal_with_precision(int from_node_ind,
+			int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, Nodes_Waiting_Heap &nodes_waiting,
+			int max_path_weight, User_Options *user_opts, Propagate_Structs &propagate_structs);
+/* runs the propagate traversal specialized for the specified self-congestion mode */
+template <e_traversal_dir TRAVERSAL_DIR> static void do_propagate_traversal_with_congestion_mode(int from_node_ind, int to_node_ind, t_rr_node &rr_node,
+			t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, Nodes_Waiting_Heap &nodes_waiting, int max_path_weight,
+			User_Options *user_opts, Propagate_Structs &propagate_structs);
+/* AND's the probability of the popped node being available into its source buckets (and multiplier buckets, if any) */
+template <e_self_congestion_mode SELF_CONGESTION_MODE, typename T> static void account_for_popped_node_probability(int popped_node, int from_node_ind,
+			int to_node_ind, t_rr_node &rr_node, t_node_topo_inf &node_topo_inf, User_Options *user_opts, Propagate_Structs *propagate_structs);
+/* AND's the probability of the node being available into each of the specified buckets. consecutive buckets are 'bucket_stride' apart */
+template <e_self_congestion_mode SELF_CONGESTION_MODE, typename T> static void account_for_current_node_probability(int node_ind, T *source_buckets,
+			int num_source_buckets, int bucket_stride, float node_demand, t_node_topo_inf &node_topo_inf, t_rr_node &rr_node, double demand_multiplier);
 /* propagates path probabilities stored in the bucket structure of the parent node to the bucket structure of the child node */
-static void propagate_probabilities(int parent_ind, int parent_edge_ind, int child_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-			e_traversal_dir traversal_dir, int max_path_weight, e_self_congestion_mode self_congestion_mode);
-/* probability that node with specified buckets is reachable from source */
-static float get_prob_reachable( double *source_buckets, int num_source_buckets);
+template <e_traversal_dir TRAVERSAL_DIR, e_self_congestion_mode SELF_CONGESTION_MODE, typename T> static void propagate_probabilities(int parent_ind,
+			int parent_edge_ind, int child_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int max_path_weight,
+			int num_demand_scales);
+/* computes the probability of the connection being routable (at each demand scale) from the buckets of the destination node */
+template <typename T> static void get_connection_probabilities(int to_node_ind, t_node_topo_inf &node_topo_inf, Propagate_Structs *propagate_structs);
+/* probability that node with specified buckets is reachable from source. consecutive buckets are 'bucket_stride' apart */
+template <typename T> static float get_prob_reachable( T *source_buckets, int num_source_buckets, int bucket_stride);
 
 
 
 /**** Function Definitions ****/
-/* Called when node is popped from expansion queue during topological traversal */
-void propagate_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
+/* Propagates path probabilities with a topological traversal from 'from_node_ind' towards 'to_node_ind' in the specified direction.
+   The traversal is specialized for the direction, the user's self-congestion mode and the bucket precision of 'propagate_structs' */
+void do_propagate_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+			Nodes_Waiting_Heap &nodes_waiting, e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts,
+			Propagate_Structs &propagate_structs){
 
-	Propagate_Structs *propagate_structs = (Propagate_Structs*)user_data;
+	if (traversal_dir == FORWARD_TRAVERSAL){
+		do_propagate_traversal_with_congestion_mode<FORWARD_TRAVERSAL>(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf,
+		                                                  nodes_waiting, max_path_weight, user_opts, propagate_structs);
+	} else {
+		do_propagate_traversal_with_congestion_mode<BACKWARD_TRAVERSAL>(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf,
+		                                                  nodes_waiting, max_path_weight, user_opts, propagate_structs);
+	}
+}
+
+/* runs the propagate traversal specialized for the specified self-congestion mode */
+template <e_traversal_dir TRAVERSAL_DIR> static void do_propagate_traversal_with_congestion_mode(int from_node_ind, int to_node_ind, t_rr_node &rr_node,
+			t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, Nodes_Waiting_Heap &nodes_waiting, int max_path_weight,
+			User_Options *user_opts, Propagate_Structs &propagate_structs){
+
+	switch (user_opts->self_congestion_mode){
+		case MODE_NONE:
+			do_propagate_traversal_with_precision<TRAVERSAL_DIR, MODE_NONE>(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf,
+			                                                  nodes_waiting, max_path_weight, user_opts, propagate_structs);
+			break;
+		case MODE_RADIUS:
+			do_propagate_traversal_with_precision<TRAVERSAL_DIR, MODE_RADIUS>(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf,
+			                                                  nodes_waiting, max_path_weight, user_opts, propagate_structs);
+			break;
+		case MODE_PATH_DEPENDENCE:
+			do_propagate_traversal_with_precision<TRAVERSAL_DIR, MODE_PATH_DEPENDENCE>(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf,
+			                                                  nodes_waiting, max_path_weight, user_opts, propagate_structs);
+			break;
+		default:
+			WTHROW(EX_PATH_ENUM, "Unknown self-congestion mode: " << user_opts->self_congestion_mode);
+	}
+}
+
+/* runs the propagate traversal specialized for the specified bucket precision */
+template <e_traversal_dir TRAVERSAL_DIR, e_self_congestion_mode SELF_CONGESTION_MODE> static void do_propagate_traversal_with_precision(int from_node_ind,
+			int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, Nodes_Waiting_Heap &nodes_waiting,
+			int max_path_weight, User_Options *user_opts, Propagate_Structs &propagate_structs){
+
+	if (propagate_structs.float_buckets){
+		Propagate_Policy<TRAVERSAL_DIR, SELF_CONGESTION_MODE, float> policy(&propagate_structs);
+		do_topological_traversal(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf, nodes_waiting, max_path_weight, user_opts, policy);
+	} else {
+		Propagate_Policy<TRAVERSAL_DIR, SELF_CONGESTION_MODE, double> policy(&propagate_structs);
+		do_topological_traversal(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf, nodes_waiting, max_path_weight, user_opts, policy);
+	}
+}
+
+
+/*==== Propagate_Policy Class ====*/
+/* Called when node is popped from expansion queue during topological traversal */
+template <e_traversal_dir TRAVERSAL_DIR, e_self_congestion_mode SELF_CONGESTION_MODE, typename T>
+void Propagate_Policy<TRAVERSAL_DIR, SELF_CONGESTION_MODE, T>::node_popped(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node,
+			t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int max_path_weight, User_Options *user_opts){
 
 	/* the path probabilities have been propagated from upstream nodes to this node, but
 	   the probability of *this* node has not yet been factored in. this is done now */
-	int node_weight = rr_node[popped_node].get_weight();
-	float node_demand = get_node_demand_adjusted_for_path_history(popped_node, rr_node, from_node_ind, to_node_ind, propagate_structs->fill_type, user_opts);
-	float adjusted_demand = min(1.0F, node_demand);
-
-	account_for_current_node_probability(popped_node, node_weight, adjusted_demand, node_topo_inf, rr_node, user_opts->self_congestion_mode, user_opts->demand_multiplier);
+	account_for_popped_node_probability<SELF_CONGESTION_MODE, T>(popped_node, from_node_ind, to_node_ind, rr_node, node_topo_inf, user_opts,
+	                                                             this->structs);
 }
 
 /* Called when topological traversal is iterateing over a node's children */
-bool propagate_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-                          e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data){
+template <e_traversal_dir TRAVERSAL_DIR, e_self_congestion_mode SELF_CONGESTION_MODE, typename T>
+bool Propagate_Policy<TRAVERSAL_DIR, SELF_CONGESTION_MODE, T>::child_iterated(int parent_ind, int parent_edge_ind, int node_ind,
+			t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int max_path_weight, int from_node_ind,
+			int to_node_ind, User_Options *user_opts){
 	bool ignore_node = false;
 
+	int num_demand_scales = (int)this->structs->demand_scales.size();
+
 	/* propagate the node probabilities (stores in the bucket structure) of the parent node to this node */
-	propagate_probabilities(parent_ind, parent_edge_ind, node_ind, rr_node, ss_distances, node_topo_inf, traversal_dir, max_path_weight,
-	                        user_opts->self_congestion_mode);
+	propagate_probabilities<TRAVERSAL_DIR, SELF_CONGESTION_MODE, T>(parent_ind, parent_edge_ind, node_ind, rr_node, ss_distances, node_topo_inf,
+	                                                                max_path_weight, num_demand_scales);
 
 	return ignore_node;
 }
 
 /* Called once topological traversal is complete.
    Calculates probability of a source/sink connection being routable */
-void propagate_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
-	Propagate_Structs *propagate_structs = (Propagate_Structs*)user_data;
+template <e_traversal_dir TRAVERSAL_DIR, e_self_congestion_mode SELF_CONGESTION_MODE, typename T>
+void Propagate_Policy<TRAVERSAL_DIR, SELF_CONGESTION_MODE, T>::traversal_done(int from_node_ind, int to_node_ind, t_rr_node &rr_node,
+			t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int max_path_weight, User_Options *user_opts){
+
+	get_connection_probabilities<T>(to_node_ind, node_topo_inf, this->structs);
+}
+/*==== END Propagate_Policy Class ====*/
+
 
-	double *source_buckets = node_topo_inf[to_node_ind].buckets.source_buckets;
-	int num_source_buckets = node_topo_inf[to_node_ind].buckets.get_num_source_buckets();
-	propagate_structs->prob_routable = get_prob_reachable(source_buckets, num_source_buckets);
+/* AND's the probability of the popped node being available into its source buckets (and multiplier buckets, if any) */
+template <e_self_congestion_mode SELF_CONGESTION_MODE, typename T> static void account_for_popped_node_probability(int popped_node, int from_node_ind,
+			int to_node_ind, t_rr_node &rr_node, t_node_topo_inf &node_topo_inf, User_Options *user_opts, Propagate_Structs *propagate_structs){
+	float node_demand = get_node_demand_adjusted_for_path_history(popped_node, rr_node, from_node_ind, to_node_ind, propagate_structs->fill_type, user_opts);
+	float adjusted_demand = min(1.0F, node_demand);
+
+	Node_Buckets<T> &buckets = node_topo_inf[popped_node].template get_buckets<T>();
+	int num_source_buckets = buckets.get_num_source_buckets();
+	account_for_current_node_probability<SELF_CONGESTION_MODE>(popped_node, buckets.source_buckets, num_source_buckets, 1, adjusted_demand,
+	                                                           node_topo_inf, rr_node, user_opts->demand_multiplier);
+
+	/* and the same at each of the other demand scales. node demands (and the path dependence discounts) scale linearly with the multiplier */
+	int num_demand_scales = (int)propagate_structs->demand_scales.size();
+	for (int iscale = 0; iscale < num_demand_scales; iscale++){
+		double demand_scale = propagate_structs->demand_scales[iscale];
+		float scaled_demand = min(1.0F, (float)(node_demand * demand_scale));
+
+		account_for_current_node_probability<SELF_CONGESTION_MODE>(popped_node, &buckets.multiplier_buckets[iscale], num_source_buckets, num_demand_scales,
+		                                                           scaled_demand, node_topo_inf, rr_node, user_opts->demand_multiplier * demand_scale);
+	}
+}
+
+/* computes the probability of the connection being routable (at each demand scale) from the buckets of the destination node */
+template <typename T> static void get_connection_probabilities(int to_node_ind, t_node_topo_inf &node_topo_inf, Propagate_Structs *propagate_structs){
+	Node_Buckets<T> &buckets = node_topo_inf[to_node_ind].template get_buckets<T>();
+	int num_source_buckets = buckets.get_num_source_buckets();
+	propagate_structs->prob_routable = get_prob_reachable(buckets.source_buckets, num_source_buckets, 1);
+
+	int num_demand_scales = (int)propagate_structs->demand_scales.size();
+	propagate_structs->prob_routable_at_scale.assign(num_demand_scales, 0.0);
+	for (int iscale = 0; iscale < num_demand_scales; iscale++){
+		T *scale_buckets = &buckets.multiplier_buckets[iscale];
+		propagate_structs->prob_routable_at_scale[iscale] = get_prob_reachable(scale_buckets, num_source_buckets, num_demand_scales);
+	}
 }
 
 /* Probability of a path successfully traversing through a given node is the probability that the path can reach the node AND'ed with the
-   probability that the node is uncongested */
-static void account_for_current_node_probability(int node_ind, int node_weight, float node_demand, t_node_topo_inf &node_topo_inf, t_rr_node &rr_node,
-                                                 e_self_congestion_mode self_congestion_mode, double demand_multiplier){
-	double *source_buckets = node_topo_inf[node_ind].buckets.source_buckets;
-	int num_source_buckets = node_topo_inf[node_ind].buckets.get_num_source_buckets();
+   probability that the node is uncongested. consecutive buckets are 'bucket_stride' apart */
+template <e_self_congestion_mode SELF_CONGESTION_MODE, typename T> static void account_for_current_node_probability(int node_ind, T *source_buckets,
+			int num_source_buckets, int bucket_stride, float node_demand, t_node_topo_inf &node_topo_inf, t_rr_node &rr_node, double demand_multiplier){
 
 	//Need to know:
 	//	1) The demand contributed by each parent
@@ -92,9 +223,19 @@ static void account_for_current_node_probability(int node_ind, int node_weight,
 	//			- SOLUTION: in topo inf structure, keep another "bucket" to determine demand discounts from parents
 
 	
+	/* without path dependence discounts, the same node demand applies to every bucket */
+	if (SELF_CONGESTION_MODE != MODE_PATH_DEPENDENCE && bucket_stride == 1){
+		/* constrain the node demand into the [0,1] range */
+		float adjusted_node_demand = max(0.0F, node_demand);
+		adjusted_node_demand = min(1.0F, adjusted_node_demand);
+
+		buckets_scale(source_buckets, num_source_buckets, (T)(1 - adjusted_node_demand));
+		return;
+	}
+
 	vector <bool> discount_bucket_demand;
 	float demand_discount = 0;
-	if (self_congestion_mode == MODE_PATH_DEPENDENCE){
+	if (SELF_CONGESTION_MODE == MODE_PATH_DEPENDENCE){
 		/* deal with self-congestion using CHILD_DEMAND_CONTRIBUTIONS mode */
 		discount_bucket_demand.assign(num_source_buckets, false);
 
@@ -110,102 +251,95 @@ static void account_for_current_node_probability(int node_ind, int node_weight,
 
 	for (int ibucket = 0; ibucket < num_source_buckets; ibucket++){
 		float adjusted_node_demand = node_demand;
-		if (self_congestion_mode == MODE_PATH_DEPENDENCE){
+		if (SELF_CONGESTION_MODE == MODE_PATH_DEPENDENCE){
 			if (discount_bucket_demand[ibucket] && rr_node[node_ind].get_rr_type() != OPIN){
 				adjusted_node_demand -= demand_discount;
 			}
 		}
 
-		if (source_buckets[ibucket] != UNDEFINED){
-			/* constrain the node demand into the [0,1] range */
-			adjusted_node_demand = max(0.0F, adjusted_node_demand);
-			adjusted_node_demand = min(1.0F, adjusted_node_demand);
+		T &bucket = source_buckets[ibucket * bucket_stride];
 
-			//source_buckets[ibucket] = or_two_probs(source_buckets[ibucket], min(1.0F, node_demand));	//unreachability
+		/* constrain the node demand into the [0,1] range */
+		adjusted_node_demand = max(0.0F, adjusted_node_demand);
+		adjusted_node_demand = min(1.0F, adjusted_node_demand);
 
-			//Basically AND'ing the probability that the node can be reached via a path of a given weight (ibucket) with the
-			//probability that the node in question is available
-			source_buckets[ibucket] = source_buckets[ibucket] * (1 - adjusted_node_demand);		//reachability
+		//bucket = or_two_probs(bucket, min(1.0F, node_demand));	//unreachability
 
-		}
+		//Basically AND'ing the probability that the node can be reached via a path of a given weight (ibucket) with the
+		//probability that the node in question is available
+		bucket = bucket * (1 - adjusted_node_demand);		//reachability
 	}
 }
 
 
 /* propagates path probabilities stored in the bucket structure of the parent node to the bucket structure of the child node */
-static void propagate_probabilities(int parent_ind, int parent_edge_ind, int child_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-			e_traversal_dir traversal_dir, int max_path_weight, e_self_congestion_mode self_congestion_mode){
-
-	double *parent_buckets;
-	double *child_buckets;
+template <e_traversal_dir TRAVERSAL_DIR, e_self_congestion_mode SELF_CONGESTION_MODE, typename T> static void propagate_probabilities(int parent_ind,
+			int parent_edge_ind, int child_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int max_path_weight,
+			int num_demand_scales){
+
+	Node_Buckets<T> &parent_node_buckets = node_topo_inf[parent_ind].template get_buckets<T>();
+	Node_Buckets<T> &child_node_buckets = node_topo_inf[child_ind].template get_buckets<T>();
+	T *parent_buckets;
+	T *child_buckets;
 	int num_buckets;
 	int child_weight = rr_node[child_ind].get_weight();
 	int child_path_weight_to_dest;		//the weight of the minimum-weight path from child to the destination node
-	int parent_path_weight_to_start;	//the weight of the minimum-weight path from parent to the starting node
 
 	/* get bucket structures according to direction of traversal */
-	if (traversal_dir == FORWARD_TRAVERSAL){
-		parent_buckets = node_topo_inf[parent_ind].buckets.source_buckets;
-		child_buckets = node_topo_inf[child_ind].buckets.source_buckets;
-		num_buckets = node_topo_inf[parent_ind].buckets.get_num_source_buckets();
+	if (TRAVERSAL_DIR == FORWARD_TRAVERSAL){
+		parent_buckets = parent_node_buckets.source_buckets;
+		child_buckets = child_node_buckets.source_buckets;
+		num_buckets = parent_node_buckets.get_num_source_buckets();
 
 		/* path weight to sink (includes weight of child node) */
 		child_path_weight_to_dest = ss_distances[child_ind].get_sink_distance();
-		
-		parent_path_weight_to_start = ss_distances[parent_ind].get_source_distance();
 	} else {
-		parent_buckets = node_topo_inf[parent_ind].buckets.sink_buckets;
-		child_buckets = node_topo_inf[child_ind].buckets.sink_buckets;
-		num_buckets = node_topo_inf[parent_ind].buckets.get_num_sink_buckets();
+		parent_buckets = parent_node_buckets.sink_buckets;
+		child_buckets = child_node_buckets.sink_buckets;
+		num_buckets = parent_node_buckets.get_num_sink_buckets();
 
 		/* path weight to source (includes weight of child node) */
 		child_path_weight_to_dest = ss_distances[child_ind].get_source_distance();
-
-		parent_path_weight_to_start = ss_distances[parent_ind].get_sink_distance();
 	}
 
 	/* now propagate path probabilities. the assumption is that every single path is independent (perhaps not a very good assumption)
 	   TODO. add better description */
-	//for (int ibucket = parent_path_weight_to_start; ibucket < num_buckets; ibucket++){	//parent cannot carry paths of weight smaller than itself
-	for (int ibucket = 0; ibucket < num_buckets; ibucket++){	//XXX but weight has possibly changed due to dynamic weights.......
-		/* we're done if this set of paths cannot possibly reach the target node 
-		   in under the minimum allowable path weight */
-		if (ibucket + child_path_weight_to_dest > max_path_weight){
-			break;
-		}
+	//parent cannot carry paths of weight smaller than itself (its minimum path weight to the starting node)... XXX but weight has possibly changed due to dynamic weights.......
+	/* probabilities are propagated from buckets [0, end_bucket). we're done at the first bucket whose paths cannot possibly reach
+	   the target node in under the minimum allowable path weight. node weights can also change during a connection; paths that
+	   no longer fit into the child's buckets are dropped */
+	int end_bucket = min(max_path_weight - child_path_weight_to_dest + 1, num_buckets - child_weight);
+	if (end_bucket <= 0){
+		return;
+	}
 
-		/* bucket into which to propagate probabilities */
-		int target_bucket = ibucket + child_weight;
+	/* propagate routing probability of paths. child bucket (ibucket + child_weight) gets the paths of parent bucket ibucket */
+	buckets_or(&child_buckets[child_weight], parent_buckets, end_bucket);
 
-		/* propagate routing probability of paths */
-		if (child_buckets[target_bucket] == UNDEFINED){
-			if (parent_buckets[ibucket] != UNDEFINED){
-				child_buckets[target_bucket] = parent_buckets[ibucket];
-			}
-		} else {
-			if (parent_buckets[ibucket] != UNDEFINED){
-				//child_buckets[target_bucket] *= parent_buckets[ibucket];	//unreachability
-				child_buckets[target_bucket] = or_two_probs(child_buckets[target_bucket], parent_buckets[ibucket]);	//reachability
-			}
-		}
+	/* and the routing probabilities at the other demand scales (only kept for paths from the source). each bucket holds a
+	   contiguous row of 'num_demand_scales' probabilities, so the rows are shifted the same way */
+	if (num_demand_scales > 0 && TRAVERSAL_DIR == FORWARD_TRAVERSAL){
+		buckets_or(&child_node_buckets.multiplier_buckets[child_weight * num_demand_scales], parent_node_buckets.multiplier_buckets,
+		           end_bucket * num_demand_scales);
+	}
 
-		if (self_congestion_mode == MODE_PATH_DEPENDENCE){
-			if (traversal_dir == FORWARD_TRAVERSAL){
-				node_topo_inf[child_ind].demand_discounts[target_bucket] += rr_node[parent_ind].child_demand_contributions[parent_edge_ind][ibucket];
+	if (SELF_CONGESTION_MODE == MODE_PATH_DEPENDENCE){
+		if (TRAVERSAL_DIR == FORWARD_TRAVERSAL){
+			for (int ibucket = 0; ibucket < end_bucket; ibucket++){
+				node_topo_inf[child_ind].demand_discounts[ibucket + child_weight] += rr_node[parent_ind].cold->child_demand_contributions[parent_edge_ind][ibucket];
 			}
 		}
 	}
 }
 
-/* probability that node with specified buckets is reachable from source */
-static float get_prob_reachable( double *source_buckets, int num_source_buckets){
+/* probability that node with specified buckets is reachable from source. consecutive buckets are 'bucket_stride' apart */
+template <typename T> static float get_prob_reachable( T *source_buckets, int num_source_buckets, int bucket_stride){
 	
+	/* OR'ed in bucket order. empty buckets (0) leave the total unchanged */
 	float running_total = 0;
 	for (int ibucket = 0; ibucket < num_source_buckets; ibucket++){
-		float bucket_value = source_buckets[ibucket];
-		if (bucket_value != UNDEFINED){
-			running_total = or_two_probs(running_total, bucket_value);
-		}
+		float bucket_value = source_buckets[ibucket * bucket_stride];
+		running_total = or_two_probs(running_total, bucket_value);
 	}
 
 	return running_total;
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include "wotan_types.h"
+#include "topological_traversal.h"
 
 
 /**** Typedefs ****/
@@ -14,21 +15,24 @@ class Propagate_Structs{
 public:
 	float prob_routable;
 	Physical_Type_Descriptor *fill_type;
-};
 
+	/* if not empty, probabilities are also propagated through Node_Buckets::multiplier_buckets with node demands
+	   scaled by each of these factors. the resulting probabilities are placed into 'prob_routable_at_scale' */
+	std::vector<double> demand_scales;
+	std::vector<float> prob_routable_at_scale;
 
-/**** Function Declarations ****/
-/* Called when node is popped from expansion queue during topological traversal */
-void propagate_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
+	/* whether probabilities are kept in the single-precision Node_Topological_Info::float_buckets rather than in the
+	   double-precision Node_Topological_Info::buckets */
+	bool float_buckets;
+};
 
-/* Called when topological traversal is iterateing over a node's children */
-bool propagate_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-                          e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data);
 
-/* Called once topological traversal is complete */
-void propagate_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
+/**** Function Declarations ****/
+/* Propagates path probabilities with a topological traversal from 'from_node_ind' towards 'to_node_ind' in the specified direction.
+   The traversal is specialized for the direction, the user's self-congestion mode and the bucket precision of 'propagate_structs' */
+void do_propagate_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+			Nodes_Waiting_Heap &nodes_waiting, e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts,
+			Propagate_Structs &propagate_structs);
 
 
 #endif
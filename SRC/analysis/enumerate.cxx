@@ -3,7 +3,7 @@
 maximum bound on their path weight.
 
 	Path enumeration through a subgraph builds on top of a topological traversal function. Hence
-the constituent functions are meant to be passed-in to a topological traversal function (see topological_traversal.h)
+the constituent functions make up a policy class with which the topological traversal is specialized (see topological_traversal.h)
 
 */
 
@@ -12,6 +12,7 @@ the constituent functions are meant to be passed-in to a topological traversal f
 #include "exception.h"
 #include "wotan_util.h"
 #include "globals.h"
+#include "bucket_kernels.h"
 
 #include "draw.h"
 #include "analysis_main.h"
@@ -20,19 +21,113 @@ the constituent functions are meant to be passed-in to a topological traversal f
 using namespace std;
 
 
+/**** Classes ****/
+/* Topological traversal policy for path enumeration (see topological_traversal.h). The direction of traversal, the self-congestion mode
+   and the bucket mode are template parameters so that each combination gets its own traversal loop */
+template <e_traversal_dir TRAVERSAL_DIR, e_self_congestion_mode SELF_CONGESTION_MODE, e_bucket_mode BUCKET_MODE> class Enumerate_Policy{
+public:
+	static const e_traversal_dir traversal_dir = TRAVERSAL_DIR;
+
+	Enumerate_Structs *structs;
+
+	Enumerate_Policy(Enumerate_Structs *set_structs){
+		this->structs = set_structs;
+	}
+
+	/* Called when node is popped from expansion queue during topological traversal */
+	void node_popped(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+	                 int max_path_weight, User_Options *user_opts);
+
+	/* Called when topological traversal is iterateing over a node's children */
+	bool child_iterated(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+	                    int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts);
+
+	/* Called once topological traversal is complete */
+	void traversal_done(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+	                    int max_path_weight, User_Options *user_opts);
+};
+
+
 /**** Function Declarations ****/
+/* runs the path enumeration traversal specialized for the specified bucket mode */
+template <e_traversal_dir TRAVERSAL_DIR, e_self_congestion_mode SELF_CONGESTION_MODE> static void do_enumerate_traversal_with_bucket_mode(int from_node_ind,
+			int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, Nodes_Waiting_Heap &nodes_waiting,
+			int max_path_weight, User_Options *user_opts, Enumerate_Structs &enumerate_structs);
+/* runs the path enumeration traversal specialized for the specified self-congestion mode */
+template <e_traversal_dir TRAVERSAL_DIR> static void do_enumerate_traversal_with_congestion_mode(int from_node_ind, int to_node_ind, t_rr_node &rr_node,
+			t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, Nodes_Waiting_Heap &nodes_waiting, int max_path_weight,
+			User_Options *user_opts, Enumerate_Structs &enumerate_structs);
 /* propagates path counts stored in the bucket structure of the parent node to the bucket structure of the child node */
-static void propagate_path_counts(int parent_ind, int parent_edge_ind, int child_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-			e_traversal_dir traversal_dir, int max_path_weight, e_bucket_mode enumerate_mode, e_self_congestion_mode self_congestion_mode);
+template <e_traversal_dir TRAVERSAL_DIR, e_self_congestion_mode SELF_CONGESTION_MODE, e_bucket_mode BUCKET_MODE> static void propagate_path_counts(int parent_ind,
+			int parent_edge_ind, int child_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int max_path_weight);
 
 
 /**** Function Definitions ****/
+/* Enumerates paths with a topological traversal from 'from_node_ind' towards 'to_node_ind' in the specified direction.
+   The traversal is specialized for the direction, the user's self-congestion mode and the bucket mode of 'enumerate_structs' */
+void do_enumerate_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+			Nodes_Waiting_Heap &nodes_waiting, e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts,
+			Enumerate_Structs &enumerate_structs){
+
+	if (traversal_dir == FORWARD_TRAVERSAL){
+		do_enumerate_traversal_with_congestion_mode<FORWARD_TRAVERSAL>(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf,
+		                                                  nodes_waiting, max_path_weight, user_opts, enumerate_structs);
+	} else {
+		do_enumerate_traversal_with_congestion_mode<BACKWARD_TRAVERSAL>(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf,
+		                                                  nodes_waiting, max_path_weight, user_opts, enumerate_structs);
+	}
+}
+
+/* runs the path enumeration traversal specialized for the specified self-congestion mode */
+template <e_traversal_dir TRAVERSAL_DIR> static void do_enumerate_traversal_with_congestion_mode(int from_node_ind, int to_node_ind, t_rr_node &rr_node,
+			t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, Nodes_Waiting_Heap &nodes_waiting, int max_path_weight,
+			User_Options *user_opts, Enumerate_Structs &enumerate_structs){
+
+	switch (user_opts->self_congestion_mode){
+		case MODE_NONE:
+			do_enumerate_traversal_with_bucket_mode<TRAVERSAL_DIR, MODE_NONE>(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf,
+			                                                  nodes_waiting, max_path_weight, user_opts, enumerate_structs);
+			break;
+		case MODE_RADIUS:
+			do_enumerate_traversal_with_bucket_mode<TRAVERSAL_DIR, MODE_RADIUS>(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf,
+			                                                  nodes_waiting, max_path_weight, user_opts, enumerate_structs);
+			break;
+		case MODE_PATH_DEPENDENCE:
+			do_enumerate_traversal_with_bucket_mode<TRAVERSAL_DIR, MODE_PATH_DEPENDENCE>(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf,
+			                                                  nodes_waiting, max_path_weight, user_opts, enumerate_structs);
+			break;
+		default:
+			WTHROW(EX_PATH_ENUM, "Unknown self-congestion mode: " << user_opts->self_congestion_mode);
+	}
+}
+
+/* runs the path enumeration traversal specialized for the specified bucket mode */
+template <e_traversal_dir TRAVERSAL_DIR, e_self_congestion_mode SELF_CONGESTION_MODE> static void do_enumerate_traversal_with_bucket_mode(int from_node_ind,
+			int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, Nodes_Waiting_Heap &nodes_waiting,
+			int max_path_weight, User_Options *user_opts, Enumerate_Structs &enumerate_structs){
+
+	if (enumerate_structs.mode == BY_PATH_WEIGHT){
+		Enumerate_Policy<TRAVERSAL_DIR, SELF_CONGESTION_MODE, BY_PATH_WEIGHT> policy(&enumerate_structs);
+		do_topological_traversal(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf, nodes_waiting, max_path_weight, user_opts, policy);
+	} else if (enumerate_structs.mode == BY_PATH_HOPS){
+		Enumerate_Policy<TRAVERSAL_DIR, SELF_CONGESTION_MODE, BY_PATH_HOPS> policy(&enumerate_structs);
+		do_topological_traversal(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf, nodes_waiting, max_path_weight, user_opts, policy);
+	} else {
+		WTHROW(EX_PATH_ENUM, "Unknown enumeration mode: " << enumerate_structs.mode);
+	}
+}
+
+
+/*==== Enumerate_Policy Class ====*/
 /* Called when node is popped from expansion queue during topological traversal */
-void enumerate_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
+template <e_traversal_dir TRAVERSAL_DIR, e_self_congestion_mode SELF_CONGESTION_MODE, e_bucket_mode BUCKET_MODE>
+void Enumerate_Policy<TRAVERSAL_DIR, SELF_CONGESTION_MODE, BUCKET_MODE>::node_popped(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node,
+			t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int max_path_weight, User_Options *user_opts){
+
+	Enumerate_Structs *enumerate_structs = this->structs;
 
 	/* increment node demand during forward traversal only */
-	if (traversal_dir == FORWARD_TRAVERSAL){
+	if (TRAVERSAL_DIR == FORWARD_TRAVERSAL){
 		/* Increment demand of nodes based on paths enumerated through them */
 		e_rr_type node_type = rr_node[popped_node].get_rr_type();
 
@@ -48,28 +143,28 @@ void enumerate_node_popped_func(int popped_node, int from_node_ind, int to_node_
 			//if (node_type != OPIN /*&& node_type != IPIN*/){
 			//	demand_contribution *= user_opts->demand_multiplier;
 			//}
-			rr_node[popped_node].increment_demand( demand_contribution, user_opts->demand_multiplier);
+			if (enumerate_structs->demand_increments != NULL){
+				/* demand will be added to the node by the caller */
+				enumerate_structs->demand_increments->push_back( Node_Demand_Increment(popped_node, demand_contribution) );
+			} else {
+				rr_node[popped_node].increment_demand( demand_contribution, user_opts->demand_multiplier);
+			}
 
 			/* It is possible to keep a history of how many paths there are connecting each source/sink with the
 			   nearby nodes. This path count history can be used to later subtract the demand due to a source/sink pair
 			   (from nodes being traversed) when analyzing *that specific* source sink pair. Here we make a record
 			   of this node's demand that is due to this source/sink pair */
-			if (user_opts->self_congestion_mode == MODE_RADIUS){
+			if (SELF_CONGESTION_MODE == MODE_RADIUS){
 				e_rr_type type = rr_node[popped_node].get_rr_type();
 				if (type == OPIN || type == IPIN || type == CHANX || type == CHANY){
 					rr_node[popped_node].increment_path_count_history(demand_contribution, rr_node[from_node_ind]);
 					rr_node[popped_node].increment_path_count_history(demand_contribution, rr_node[to_node_ind]);
 				}
 			}
-
-			//pthread_mutex_lock(&g_mutex);
-			//g_enum_nodes_popped++;
-			//pthread_mutex_unlock(&g_mutex);
 		}
 
 		/* add to existing count of the number of routing nodes (CHANX/CHANY/IPIN/OPIN) in the legal subgraph
 		   (this is used for reliability polynomial computations) */
-		Enumerate_Structs *enumerate_structs = (Enumerate_Structs *)user_data;
 		int popped_node_weight = rr_node[popped_node].get_weight();
 		if ( ss_distances[popped_node].is_legal(popped_node_weight, max_path_weight) ){
 			if (node_type == CHANX || node_type == CHANY || node_type == IPIN || node_type == OPIN){
@@ -80,19 +175,19 @@ void enumerate_node_popped_func(int popped_node, int from_node_ind, int to_node_
 }
 
 /* Called when topological traversal is iterateing over a node's children */
-bool enumerate_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-                          e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data){
+template <e_traversal_dir TRAVERSAL_DIR, e_self_congestion_mode SELF_CONGESTION_MODE, e_bucket_mode BUCKET_MODE>
+bool Enumerate_Policy<TRAVERSAL_DIR, SELF_CONGESTION_MODE, BUCKET_MODE>::child_iterated(int parent_ind, int parent_edge_ind, int node_ind,
+			t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int max_path_weight, int from_node_ind,
+			int to_node_ind, User_Options *user_opts){
 	bool ignore_node = false;
 
-	Enumerate_Structs *enumerate_structs = (Enumerate_Structs *)user_data;
-
 	/* propagate the path counts (stored in the bucket structure) of the parent node to this node */
 	//if (enumerate_structs->mode == BY_PATH_HOPS){
 	//	cout << "from: " << from_node_ind << "  to: " << to_node_ind << endl;
 	//	cout << "child: " << node_ind << "  parent: " << parent_ind << endl;
 	//}
-	propagate_path_counts(parent_ind, parent_edge_ind, node_ind, rr_node, ss_distances, node_topo_inf, traversal_dir, max_path_weight, enumerate_structs->mode,
-	                      user_opts->self_congestion_mode);
+	propagate_path_counts<TRAVERSAL_DIR, SELF_CONGESTION_MODE, BUCKET_MODE>(parent_ind, parent_edge_ind, node_ind, rr_node, ss_distances, node_topo_inf,
+	                                                                       max_path_weight);
 
 	//if (from_node_ind == 5784 && to_node_ind == 6950){
 	//	cout << parent_ind << " to " << node_ind << endl;
@@ -102,20 +197,18 @@ bool enumerate_child_iterated_func(int parent_ind, int parent_edge_ind, int node
 }
 
 /* Called once topological traversal is complete. */
-void enumerate_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
+template <e_traversal_dir TRAVERSAL_DIR, e_self_congestion_mode SELF_CONGESTION_MODE, e_bucket_mode BUCKET_MODE>
+void Enumerate_Policy<TRAVERSAL_DIR, SELF_CONGESTION_MODE, BUCKET_MODE>::traversal_done(int from_node_ind, int to_node_ind, t_rr_node &rr_node,
+			t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int max_path_weight, User_Options *user_opts){
 	
 	/* nothing to be done */
 }
+/*==== END Enumerate_Policy Class ====*/
 
 
 /* propagates path counts stored in the bucket structure of the parent node to the bucket structure of the child node */
-static void propagate_path_counts(int parent_ind, int parent_edge_ind, int child_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-			e_traversal_dir traversal_dir, int max_path_weight, e_bucket_mode enumerate_mode, e_self_congestion_mode self_congestion_mode){
-
-	if (enumerate_mode != BY_PATH_WEIGHT && enumerate_mode != BY_PATH_HOPS){
-		WTHROW(EX_PATH_ENUM, "Unknown enumeration mode: " << enumerate_mode);
-	}
+template <e_traversal_dir TRAVERSAL_DIR, e_self_congestion_mode SELF_CONGESTION_MODE, e_bucket_mode BUCKET_MODE> static void propagate_path_counts(int parent_ind,
+			int parent_edge_ind, int child_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int max_path_weight){
 
 	double *parent_buckets;
 	double *child_buckets;
@@ -125,19 +218,19 @@ static void propagate_path_counts(int parent_ind, int parent_edge_ind, int child
 
 	int max_dist = max_path_weight;
 	int child_weight = rr_node[child_ind].get_weight();
-	if (enumerate_mode == BY_PATH_HOPS){
+	if (BUCKET_MODE == BY_PATH_HOPS){
 		child_weight = 1;
 		max_dist += 3;
 	}
 	
 
 	/* get bucket structures according to direction of traversal */
-	if (traversal_dir == FORWARD_TRAVERSAL){
+	if (TRAVERSAL_DIR == FORWARD_TRAVERSAL){
 		parent_buckets = node_topo_inf[parent_ind].buckets.source_buckets;
 		child_buckets = node_topo_inf[child_ind].buckets.source_buckets;
 		num_buckets = node_topo_inf[parent_ind].buckets.get_num_source_buckets();
 
-		if (enumerate_mode == BY_PATH_WEIGHT){
+		if (BUCKET_MODE == BY_PATH_WEIGHT){
 			/* path weight to a node already includes the weight of that node */
 			child_dist_to_target = ss_distances[child_ind].get_sink_distance();
 			parent_dist_to_start = ss_distances[parent_ind].get_source_distance();
@@ -152,7 +245,7 @@ static void propagate_path_counts(int parent_ind, int parent_edge_ind, int child
 		child_buckets = node_topo_inf[child_ind].buckets.sink_buckets;
 		num_buckets = node_topo_inf[parent_ind].buckets.get_num_sink_buckets();
 
-		if (enumerate_mode == BY_PATH_WEIGHT){
+		if (BUCKET_MODE == BY_PATH_WEIGHT){
 			/* path weight to a node already includes the weight of that node */
 			child_dist_to_target = ss_distances[child_ind].get_source_distance();
 			parent_dist_to_start = ss_distances[parent_ind].get_sink_distance();
@@ -166,36 +259,26 @@ static void propagate_path_counts(int parent_ind, int parent_edge_ind, int child
 		WTHROW(EX_PATH_ENUM, "Parent node has distance to start node of < 0: " << parent_dist_to_start);
 	}
 
-	/* now propagate parent path counts to the child */
-	for (int ibucket = parent_dist_to_start; ibucket < num_buckets; ibucket++){
-
-		/* we're done if this set of paths cannot possibly reach the target node 
-		   in under the minimum allowable path weight */
-		if (ibucket + child_dist_to_target > max_dist){
-			break;
-		}
-
-		/* parent has no paths in this bucket -- nothing to propagate */
-		if (parent_buckets[ibucket] == UNDEFINED){
-			continue;
-		}
+	/* parent path counts are propagated from buckets [parent_dist_to_start, end_bucket). we're done at the first bucket whose
+	   paths cannot possibly reach the target node in under the minimum allowable path weight. node weights can also change
+	   during a connection; paths that no longer fit into the child's buckets are dropped */
+	int end_bucket = min(max_dist - child_dist_to_target + 1, num_buckets - child_weight);
+	if (end_bucket <= parent_dist_to_start){
+		return;
+	}
 
-		/* bucket into which to propagate probabilities */
-		int target_bucket = ibucket + child_weight;
+	/* propagate the parent path counts to child. child bucket (ibucket + child_weight) gets the paths of parent bucket ibucket */
+	buckets_add(&child_buckets[parent_dist_to_start + child_weight], &parent_buckets[parent_dist_to_start], end_bucket - parent_dist_to_start);
 
-		/* propagate the parent path counts to child */
-		if (child_buckets[target_bucket] == UNDEFINED){
-			child_buckets[target_bucket] = parent_buckets[ibucket];
-		} else {
-			child_buckets[target_bucket] += parent_buckets[ibucket];
-		}
-
-		if (self_congestion_mode == MODE_PATH_DEPENDENCE){
-			if (traversal_dir == FORWARD_TRAVERSAL){
-				//keep incremental track of the demands contributed to children (for each possible path weight)
-				pthread_mutex_lock(&rr_node[parent_ind].my_mutex);
-				rr_node[parent_ind].child_demand_contributions[parent_edge_ind][ibucket] += parent_buckets[ibucket];
-				pthread_mutex_unlock(&rr_node[parent_ind].my_mutex);
+	if (SELF_CONGESTION_MODE == MODE_PATH_DEPENDENCE){
+		if (TRAVERSAL_DIR == FORWARD_TRAVERSAL){
+			//keep incremental track of the demands contributed to children (for each possible path weight)
+			for (int ibucket = parent_dist_to_start; ibucket < end_bucket; ibucket++){
+				/* parent has no paths in this bucket -- nothing to contribute */
+				if (parent_buckets[ibucket] == 0){
+					continue;
+				}
+				atomic_add(rr_node[parent_ind].cold->child_demand_contributions[parent_edge_ind][ibucket], (float)parent_buckets[ibucket]);
 			}
 		}
 	}
@@ -1,10 +1,27 @@
 #ifndef ENUMERATE_H
 #define ENUMERATE_H
 
+#include <vector>
 #include "wotan_types.h"
+#include "topological_traversal.h"
 
 
 /**** Classes ****/
+/* demand enumerated through a node for some connection. used to defer adding demands to nodes when enumerating in rounds */
+class Node_Demand_Increment{
+public:
+	int node_ind;
+	float demand;
+
+	Node_Demand_Increment(int set_node_ind, float set_demand){
+		this->node_ind = set_node_ind;
+		this->demand = set_demand;
+	}
+};
+
+/* list of demand increments, in the order in which nodes were popped during enumeration */
+typedef std::vector< Node_Demand_Increment > t_demand_increments;
+
 class Enumerate_Structs{
 public:
 	/* will be used to return the number of legal nodes encountered during 
@@ -12,24 +29,23 @@ public:
 	int num_routing_nodes_in_subgraph;
 	e_bucket_mode mode;
 
+	/* if not NULL, node demands are recorded here instead of being added to the nodes right away
+	   (node weights then stay fixed during enumeration) */
+	t_demand_increments *demand_increments;
+
 	Enumerate_Structs(){
 		this->num_routing_nodes_in_subgraph = 0;
+		this->demand_increments = NULL;
 	}
 };
 
 
 /**** Function Declarations ****/
-/* Called when node is popped from expansion queue during topological traversal */
-void enumerate_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
-
-/* Called when topological traversal is iterateing over a node's children */
-bool enumerate_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-                          e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data);
-
-/* Called once topological traversal is complete */
-void enumerate_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
+/* Enumerates paths with a topological traversal from 'from_node_ind' towards 'to_node_ind' in the specified direction.
+   The traversal is specialized for the direction, the user's self-congestion mode and the bucket mode of 'enumerate_structs' */
+void do_enumerate_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+			Nodes_Waiting_Heap &nodes_waiting, e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts,
+			Enumerate_Structs &enumerate_structs);
 
 
 #endif
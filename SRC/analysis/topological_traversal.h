@@ -1,39 +1,268 @@
 #ifndef TOPOLOGICAL_TRAVERSAL_H
 #define TOPOLOGICAL_TRAVERSAL_H
 
-
+#include <queue>
 #include "wotan_types.h"
+#include "exception.h"
+
+/**** Classes ****/
+/* An indexed min-heap of Node_Waiting objects, ordered by Node_Waiting::operator<. Used to break cycles during topological traversal:
+   nodes that have been visited but still have unmet dependencies wait on this heap, and if the traditional expansion queue
+   becomes empty, the node at the top of the heap is expanded next.
+   The heap records the position of each node on it, so that a node whose dependencies become met can be erased by node index.
+   Storage is kept between traversals, so a heap that is reused for many traversals stops allocating once it has seen the largest one */
+class Nodes_Waiting_Heap{
+private:
+	std::vector<Node_Waiting> heap;		/* binary heap. the lowest object (per Node_Waiting::operator<) is at index 0 */
+	std::vector<int> heap_inds;		/* position of each node on the heap, UNDEFINED if the node isn't on the heap. indexed by node */
+	Nodes_Waiting_Heap *nested_heap;	/* heap for a traversal nested inside the one using this heap (recursive traversals).
+						   allocated on first use and kept, so there is one reusable heap per recursion depth */
+
+	/* places 'node_waiting' at the specified heap position and records that position */
+	void place(int heap_ind, const Node_Waiting &node_waiting);
+	/* moves the object at the specified position up/down the heap until heap order is restored */
+	void sift_up(int heap_ind);
+	void sift_down(int heap_ind);
+public:
+	Nodes_Waiting_Heap();
+	/* copies the waiting nodes. the nested heap is scratch space and is not copied */
+	Nodes_Waiting_Heap(const Nodes_Waiting_Heap &obj);
+	Nodes_Waiting_Heap& operator=(const Nodes_Waiting_Heap &obj);
+	~Nodes_Waiting_Heap();
+
+	/* pushes 'node_waiting' onto the heap. if its node is already on the heap, the node's entry is updated instead */
+	void push(const Node_Waiting &node_waiting);
+	/* returns the lowest object on the heap */
+	const Node_Waiting& top() const;
+	/* removes the lowest object from the heap */
+	void pop();
+	/* removes the specified node from the heap. does nothing if the node is not on the heap */
+	void erase(int node_ind);
+
+	bool empty() const;
 
-/**** Typedefs ****/
-/* function type that is executed when node is popped from expansion queue during topological traversal */
-typedef void(*t_usr_node_popped_func)(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
-/* function type that is executed when topological traversal is complete */
-typedef void(*t_usr_traversal_done_func)(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
-                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
-/* function type that is executed while iterating over a node's children (execution not guaranteed) */
-typedef bool(*t_usr_child_iterated_func)(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-                          e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data);
+	/* returns the heap to be used by a traversal that is nested inside the traversal using this heap */
+	Nodes_Waiting_Heap& get_nested_heap();
+};
 
 
 /**** Function Declarations ****/
 
 /* 
-   Function for doing topological traversal.
+   Function for doing topological traversal. The traversal is specialized at compile time for the passed-in 'Policy' class,
+   so that the policy's functions can be inlined into the traversal loops. The policy class supplies:
 
-   usr_exec_node_popped: function to be executed when a new node is popped off the expansion queue during topological traversal
-   usr_exec_child_iterated: to be executed while iterating over a node's children (execution not guaranteed -- based on child legality)
-                            can return 'false' to specify that corresponding child should be ignored
-   usr_exec_traversal_done: executed after entire topological traversal is complete
+   Policy::traversal_dir: (static const e_traversal_dir) the direction of traversal
+   node_popped(popped_node, from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf, max_path_weight, user_opts):
+                            executed when a new node is popped off the expansion queue during topological traversal
+   child_iterated(parent_ind, parent_edge_ind, node_ind, rr_node, ss_distances, node_topo_inf, max_path_weight, from_node_ind, to_node_ind, user_opts):
+                            executed while iterating over a node's children (execution not guaranteed -- based on child legality).
+                            returns 'true' to specify that corresponding child should be ignored
+   traversal_done(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf, max_path_weight, user_opts):
+                            executed after entire topological traversal is complete
 
-   All passed-in function pointers can be NULL
+   nodes_waiting: heap used to break cycles. must be empty, and must not be used by any traversal that encloses this one
+                  (as is the case for recursive traversals)
 */
-void do_topological_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-			e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data,
-			t_usr_node_popped_func usr_exec_node_popped,
-			t_usr_child_iterated_func usr_exec_child_iterated,
-			t_usr_traversal_done_func usr_exec_traversal_done);
+template <class Policy> void do_topological_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+			t_node_topo_inf &node_topo_inf, Nodes_Waiting_Heap &nodes_waiting, int max_path_weight, User_Options *user_opts, Policy &policy);
+
+/* Used during topological traversal. Selectively puts the nodes specified in edge_list onto queue.
+   Manages the sorted nodes_waiting structure which is used to deal with cycles during topological traversal.
+   policy.child_iterated is executed after it is verified that a given child is legal */
+template <class Policy> void put_children_on_queue_and_update_structs(int *edge_list, int num_nodes, int parent_ind, t_rr_node &rr_node,
+			t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, std::queue<int> &Q, Nodes_Waiting_Heap &nodes_waiting,
+			int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, Policy &policy);
+
+/* puts specified child node onto the sorted 'nodes_waiting' structure. this structure is sorted by a path weight 
+   (which will be determined in this function), and the child's node index serving as a tie breaker */
+void put_child_onto_nodes_waiting_structure(int child_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, 
+			t_node_topo_inf &node_topo_inf, e_traversal_dir traversal_dir, Nodes_Waiting_Heap &nodes_waiting);
+
+
+/**** Function Definitions ****/
+/* the traversal templates are defined here rather than in topological_traversal.cxx so that each analysis method
+   can instantiate them with its own policy (and have the policy's functions inlined) */
+
+/* Function for doing topological traversal. see declaration above */
+template <class Policy> void do_topological_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+			t_node_topo_inf &node_topo_inf, Nodes_Waiting_Heap &nodes_waiting, int max_path_weight, User_Options *user_opts, Policy &policy){
+
+	/* a queue for traversing the graph */
+	std::queue<int> Q;
+	
+	/* 'nodes_waiting' holds nodes which have unmet dependencies, sorted; used to break cycles */
+	if (!nodes_waiting.empty()){
+		WTHROW(EX_PATH_ENUM, "Expected cycle-breaking heap to be empty at the start of a topological traversal");
+	}
+
+	//Commenting because this check doesn't fly when we do recursive traversals
+	///* check that starting node is a source node */
+	//e_rr_type from_type = rr_node[from_node_ind].get_rr_type();
+	//if ( from_type != SOURCE && from_type != SINK ){
+	//	WTHROW(EX_PATH_ENUM, "Expected starting node to be of SOURCE or SINK type");
+	//}
+
+	/* put starting node onto queue */
+	Q.push( from_node_ind );
+
+	/* mark 'from' node as visited */
+	node_topo_inf[from_node_ind].set_was_visited(true);
+	if (Policy::traversal_dir == FORWARD_TRAVERSAL){
+		node_topo_inf[from_node_ind].increment_times_visited_from_source();
+		node_topo_inf[from_node_ind].set_done_from_source(true);
+	} else {
+		node_topo_inf[from_node_ind].increment_times_visited_from_sink();
+		node_topo_inf[from_node_ind].set_done_from_sink(true);
+	}
+
+	/* now use queue to traverse the graph */
+	while ( !Q.empty() ){
+		int node_ind;
+		int *edge_list;
+		int num_edges;
+
+		node_ind = Q.front();
+		Q.pop();
+
+		/* get edges along which to expand */
+		if (Policy::traversal_dir == FORWARD_TRAVERSAL){
+			edge_list = rr_node[node_ind].out_edges;
+			num_edges = rr_node[node_ind].get_num_out_edges();
+
+		} else {
+			edge_list = rr_node[node_ind].in_edges;
+			num_edges = rr_node[node_ind].get_num_in_edges();
+		}
+
+		/* EXECUTE USER-DEFINED FUNCTION */
+		policy.node_popped(node_ind, from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf, max_path_weight, user_opts);
+
+		/* put children onto queue or nodes_waiting structure */
+		put_children_on_queue_and_update_structs(edge_list, num_edges, node_ind, rr_node, ss_distances, node_topo_inf,
+						Q, nodes_waiting, max_path_weight, from_node_ind, to_node_ind, user_opts, policy);
+
+
+		if (Q.empty() && !nodes_waiting.empty()){
+			/* encountered a cycle somewhere. get first node from the sorted nodes_waiting structure and continue expanding
+			   on that */
+			if (nodes_waiting.empty()){
+				WTHROW(EX_PATH_ENUM, "Nodes waiting queue empty!");
+			}
+
+			Node_Waiting node_waiting = nodes_waiting.top();
+			nodes_waiting.pop();
+
+			int next_node_ind = node_waiting.get_node_ind();
+			Q.push(next_node_ind);
+
+			if (Policy::traversal_dir == FORWARD_TRAVERSAL){
+				node_topo_inf[next_node_ind].set_done_from_source(true);
+			} else {
+				node_topo_inf[next_node_ind].set_done_from_sink(true);
+			}
+		}
+	}
+
+	/* EXECUTE USER-DEFINED FUNCTION */
+	policy.traversal_done(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf, max_path_weight, user_opts);
+}
+
+
+/* Used during topological traversal. Selectively puts the nodes specified in edge_list onto queue.
+   Manages the sorted nodes_waiting structure which is used to deal with cycles during topological traversal.
+   policy.child_iterated is executed after it is verified that a given child is legal */
+template <class Policy> void put_children_on_queue_and_update_structs(int *edge_list, int num_nodes, int parent_ind, t_rr_node &rr_node,
+			t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, std::queue<int> &Q, Nodes_Waiting_Heap &nodes_waiting,
+			int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, Policy &policy){
+
+
+	for (int inode = 0; inode < num_nodes; inode++){
+		int node_ind = edge_list[inode];
+		
+		/* skip nodes which have already been inserted onto the queue */
+		if (Policy::traversal_dir == FORWARD_TRAVERSAL){
+			if (node_topo_inf[node_ind].get_done_from_source()){
+				continue;
+			}
+		} else {
+			if (node_topo_inf[node_ind].get_done_from_sink()){
+				continue;
+			}
+		}
+
+		/* skip nodes which cannot carry a legal path from source to sink */
+		if ( !ss_distances[node_ind].is_legal(rr_node[node_ind].get_weight(), max_path_weight) ){
+			continue;	
+		}
+
+
+		/* EXECUTE USER-DEFINED FUNCTION */
+		bool ignore_node = policy.child_iterated(parent_ind, inode, node_ind, rr_node, ss_distances, node_topo_inf, max_path_weight,
+		                                         from_node_ind, to_node_ind, user_opts);
+		if (ignore_node){
+			continue;
+		}
+
+		/* mark that this node was visited. this indicates that some state variables related to the node have been changed, 
+		   and should be reset after the current connection traversal is complete */
+		node_topo_inf[node_ind].set_was_visited(true);
+
+		/* increment number of times node has been visited and get the number of legal parents of this node (for purposes of knowing
+		   whether this node has all its parent depenencies met) */
+		int num_times_visited;
+		int num_node_legal_parents;
+		if (Policy::traversal_dir == FORWARD_TRAVERSAL){
+			node_topo_inf[node_ind].increment_times_visited_from_source();
+			num_times_visited = node_topo_inf[node_ind].get_times_visited_from_source();
+			num_node_legal_parents = node_topo_inf[node_ind].set_and_or_get_num_legal_in_nodes(node_ind, rr_node, ss_distances, max_path_weight);
+		} else {
+			node_topo_inf[node_ind].increment_times_visited_from_sink();
+			num_times_visited = node_topo_inf[node_ind].get_times_visited_from_sink();
+			num_node_legal_parents = node_topo_inf[node_ind].set_and_or_get_num_legal_out_nodes(node_ind, rr_node, ss_distances, max_path_weight);
+		}
+
+		/* if this node is the destination node */
+		if (node_ind == to_node_ind){
+			continue;
+		}
+
+		/* push node to nodes_waiting structure, remove it from there, or do nothing depending on how many times
+		   the node has been visited */
+		int remaining_dependencies = num_node_legal_parents - num_times_visited;
+
+		if (num_times_visited == 1 && remaining_dependencies > 0){
+			/* visiting this node for the first time and it still has unmet dependencies -- push onto nodes_waiting structure */
+			put_child_onto_nodes_waiting_structure(node_ind, rr_node, ss_distances, node_topo_inf, Policy::traversal_dir, 
+			                                       nodes_waiting);
+
+		} else if (num_times_visited == 1 && remaining_dependencies == 0){
+			/* visiting this node for the first time, but all its dependencies are already met -- push onto queue */
+			Q.push(node_ind);
+
+			if (Policy::traversal_dir == FORWARD_TRAVERSAL){
+				node_topo_inf[node_ind].set_done_from_source(true);
+			} else {
+				node_topo_inf[node_ind].set_done_from_sink(true);
+			}
+		} else if (remaining_dependencies > 0){
+			/* this node has been visited before and it's already on the nodes_waiting structure -- do nothing */
+		} else if (remaining_dependencies == 0){
+			/* this node has been visited before, and all of its dependencies are now met -- remove from nodes_waiting structure
+			   and push onto queue */
+			node_topo_inf[node_ind].node_waiting_info.clear();
+	
+			nodes_waiting.erase( node_ind );
+			Q.push(node_ind);
 
+			if (Policy::traversal_dir == FORWARD_TRAVERSAL){
+				node_topo_inf[node_ind].set_done_from_source(true);
+			} else {
+				node_topo_inf[node_ind].set_done_from_sink(true);
+			}
+		}
+	}
+}
 
 
 
@@ -0,0 +1,303 @@
+#include "bucket_kernels.h"
+#include "exception.h"
+
+/* the AVX2/AVX-512 kernels are only built for x86 targets, using GCC target attributes (so the rest of Wotan can still be
+   compiled for any x86 CPU) */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BUCKET_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+
+/**** File-Scope Variables ****/
+/* the instruction set currently used by the bucket kernels */
+static e_bucket_kernels f_bucket_kernels = KERNELS_SCALAR;
+
+/* names of the bucket kernel instruction sets (for error messages) */
+static const char *f_bucket_kernels_string[] = {
+	"auto",
+	"scalar",
+	"avx2",
+	"avx512"
+};
+
+
+/**** Function Declarations ****/
+/* returns whether the CPU supports the specified bucket kernel instruction set */
+static bool cpu_supports_bucket_kernels(e_bucket_kernels kernels);
+
+/* scalar kernels. these define the operations performed on each bucket, which the vector kernels perform lane-by-lane */
+template <typename T> static void buckets_add_scalar(T *to_buckets, const T *from_buckets, int num_buckets);
+template <typename T> static void buckets_or_scalar(T *to_buckets, const T *from_buckets, int num_buckets);
+template <typename T> static void buckets_scale_scalar(T *buckets, int num_buckets, T factor);
+
+#ifdef BUCKET_KERNELS_X86
+/* AVX2 kernels. leftover buckets that don't fill a whole vector are handled by the scalar kernels */
+static void buckets_add_avx2(double *to_buckets, const double *from_buckets, int num_buckets);
+static void buckets_add_avx2(float *to_buckets, const float *from_buckets, int num_buckets);
+static void buckets_or_avx2(double *to_buckets, const double *from_buckets, int num_buckets);
+static void buckets_or_avx2(float *to_buckets, const float *from_buckets, int num_buckets);
+static void buckets_scale_avx2(double *buckets, int num_buckets, double factor);
+static void buckets_scale_avx2(float *buckets, int num_buckets, float factor);
+
+/* AVX-512 kernels. leftover buckets are handled with masked loads/stores */
+static void buckets_add_avx512(double *to_buckets, const double *from_buckets, int num_buckets);
+static void buckets_add_avx512(float *to_buckets, const float *from_buckets, int num_buckets);
+static void buckets_or_avx512(double *to_buckets, const double *from_buckets, int num_buckets);
+static void buckets_or_avx512(float *to_buckets, const float *from_buckets, int num_buckets);
+static void buckets_scale_avx512(double *buckets, int num_buckets, double factor);
+static void buckets_scale_avx512(float *buckets, int num_buckets, float factor);
+#endif
+
+
+/**** Function Definitions ****/
+/* selects the instruction set used by the bucket kernels from now on. KERNELS_AUTO selects the widest one supported by the CPU */
+void set_bucket_kernels(e_bucket_kernels requested_kernels){
+	if (requested_kernels == KERNELS_AUTO){
+		if (cpu_supports_bucket_kernels(KERNELS_AVX512)){
+			f_bucket_kernels = KERNELS_AVX512;
+		} else if (cpu_supports_bucket_kernels(KERNELS_AVX2)){
+			f_bucket_kernels = KERNELS_AVX2;
+		} else {
+			f_bucket_kernels = KERNELS_SCALAR;
+		}
+	} else {
+		if (!cpu_supports_bucket_kernels(requested_kernels)){
+			WTHROW(EX_INIT, "This CPU does not support the '" << f_bucket_kernels_string[requested_kernels] << "' bucket kernels");
+		}
+		f_bucket_kernels = requested_kernels;
+	}
+}
+
+/* returns the instruction set currently used by the bucket kernels */
+e_bucket_kernels get_bucket_kernels(){
+	return f_bucket_kernels;
+}
+
+/* returns whether the CPU supports the specified bucket kernel instruction set */
+static bool cpu_supports_bucket_kernels(e_bucket_kernels kernels){
+	bool supported = false;
+
+	if (kernels == KERNELS_SCALAR){
+		supported = true;
+	} else {
+#ifdef BUCKET_KERNELS_X86
+		/* these also check that the OS saves the corresponding vector registers */
+		__builtin_cpu_init();
+		if (kernels == KERNELS_AVX2){
+			supported = __builtin_cpu_supports("avx2");
+		} else if (kernels == KERNELS_AVX512){
+			supported = __builtin_cpu_supports("avx512f");
+		}
+#endif
+	}
+
+	return supported;
+}
+
+
+/* adds each of the 'num_buckets' buckets of 'from_buckets' to the corresponding bucket of 'to_buckets' */
+template <typename T> void buckets_add(T *to_buckets, const T *from_buckets, int num_buckets){
+#ifdef BUCKET_KERNELS_X86
+	if (f_bucket_kernels == KERNELS_AVX512){
+		buckets_add_avx512(to_buckets, from_buckets, num_buckets);
+		return;
+	} else if (f_bucket_kernels == KERNELS_AVX2){
+		buckets_add_avx2(to_buckets, from_buckets, num_buckets);
+		return;
+	}
+#endif
+	buckets_add_scalar(to_buckets, from_buckets, num_buckets);
+}
+
+/* OR's each of the 'num_buckets' bucket probabilities of 'from_buckets' into the corresponding bucket of 'to_buckets' */
+template <typename T> void buckets_or(T *to_buckets, const T *from_buckets, int num_buckets){
+#ifdef BUCKET_KERNELS_X86
+	if (f_bucket_kernels == KERNELS_AVX512){
+		buckets_or_avx512(to_buckets, from_buckets, num_buckets);
+		return;
+	} else if (f_bucket_kernels == KERNELS_AVX2){
+		buckets_or_avx2(to_buckets, from_buckets, num_buckets);
+		return;
+	}
+#endif
+	buckets_or_scalar(to_buckets, from_buckets, num_buckets);
+}
+
+/* multiplies each of the 'num_buckets' buckets by 'factor' */
+template <typename T> void buckets_scale(T *buckets, int num_buckets, T factor){
+#ifdef BUCKET_KERNELS_X86
+	if (f_bucket_kernels == KERNELS_AVX512){
+		buckets_scale_avx512(buckets, num_buckets, factor);
+		return;
+	} else if (f_bucket_kernels == KERNELS_AVX2){
+		buckets_scale_avx2(buckets, num_buckets, factor);
+		return;
+	}
+#endif
+	buckets_scale_scalar(buckets, num_buckets, factor);
+}
+/* IMPORTANT: these functions will only work for types explicitely specified in below templates */
+template void buckets_add<double>(double *to_buckets, const double *from_buckets, int num_buckets);
+template void buckets_add<float>(float *to_buckets, const float *from_buckets, int num_buckets);
+template void buckets_or<double>(double *to_buckets, const double *from_buckets, int num_buckets);
+template void buckets_or<float>(float *to_buckets, const float *from_buckets, int num_buckets);
+template void buckets_scale<double>(double *buckets, int num_buckets, double factor);
+template void buckets_scale<float>(float *buckets, int num_buckets, float factor);
+
+
+template <typename T> static void buckets_add_scalar(T *to_buckets, const T *from_buckets, int num_buckets){
+	for (int ibucket = 0; ibucket < num_buckets; ibucket++){
+		to_buckets[ibucket] += from_buckets[ibucket];
+	}
+}
+
+template <typename T> static void buckets_or_scalar(T *to_buckets, const T *from_buckets, int num_buckets){
+	for (int ibucket = 0; ibucket < num_buckets; ibucket++){
+		T to = to_buckets[ibucket];
+		T from = from_buckets[ibucket];
+		to_buckets[ibucket] = (to + from) - (to * from);
+	}
+}
+
+template <typename T> static void buckets_scale_scalar(T *buckets, int num_buckets, T factor){
+	for (int ibucket = 0; ibucket < num_buckets; ibucket++){
+		buckets[ibucket] *= factor;
+	}
+}
+
+
+#ifdef BUCKET_KERNELS_X86
+/*==== AVX2 Kernels ====*/
+__attribute__((target("avx2"))) static void buckets_add_avx2(double *to_buckets, const double *from_buckets, int num_buckets){
+	int ibucket = 0;
+	for ( ; ibucket + 4 <= num_buckets; ibucket += 4){
+		__m256d to = _mm256_loadu_pd(&to_buckets[ibucket]);
+		__m256d from = _mm256_loadu_pd(&from_buckets[ibucket]);
+		_mm256_storeu_pd(&to_buckets[ibucket], _mm256_add_pd(to, from));
+	}
+	buckets_add_scalar(&to_buckets[ibucket], &from_buckets[ibucket], num_buckets - ibucket);
+}
+
+__attribute__((target("avx2"))) static void buckets_add_avx2(float *to_buckets, const float *from_buckets, int num_buckets){
+	int ibucket = 0;
+	for ( ; ibucket + 8 <= num_buckets; ibucket += 8){
+		__m256 to = _mm256_loadu_ps(&to_buckets[ibucket]);
+		__m256 from = _mm256_loadu_ps(&from_buckets[ibucket]);
+		_mm256_storeu_ps(&to_buckets[ibucket], _mm256_add_ps(to, from));
+	}
+	buckets_add_scalar(&to_buckets[ibucket], &from_buckets[ibucket], num_buckets - ibucket);
+}
+
+__attribute__((target("avx2"))) static void buckets_or_avx2(double *to_buckets, const double *from_buckets, int num_buckets){
+	int ibucket = 0;
+	for ( ; ibucket + 4 <= num_buckets; ibucket += 4){
+		__m256d to = _mm256_loadu_pd(&to_buckets[ibucket]);
+		__m256d from = _mm256_loadu_pd(&from_buckets[ibucket]);
+		__m256d result = _mm256_sub_pd(_mm256_add_pd(to, from), _mm256_mul_pd(to, from));
+		_mm256_storeu_pd(&to_buckets[ibucket], result);
+	}
+	buckets_or_scalar(&to_buckets[ibucket], &from_buckets[ibucket], num_buckets - ibucket);
+}
+
+__attribute__((target("avx2"))) static void buckets_or_avx2(float *to_buckets, const float *from_buckets, int num_buckets){
+	int ibucket = 0;
+	for ( ; ibucket + 8 <= num_buckets; ibucket += 8){
+		__m256 to = _mm256_loadu_ps(&to_buckets[ibucket]);
+		__m256 from = _mm256_loadu_ps(&from_buckets[ibucket]);
+		__m256 result = _mm256_sub_ps(_mm256_add_ps(to, from), _mm256_mul_ps(to, from));
+		_mm256_storeu_ps(&to_buckets[ibucket], result);
+	}
+	buckets_or_scalar(&to_buckets[ibucket], &from_buckets[ibucket], num_buckets - ibucket);
+}
+
+__attribute__((target("avx2"))) static void buckets_scale_avx2(double *buckets, int num_buckets, double factor){
+	__m256d factors = _mm256_set1_pd(factor);
+	int ibucket = 0;
+	for ( ; ibucket + 4 <= num_buckets; ibucket += 4){
+		_mm256_storeu_pd(&buckets[ibucket], _mm256_mul_pd(_mm256_loadu_pd(&buckets[ibucket]), factors));
+	}
+	buckets_scale_scalar(&buckets[ibucket], num_buckets - ibucket, factor);
+}
+
+__attribute__((target("avx2"))) static void buckets_scale_avx2(float *buckets, int num_buckets, float factor){
+	__m256 factors = _mm256_set1_ps(factor);
+	int ibucket = 0;
+	for ( ; ibucket + 8 <= num_buckets; ibucket += 8){
+		_mm256_storeu_ps(&buckets[ibucket], _mm256_mul_ps(_mm256_loadu_ps(&buckets[ibucket]), factors));
+	}
+	buckets_scale_scalar(&buckets[ibucket], num_buckets - ibucket, factor);
+}
+/*==== END AVX2 Kernels ====*/
+
+
+/*==== AVX-512 Kernels ====*/
+/* returns a mask that selects the first min(num_lanes, 8) lanes */
+static inline __mmask8 get_lane_mask_8(int num_lanes){
+	return (num_lanes >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << num_lanes) - 1));
+}
+
+/* returns a mask that selects the first min(num_lanes, 16) lanes */
+static inline __mmask16 get_lane_mask_16(int num_lanes){
+	return (num_lanes >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << num_lanes) - 1));
+}
+
+__attribute__((target("avx512f"))) static void buckets_add_avx512(double *to_buckets, const double *from_buckets, int num_buckets){
+	for (int ibucket = 0; ibucket < num_buckets; ibucket += 8){
+		__mmask8 mask = get_lane_mask_8(num_buckets - ibucket);
+		__m512d to = _mm512_maskz_loadu_pd(mask, &to_buckets[ibucket]);
+		__m512d from = _mm512_maskz_loadu_pd(mask, &from_buckets[ibucket]);
+		_mm512_mask_storeu_pd(&to_buckets[ibucket], mask, _mm512_add_pd(to, from));
+	}
+}
+
+__attribute__((target("avx512f"))) static void buckets_add_avx512(float *to_buckets, const float *from_buckets, int num_buckets){
+	for (int ibucket = 0; ibucket < num_buckets; ibucket += 16){
+		__mmask16 mask = get_lane_mask_16(num_buckets - ibucket);
+		__m512 to = _mm512_maskz_loadu_ps(mask, &to_buckets[ibucket]);
+		__m512 from = _mm512_maskz_loadu_ps(mask, &from_buckets[ibucket]);
+		_mm512_mask_storeu_ps(&to_buckets[ibucket], mask, _mm512_add_ps(to, from));
+	}
+}
+
+__attribute__((target("avx512f"))) static void buckets_or_avx512(double *to_buckets, const double *from_buckets, int num_buckets){
+	for (int ibucket = 0; ibucket < num_buckets; ibucket += 8){
+		__mmask8 mask = get_lane_mask_8(num_buckets - ibucket);
+		__m512d to = _mm512_maskz_loadu_pd(mask, &to_buckets[ibucket]);
+		__m512d from = _mm512_maskz_loadu_pd(mask, &from_buckets[ibucket]);
+		__m512d result = _mm512_sub_pd(_mm512_add_pd(to, from), _mm512_mul_pd(to, from));
+		_mm512_mask_storeu_pd(&to_buckets[ibucket], mask, result);
+	}
+}
+
+__attribute__((target("avx512f"))) static void buckets_or_avx512(float *to_buckets, const float *from_buckets, int num_buckets){
+	for (int ibucket = 0; ibucket < num_buckets; ibucket += 16){
+		__mmask16 mask = get_lane_mask_16(num_buckets - ibucket);
+		__m512 to = _mm512_maskz_loadu_ps(mask, &to_buckets[ibucket]);
+		__m512 from = _mm512_maskz_loadu_ps(mask, &from_buckets[ibucket]);
+		__m512 result = _mm512_sub_ps(_mm512_add_ps(to, from), _mm512_mul_ps(to, from));
+		_mm512_mask_storeu_ps(&to_buckets[ibucket], mask, result);
+	}
+}
+
+__attribute__((target("avx512f"))) static void buckets_scale_avx512(double *buckets, int num_buckets, double factor){
+	__m512d factors = _mm512_set1_pd(factor);
+	for (int ibucket = 0; ibucket < num_buckets; ibucket += 8){
+		__mmask8 mask = get_lane_mask_8(num_buckets - ibucket);
+		__m512d values = _mm512_maskz_loadu_pd(mask, &buckets[ibucket]);
+		_mm512_mask_storeu_pd(&buckets[ibucket], mask, _mm512_mul_pd(values, factors));
+	}
+}
+
+__attribute__((target("avx512f"))) static void buckets_scale_avx512(float *buckets, int num_buckets, float factor){
+	__m512 factors = _mm512_set1_ps(factor);
+	for (int ibucket = 0; ibucket < num_buckets; ibucket += 16){
+		__mmask16 mask = get_lane_mask_16(num_buckets - ibucket);
+		__m512 values = _mm512_maskz_loadu_ps(mask, &buckets[ibucket]);
+		_mm512_mask_storeu_ps(&buckets[ibucket], mask, _mm512_mul_ps(values, factors));
+	}
+}
+/*==== END AVX-512 Kernels ====*/
+#endif
@@ -0,0 +1,35 @@
+#ifndef BUCKET_KERNELS_H
+#define BUCKET_KERNELS_H
+
+#include "wotan_types.h"
+
+/*
+	Kernels for the element-wise loops over node bucket arrays (see Node_Buckets) that are run for every parent/child
+edge of a topological traversal. An empty bucket holds 0, so that each kernel is a straight loop over its lanes.
+
+	Each kernel has a scalar version and AVX2/AVX-512 versions. The instruction set is picked at run time (see
+set_bucket_kernels). Every version performs the same floating point operations on each bucket, so results don't depend on
+which version is used.
+*/
+
+
+/**** Function Declarations ****/
+/* selects the instruction set used by the bucket kernels from now on. KERNELS_AUTO selects the widest one supported by
+   the CPU. throws if the CPU does not support the requested instruction set. should not be called while the kernels are in use */
+void set_bucket_kernels(e_bucket_kernels requested_kernels);
+
+/* returns the instruction set currently used by the bucket kernels */
+e_bucket_kernels get_bucket_kernels();
+
+/* adds each of the 'num_buckets' buckets of 'from_buckets' to the corresponding bucket of 'to_buckets'
+   (path count propagation) */
+template <typename T> void buckets_add(T *to_buckets, const T *from_buckets, int num_buckets);
+
+/* OR's each of the 'num_buckets' bucket probabilities of 'from_buckets' into the corresponding bucket of 'to_buckets',
+   i.e. to = to + from - to*from (path probability propagation) */
+template <typename T> void buckets_or(T *to_buckets, const T *from_buckets, int num_buckets);
+
+/* multiplies each of the 'num_buckets' buckets by 'factor' */
+template <typename T> void buckets_scale(T *buckets, int num_buckets, T factor);
+
+#endif
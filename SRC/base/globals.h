@@ -4,11 +4,8 @@
 #include "wotan_types.h"
 
 /* Contains user options for the tool */
-extern pthread_mutex_t g_mutex;
 extern float g_conns_enumerated;
 extern float g_enum_nodes_popped;
 extern float g_prob_nodes_popped;
 
-extern float g_total_adjusted_enum_path_weight;
-
 #endif
@@ -2,13 +2,20 @@
 #include <cstring>
 #include <sstream>
 #include <set>
+#include <map>
+#include <fstream>
+#include <algorithm>
 #include "wotan_init.h"
 #include "wotan_types.h"
 #include "globals.h"
 #include "exception.h"
 #include "io.h"
+#include "wotan_util.h"
 #include "draw.h"
 #include "parse_rr_structs_file.h"
+#include "parse_rr_graph_xml.h"
+#include "rr_graph_cache.h"
+#include "bucket_kernels.h"
 
 using namespace std;
 
@@ -18,6 +25,9 @@ using namespace std;
 #define MIN_GRID_SIZE_X 5
 #define MIN_GRID_SIZE_Y 5
 
+/* with -tile_symmetry, tiles are equivalent if the rr graph within (max connection length + this many) tiles of them matches up to translation */
+#define TILE_SYMMETRY_MARGIN 1
+
 
 /**** Function Declarations ****/ 
 /* Parses the command line options. Options are parsed into the user_opts variable */
@@ -31,6 +41,18 @@ static void wotan_print_title();
 /* creates a virtual source node for every sink node and links it to the nodes which connect into its ipins.
    these new sources allow for (in effect) enumerating paths from ipins while accounting for input pin equivalence */
 void create_virtual_sources(Routing_Structs *routing_structs);
+/* renumbers the rr nodes so that nodes which are close together on the FPGA grid are also close together in memory */
+static void renumber_rr_nodes_by_location(User_Options *user_opts, Arch_Structs *arch_structs, Routing_Structs *routing_structs);
+/* returns the average difference between the indices of the two nodes of an edge */
+static double get_mean_edge_index_distance(Routing_Structs *routing_structs);
+/* writes the original index of each renumbered rr node to the specified file */
+static void write_node_map_file(std::string path, Routing_Structs *routing_structs);
+/* groups the test tiles into classes of tiles whose surroundings in the rr graph are identical up to translation */
+static void set_tile_classes(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, Routing_Structs *routing_structs);
+/* fills 'signature' with a description of the rr graph at the specified location, relative to the location */
+static void get_location_signature(int x, int y, Arch_Structs *arch_structs, Routing_Structs *routing_structs, vector<int> &signature);
+/* adds the type, ptc and coordinates (relative to the specified location) of a node to the signature */
+static void add_node_to_signature(RR_Node &node, Coordinate location, vector<int> &signature);
  
 
 
@@ -43,7 +65,7 @@ void wotan_init(int argc, char **argv, User_Options *user_opts, Arch_Structs *ar
 	wotan_print_title();
 
 	//may be changed when command-line arguments are read-in
-	srand(3);
+	srand(user_opts->seed);
 
 	/* check that we have the minimum number of arguments */
 	if (argc < 2){
@@ -54,26 +76,59 @@ void wotan_init(int argc, char **argv, User_Options *user_opts, Arch_Structs *ar
 	/* parse user-specified options into user_opts variable */
 	wotan_parse_command_args(argc, argv, user_opts);
 
-	/* parse user-specified rr structs file into Wotan's architecture and routing structures */
-	parse_rr_structs_file(user_opts->rr_structs_file, arch_structs, routing_structs, user_opts->rr_structs_mode);
+	/* pick the instruction set of the node bucket kernels */
+	set_bucket_kernels(user_opts->bucket_kernels);
 
-	/* if Wotan structures are initialized from a structures file dumped by VPR, then Wotan 
-	   structures aren't complete just yet. need to allocate and set incoming edges for each node.
-	   Do this for sinks first, and then for the rest of the nodes later
-	   	- Virtual sources are created for sinks, 2nd step necessary to account for those newly-created virtual sources */
-	initialize_reverse_node_edges_and_switches(routing_structs, UNDEFINED); 
+	/* if the user specified an rr graph cache, try to initialize the architecture and routing structures from it. the cache
+	   already contains the reverse edges and virtual sources that would otherwise be computed below */
+	bool loaded_from_cache = false;
+	if ( !user_opts->rr_graph_cache_file.empty() ){
+		loaded_from_cache = load_rr_graph_cache(user_opts->rr_graph_cache_file, user_opts, arch_structs, routing_structs);
+	}
 
-	/* create virtual sources for all sinks -- this allows (in effect) enumerating of paths from ipins */
-	create_virtual_sources(routing_structs);
+	if (!loaded_from_cache){
+		if (user_opts->rr_structs_file.empty()){
+			WTHROW(EX_INIT, "An rr structs file has to be specified (with the -rr_structs_file option) if there is no valid rr graph cache to load");
+		}
 
-	/* all nodes */
-	initialize_reverse_node_edges_and_switches(routing_structs, UNDEFINED); 
+		/* parse user-specified rr structs file into Wotan's architecture and routing structures */
+		if (user_opts->rr_structs_mode == RR_STRUCTS_VPR_XML){
+			parse_rr_graph_xml(user_opts->rr_structs_file, arch_structs, routing_structs);
+		} else {
+			parse_rr_structs_file(user_opts->rr_structs_file, arch_structs, routing_structs, user_opts->rr_structs_mode, user_opts->num_threads);
+		}
+
+		/* if Wotan structures are initialized from a structures file dumped by VPR, then Wotan 
+		   structures aren't complete just yet. need to allocate and set incoming edges for each node.
+		   Do this for sinks first, and then for the rest of the nodes later
+		   	- Virtual sources are created for sinks, 2nd step necessary to account for those newly-created virtual sources */
+		initialize_reverse_node_edges_and_switches(routing_structs, UNDEFINED); 
+
+		/* create virtual sources for all sinks -- this allows (in effect) enumerating of paths from ipins */
+		create_virtual_sources(routing_structs);
+
+		/* all nodes */
+		initialize_reverse_node_edges_and_switches(routing_structs, UNDEFINED); 
+
+		/* save the fully-initialized graph so that later runs can skip parsing */
+		if ( !user_opts->rr_graph_cache_file.empty() ){
+			write_rr_graph_cache(user_opts->rr_graph_cache_file, user_opts, arch_structs, routing_structs);
+		}
+	}
+
+	if (user_opts->rr_structs_mode == RR_STRUCTS_VPR || user_opts->rr_structs_mode == RR_STRUCTS_VPR_XML){
+		/* the rr graph cache keeps the node order of the rr structs file, so the nodes are renumbered after it is loaded/written */
+		if (user_opts->renumber_nodes){
+			renumber_rr_nodes_by_location(user_opts, arch_structs, routing_structs);
+		}
 
-	if (user_opts->rr_structs_mode == RR_STRUCTS_VPR){
 		/* initialize analysis settings */
 		analysis_settings->alloc_and_set_pin_probabilities(user_opts->opin_probability, user_opts->ipin_probability, arch_structs);
 		analysis_settings->alloc_and_set_length_probabilities(user_opts);
 		analysis_settings->alloc_and_set_test_tile_coords(arch_structs, routing_structs);
+		if (user_opts->tile_symmetry){
+			set_tile_classes(user_opts, analysis_settings, arch_structs, routing_structs);
+		}
 
 		/* initialize path count history structures of rr nodes */
 		int fill_type_ind = arch_structs->get_fill_type_index();
@@ -129,10 +184,24 @@ static void wotan_parse_command_args(int argc, char **argv, User_Options *user_o
 				WTHROW(EX_INIT, "Expected an argument for the -rr_structs_file option");
 			}
 
+			user_opts->rr_structs_file = argv[iopt];
 			if (user_opts->rr_structs_mode == RR_STRUCTS_UNDEFINED){
-				user_opts->rr_structs_mode = RR_STRUCTS_VPR;	//if hasn't been set yet, then set the default. may be changed by a later cmd-line argument
+				//if hasn't been set yet, then set the default (based on file extension). may be changed by a later cmd-line argument
+				if (check_file_extension(user_opts->rr_structs_file, ".xml")){
+					user_opts->rr_structs_mode = RR_STRUCTS_VPR_XML;
+				} else {
+					user_opts->rr_structs_mode = RR_STRUCTS_VPR;
+				}
 			}
-			user_opts->rr_structs_file = argv[iopt];
+		} else if ( strcmp(argv[iopt], "-rr_graph_cache") == 0 ){
+			/* binary rr graph cache to be loaded instead of parsing the rr structs file (or to be written after parsing it) */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -rr_graph_cache option");
+			}
+
+			user_opts->rr_graph_cache_file = argv[iopt];
 		} else if ( strcmp(argv[iopt], "-rr_structs_mode") == 0 ){
 			/* specifies mode in which the rr structs file is expected to be */
 			iopt++;
@@ -144,6 +213,9 @@ static void wotan_parse_command_args(int argc, char **argv, User_Options *user_o
 			if ( strcmp(argv[iopt], "VPR") == 0 ){
 				cout << "Analyzing VPR structs." << endl;
 				user_opts->rr_structs_mode = RR_STRUCTS_VPR;
+			} else if ( strcmp(argv[iopt], "VPR_XML") == 0 ){
+				cout << "Analyzing VPR rr graph XML." << endl;
+				user_opts->rr_structs_mode = RR_STRUCTS_VPR_XML;
 			} else if ( strcmp(argv[iopt], "simple") == 0 ){
 				cout << "Analyzing basic structs." << endl;
 				user_opts->rr_structs_mode = RR_STRUCTS_SIMPLE;
@@ -159,6 +231,15 @@ static void wotan_parse_command_args(int argc, char **argv, User_Options *user_o
 			}
 
 			user_opts->num_threads = atoi(argv[iopt]);
+		} else if ( strcmp(argv[iopt], "-enumerate_rounds") == 0 ){
+			/* number of rounds in which to perform path enumeration (weights are fixed within a round) */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -enumerate_rounds option");
+			}
+
+			user_opts->enumerate_rounds = atoi(argv[iopt]);
 		} else if ( strcmp(argv[iopt], "-max_connection_length") == 0 ){
 			/* maximum connection length to consider during path enumeration */
 			iopt++;
@@ -183,6 +264,21 @@ static void wotan_parse_command_args(int argc, char **argv, User_Options *user_o
 			} else {
 				WTHROW(EX_INIT, "-analyze_core option needs y/n argument");
 			}
+		} else if ( strcmp(argv[iopt], "-tile_symmetry") == 0 ){
+			/* paths are only enumerated from one tile of each class of tiles with identical surroundings */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected a y/n argument for the -tile_symmetry option");
+			}
+
+			if ( strcmp(argv[iopt], "y") == 0 ){
+				user_opts->tile_symmetry = true;
+			} else if ( strcmp(argv[iopt], "n") == 0 ){
+				user_opts->tile_symmetry = false;
+			} else {
+				WTHROW(EX_INIT, "-tile_symmetry option needs y/n argument");
+			}
 		} else if ( strcmp(argv[iopt], "-use_routing_node_demand") == 0 ){
 			/* The demand for routing nodes (CHANX, CHANY) will be considered to be whatever is specified. Demands for all
 			   other node types will be considered to be 0. */
@@ -258,6 +354,228 @@ static void wotan_parse_command_args(int argc, char **argv, User_Options *user_o
 			}
 
 			user_opts->target_reliability = target_reliability;
+		} else if ( strcmp(argv[iopt], "-search_tolerance") == 0 ){
+			/* how close reliability has to get to the -search_for_reliability target */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -search_tolerance option");
+			}
+
+			stringstream ss;
+			ss << argv[iopt];
+			float search_tolerance;
+			ss >> search_tolerance;
+
+			if (search_tolerance <= 0){
+				WTHROW(EX_INIT, "Expected search tolerance to be > 0. Got " << search_tolerance);
+			}
+
+			user_opts->search_tolerance = search_tolerance;
+		} else if ( strcmp(argv[iopt], "-search_start_multiplier") == 0 ){
+			/* where the -search_for_reliability search should start */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -search_start_multiplier option");
+			}
+
+			stringstream ss;
+			ss << argv[iopt];
+			float search_start_multiplier;
+			ss >> search_start_multiplier;
+
+			if (search_start_multiplier <= 0){
+				WTHROW(EX_INIT, "Expected search start multiplier to be > 0. Got " << search_start_multiplier);
+			}
+
+			user_opts->search_start_multiplier = search_start_multiplier;
+		} else if ( strcmp(argv[iopt], "-search_min_multiplier") == 0 ){
+			/* lower bound on the demand multipliers tried by the -search_for_reliability search */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -search_min_multiplier option");
+			}
+
+			stringstream ss;
+			ss << argv[iopt];
+			float search_min_multiplier;
+			ss >> search_min_multiplier;
+
+			if (search_min_multiplier <= 0){
+				WTHROW(EX_INIT, "Expected search min multiplier to be > 0. Got " << search_min_multiplier);
+			}
+
+			user_opts->search_min_multiplier = search_min_multiplier;
+		} else if ( strcmp(argv[iopt], "-search_max_multiplier") == 0 ){
+			/* upper bound on the demand multipliers tried by the -search_for_reliability search */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -search_max_multiplier option");
+			}
+
+			stringstream ss;
+			ss << argv[iopt];
+			float search_max_multiplier;
+			ss >> search_max_multiplier;
+
+			if (search_max_multiplier <= 0){
+				WTHROW(EX_INIT, "Expected search max multiplier to be > 0. Got " << search_max_multiplier);
+			}
+
+			user_opts->search_max_multiplier = search_max_multiplier;
+		} else if ( strcmp(argv[iopt], "-search_max_tries") == 0 ){
+			/* maximum number of tries of the -search_for_reliability search */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -search_max_tries option");
+			}
+
+			stringstream ss;
+			ss << argv[iopt];
+			int search_max_tries;
+			ss >> search_max_tries;
+
+			if (search_max_tries <= 0){
+				WTHROW(EX_INIT, "Expected search max tries to be > 0. Got " << search_max_tries);
+			}
+
+			user_opts->search_max_tries = search_max_tries;
+		} else if ( strcmp(argv[iopt], "-demand_multiplier_list") == 0 ){
+			/* comma-separated list of additional demand multipliers at which to compute the routability metric */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -demand_multiplier_list option");
+			}
+
+			stringstream ss;
+			ss << argv[iopt];
+			string multiplier_str;
+			user_opts->demand_multiplier_list.clear();
+			while ( getline(ss, multiplier_str, ',') ){
+				stringstream multiplier_ss;
+				multiplier_ss << multiplier_str;
+				double multiplier = UNDEFINED;
+				multiplier_ss >> multiplier;
+
+				if (multiplier_ss.fail() || multiplier <= 0){
+					WTHROW(EX_INIT, "Expected demand multipliers in -demand_multiplier_list to be > 0. Got '" << multiplier_str << "'");
+				}
+
+				user_opts->demand_multiplier_list.push_back(multiplier);
+			}
+
+			if (user_opts->demand_multiplier_list.empty()){
+				WTHROW(EX_INIT, "Expected at least one demand multiplier in -demand_multiplier_list");
+			}
+		} else if ( strcmp(argv[iopt], "-bucket_precision") == 0 ){
+			/* precision of the node buckets used during probability analysis */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -bucket_precision option");
+			}
+
+			if ( strcmp(argv[iopt], "double") == 0 ){
+				user_opts->bucket_precision = PRECISION_DOUBLE;
+			} else if ( strcmp(argv[iopt], "float") == 0 ){
+				user_opts->bucket_precision = PRECISION_FLOAT;
+			} else if ( strcmp(argv[iopt], "compare") == 0 ){
+				user_opts->bucket_precision = PRECISION_COMPARE;
+			} else {
+				WTHROW(EX_INIT, "Unrecognized bucket precision: " << argv[iopt]);
+			}
+		} else if ( strcmp(argv[iopt], "-bucket_kernels") == 0 ){
+			/* instruction set of the node bucket kernels */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -bucket_kernels option");
+			}
+
+			if ( strcmp(argv[iopt], "auto") == 0 ){
+				user_opts->bucket_kernels = KERNELS_AUTO;
+			} else if ( strcmp(argv[iopt], "scalar") == 0 ){
+				user_opts->bucket_kernels = KERNELS_SCALAR;
+			} else if ( strcmp(argv[iopt], "avx2") == 0 ){
+				user_opts->bucket_kernels = KERNELS_AVX2;
+			} else if ( strcmp(argv[iopt], "avx512") == 0 ){
+				user_opts->bucket_kernels = KERNELS_AVX512;
+			} else {
+				WTHROW(EX_INIT, "Unrecognized bucket kernels: " << argv[iopt]);
+			}
+		} else if ( strcmp(argv[iopt], "-share_source_distances") == 0 ){
+			/* connections of the same source share one forward distance traversal */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected a y/n argument for the -share_source_distances option");
+			}
+
+			if ( strcmp(argv[iopt], "y") == 0 ){
+				user_opts->share_source_distances = true;
+			} else if ( strcmp(argv[iopt], "n") == 0 ){
+				user_opts->share_source_distances = false;
+			} else {
+				WTHROW(EX_INIT, "-share_source_distances option needs y/n argument");
+			}
+		} else if ( strcmp(argv[iopt], "-distance_cache_mb") == 0 ){
+			/* size of each thread's cache of connection distance fields */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -distance_cache_mb option");
+			}
+
+			int distance_cache_mb = atoi(argv[iopt]);
+			if (distance_cache_mb < 0){
+				WTHROW(EX_INIT, "The size of the distance cache can't be negative. Got " << distance_cache_mb);
+			}
+
+			user_opts->distance_cache_mb = distance_cache_mb;
+		} else if ( strcmp(argv[iopt], "-task_order") == 0 ){
+			/* order in which test tile sources are handed to the threads */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -task_order option");
+			}
+
+			if ( strcmp(argv[iopt], "row") == 0 ){
+				user_opts->task_order = TASK_ORDER_ROW;
+			} else if ( strcmp(argv[iopt], "hilbert") == 0 ){
+				user_opts->task_order = TASK_ORDER_HILBERT;
+			} else {
+				WTHROW(EX_INIT, "Unrecognized task order: " << argv[iopt]);
+			}
+		} else if ( strcmp(argv[iopt], "-renumber_nodes") == 0 ){
+			/* renumber rr nodes by location */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected a y/n argument for the -renumber_nodes option");
+			}
+
+			if ( strcmp(argv[iopt], "y") == 0 ){
+				user_opts->renumber_nodes = true;
+			} else if ( strcmp(argv[iopt], "n") == 0 ){
+				user_opts->renumber_nodes = false;
+			} else {
+				WTHROW(EX_INIT, "-renumber_nodes option needs y/n argument");
+			}
+		} else if ( strcmp(argv[iopt], "-node_map_file") == 0 ){
+			/* file to which the original index of each renumbered rr node is written */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -node_map_file option");
+			}
+
+			user_opts->node_map_file = argv[iopt];
 		} else if ( strcmp(argv[iopt], "-self_congestion") == 0 ){
 			/* method to deal with self congestion */
 			iopt++;
@@ -288,6 +606,7 @@ static void wotan_parse_command_args(int argc, char **argv, User_Options *user_o
 			unsigned int seed;
 			ss >> seed;
 
+			user_opts->seed = seed;
 			srand(seed);
 		} else if ( strcmp(argv[iopt], "-nodisp") == 0 ){
 			/* no graphics */
@@ -317,9 +636,14 @@ static void wotan_print_usage(){
 	cout << "perform reachability analysis on different source/sink pairs." << endl << endl;
 	
 	cout << "Usage:" << endl;
-	cout << "\t./wotan -rr_structs_file <file_path> [-rr_structs_mode <VPR/simple>] [-threads <num_threads>] [-max_connection_length <max_length>]" << endl <<
-		"\t\t[-analyze_core <y/n>] [-use_routing_node_demand <demand>]" << endl <<
-		"\t\t[-demand_multiplier <multiplier>] [-self_congestion_mode <none/radius/path_dependence>] [-seed <value>] [-nodisp]" << endl << endl;
+	cout << "\t./wotan -rr_structs_file <file_path> [-rr_structs_mode <VPR/VPR_XML/simple>] [-rr_graph_cache <file_path>] [-threads <num_threads>] [-max_connection_length <max_length>]" << endl <<
+		"\t\t[-enumerate_rounds <num_rounds>] [-tile_symmetry <y/n>] [-analyze_core <y/n>] [-use_routing_node_demand <demand>]" << endl <<
+		"\t\t[-demand_multiplier <multiplier>] [-search_for_reliability <reliability>] [-search_tolerance <tolerance>]" << endl <<
+		"\t\t[-search_start_multiplier <multiplier>] [-search_min_multiplier <multiplier>] [-search_max_multiplier <multiplier>]" << endl <<
+		"\t\t[-search_max_tries <num_tries>] [-demand_multiplier_list <m1,m2,...>] [-bucket_precision <double/float/compare>]" << endl <<
+		"\t\t[-bucket_kernels <auto/scalar/avx2/avx512>] [-share_source_distances <y/n>] [-distance_cache_mb <megabytes>]" << endl <<
+		"\t\t[-task_order <row/hilbert>] [-renumber_nodes <y/n>] [-node_map_file <file_path>]" << endl <<
+		"\t\t[-self_congestion_mode <none/radius/path_dependence>] [-seed <value>] [-nodisp]" << endl << endl;
 
 	cout << "Options:" << endl;
 
@@ -327,13 +651,28 @@ static void wotan_print_usage(){
 
 	cout << "\t-rr_structs_mode: used to specify what 'mode' Wotan should expect the rr_structs_file to be in. The allowed modes are:" << endl <<
 		"\t\tVPR -- expect rr structs file to contain dumped structures from VPR (default)" << endl <<
+		"\t\tVPR_XML -- expect rr structs file to be an rr graph XML file written by VPR (--write_rr_graph). This is the default" << endl <<
+		"\t\t\tfor files ending in '.xml'" << endl <<
 		"\t\tsimple -- expect rr structs file to contain only the rr_node section (in the same format as for the dumped VPR structures file) with" << endl <<
 		"\t\t\tonly one source node and one sink node. This is useful for debugging and analyzing custom graphs" << endl << endl;
 
+	cout << "\t-rr_graph_cache: path to a binary cache of the initialized rr graph. If the cache exists and was created from the current" << endl <<
+		"\t\trr_structs_file, the graph is loaded from the cache instead of parsing the rr_structs_file. Otherwise the rr_structs_file" << endl <<
+		"\t\tis parsed and the cache is (re)written. If -rr_structs_file is not specified, the cache is loaded without checking it against" << endl <<
+		"\t\ta structs file" << endl << endl;
+
 	cout << "\t-threads: used to specify the number of threads to be used during the path enumeration and probability analysis steps (default is 1)" << endl << endl;
 
 	cout << "\t-max_connection_length: the maximum allowed connection length for path enumeration (default is 3)" << endl << endl;
 
+	cout << "\t-enumerate_rounds: if specified, path enumeration is split into this many rounds. Node weights stay fixed during a round and node" << endl;
+	cout << "\t\tdemands enumerated during the round are added in a fixed order once the round is done, so that enumeration results are identical" << endl;
+	cout << "\t\tfor any number of threads. Only the 'none' self-congestion method can be used with this option (disabled by default)" << endl << endl;
+
+	cout << "\t-tile_symmetry: if set, test tiles whose surroundings in the rr graph are identical up to translation are grouped into classes." << endl;
+	cout << "\t\teach connection picked by the tiles of a class is only enumerated once (from one tile of the class), and the resulting node" << endl;
+	cout << "\t\tdemands are added to the equivalent nodes of the tiles that picked it. Requires -enumerate_rounds (disabled by default)" << endl << endl;
+
 	cout << "\t-analyze_core: if set, reachability analysis will only be performed for a core region of the FPGA;" << endl;
 	cout << "\t\tpath enumeration is still performed everywhere (enabled by default)" << endl << endl;
 
@@ -353,9 +692,56 @@ static void wotan_print_usage(){
 	cout << "\t\t                   Child node demands are then discounted routing probability analysis traverses from the respective child" << endl;
 	cout << "\t\t                   node to this one. This mode uses significantly more memory." << endl << endl;
 
-	//Commenting. This doesn't really work.
-	//cout << "\t-search_for_reliability: if specified, wotan will search for the demand_multiplier value required to achieve the specified value of reliability." << endl;
-	//cout << "\t\tany values specified with the -demand_multiplier option will be ignored." << endl << endl;
+	cout << "\t-search_for_reliability: if specified, wotan will search for the demand_multiplier value required to achieve the specified value of reliability." << endl;
+	cout << "\t\tany values specified with the -demand_multiplier option will be ignored. the graph is only read once; node demands are reset" << endl;
+	cout << "\t\tbefore each try. the result is printed on a single 'search_result:' line at the end of the search" << endl << endl;
+
+	cout << "\t-search_tolerance: how close reliability must get to the -search_for_reliability target (default 0.02)" << endl << endl;
+
+	cout << "\t-search_start_multiplier: the demand multiplier at which the -search_for_reliability search starts. passing in the result" << endl;
+	cout << "\t\tfor a similar architecture (i.e. the previous channel width of a sweep) usually saves several tries" << endl << endl;
+
+	cout << "\t-search_min_multiplier / -search_max_multiplier: bounds on the demand multipliers tried by the -search_for_reliability search." << endl;
+	cout << "\t\tif the target reliability lies outside of the bounds, the search stops at the closest bound" << endl << endl;
+
+	cout << "\t-search_max_tries: maximum number of analyses performed by the -search_for_reliability search (default 20)" << endl << endl;
+
+	cout << "\t-demand_multiplier_list: comma-separated list of demand multipliers at which the routability metric is also reported." << endl;
+	cout << "\t\tpaths are enumerated once at -demand_multiplier, and a single set of probability traversals computes the metric at every" << endl;
+	cout << "\t\tmultiplier of the list (a 'routability_curve:' line is printed at the end). The fixed demand of -use_routing_node_demand" << endl;
+	cout << "\t\tdoesn't depend on the multiplier, so it is the same at every listed multiplier. Cannot be used with" << endl;
+	cout << "\t\t-search_for_reliability or the 'radius' self-congestion method" << endl << endl;
+
+	cout << "\t-bucket_precision: precision of the node buckets through which connection probabilities are propagated (default 'double')." << endl;
+	cout << "\t\t'float' halves the bucket memory of the probability analysis. 'compare' uses float buckets, but also analyzes each" << endl;
+	cout << "\t\tconnection with double buckets and prints the differences on a 'precision_report:' line. path enumeration always uses double" << endl << endl;
+
+	cout << "\t-bucket_kernels: instruction set used for the loops over node buckets (default 'auto', the widest one supported by the CPU)." << endl;
+	cout << "\t\tall choices give identical results" << endl << endl;
+
+	cout << "\t-share_source_distances: if set (the default), the distances of nodes from a source are found once and shared by all" << endl;
+	cout << "\t\tconnections of that source, rather than being found again for each connection. only used while node weights are fixed" << endl;
+	cout << "\t\t(probability analysis, and path enumeration with -enumerate_rounds). gives the same results either way" << endl << endl;
+
+	cout << "\t-distance_cache_mb: each thread caches up to this many megabytes of the node distances found for the connections it analyzes" << endl;
+	cout << "\t\t(0 disables the cache). a connection that is analyzed again with the same node weights then has its distances" << endl;
+	cout << "\t\tcopied from the cache instead of finding them again. this happens during -search_for_reliability (node weights often" << endl;
+	cout << "\t\tsaturate at the same values for different demand multipliers, and the first enumeration round always starts from the same" << endl;
+	cout << "\t\tweights) and with '-bucket_precision compare', so by default the cache is 64 MB in these modes and off otherwise." << endl;
+	cout << "\t\tonly used while node weights are fixed. gives the same results either way" << endl << endl;
+
+	cout << "\t-task_order: order in which the sources of the test tiles are handed to the threads (default 'row'). with 'row', tiles are" << endl;
+	cout << "\t\ttaken row by row and sources are dealt out to the threads round-robin. with 'hilbert', tiles are taken along a Hilbert" << endl;
+	cout << "\t\tcurve and each thread gets a contiguous block of sources, so that consecutive connections of a thread start from nearby" << endl;
+	cout << "\t\ttiles and reuse more of the same graph data from the CPU caches. the same connections are analyzed either way, but path" << endl;
+	cout << "\t\tenumeration without -enumerate_rounds depends on their order" << endl << endl;
+
+	cout << "\t-renumber_nodes: if set (the default), rr nodes are renumbered after the graph is read, in the order of their tiles along a" << endl;
+	cout << "\t\tHilbert curve and then by type and ptc. nodes that are close together on the FPGA then also lie close together in memory," << endl;
+	cout << "\t\twhich makes graph traversals faster. the rr graph cache keeps the original order" << endl << endl;
+
+	cout << "\t-node_map_file: if specified, the rr node index used by Wotan and the original index of the node (its index in the rr structs" << endl;
+	cout << "\t\tfile, or the index at which Wotan created it for virtual sources) are written to this file, one node per line" << endl << endl;
 
 	cout << "\t-seed: specified the seed for the random number generator" << endl << endl;
 
@@ -373,7 +759,7 @@ static void check_setup( User_Options *user_opts, Arch_Structs *arch_structs, Ro
 	int grid_size_x, grid_size_y;
 	arch_structs->get_grid_size(&grid_size_x, &grid_size_y);
 
-	if (user_opts->rr_structs_mode == RR_STRUCTS_VPR){
+	if (user_opts->rr_structs_mode == RR_STRUCTS_VPR || user_opts->rr_structs_mode == RR_STRUCTS_VPR_XML){
 		if (grid_size_x < MIN_GRID_SIZE_X || grid_size_y < MIN_GRID_SIZE_Y){
 			WTHROW(EX_INIT, "Minimum allowed FPGA size is " << MIN_GRID_SIZE_X << " by " << MIN_GRID_SIZE_Y  << " logic block spans. " <<
 					"Specified FPGA size is " << grid_size_x << " by " << grid_size_y << endl);
@@ -400,6 +786,65 @@ static void check_setup( User_Options *user_opts, Arch_Structs *arch_structs, Ro
 		WTHROW(EX_INIT, "Number of threads to be used during path enumeration has to be greater than 0");
 	}
 
+	if (user_opts->search_min_multiplier != UNDEFINED && user_opts->search_max_multiplier != UNDEFINED){
+		if (user_opts->search_min_multiplier >= user_opts->search_max_multiplier){
+			WTHROW(EX_INIT, "The -search_min_multiplier option has to be smaller than -search_max_multiplier");
+		}
+	}
+
+	/* nodes are only renumbered for graphs of an FPGA grid */
+	if (!user_opts->node_map_file.empty()){
+		if (!user_opts->renumber_nodes){
+			WTHROW(EX_INIT, "The -node_map_file option requires the rr nodes to be renumbered (-renumber_nodes y)");
+		}
+		if (user_opts->rr_structs_mode == RR_STRUCTS_SIMPLE){
+			WTHROW(EX_INIT, "The -node_map_file option cannot be used with '-rr_structs_mode simple'");
+		}
+	}
+
+	/* enumeration rounds only buffer node demands -- the structures kept by the other self-congestion methods would still be updated in
+	   whichever order the threads get to them */
+	if (user_opts->enumerate_rounds != UNDEFINED){
+		if (user_opts->enumerate_rounds <= 0){
+			WTHROW(EX_INIT, "Number of path enumeration rounds has to be greater than 0");
+		}
+		if (user_opts->self_congestion_mode != MODE_NONE){
+			WTHROW(EX_INIT, "Only the 'none' self-congestion method is allowed if the -enumerate_rounds option is used.");
+		}
+	}
+
+	/* the routability curve scales each node demand by (listed multiplier / demand multiplier). the discounts of the 'radius'
+	   self-congestion method do not scale this way */
+	if (!user_opts->demand_multiplier_list.empty()){
+		if (user_opts->target_reliability != UNDEFINED){
+			WTHROW(EX_INIT, "The -demand_multiplier_list option cannot be used together with -search_for_reliability");
+		}
+		if (user_opts->self_congestion_mode == MODE_RADIUS){
+			WTHROW(EX_INIT, "The -demand_multiplier_list option cannot be used with the 'radius' self-congestion method");
+		}
+		if (user_opts->rr_structs_mode == RR_STRUCTS_SIMPLE){
+			WTHROW(EX_INIT, "The -demand_multiplier_list option cannot be used with '-rr_structs_mode simple'");
+		}
+		if (user_opts->demand_multiplier <= 0){
+			WTHROW(EX_INIT, "The -demand_multiplier_list option requires a demand multiplier > 0");
+		}
+	}
+
+	/* the simple graph analysis does not go through the test tile connections, which are what the precision report covers */
+	if (user_opts->bucket_precision != PRECISION_DOUBLE && user_opts->rr_structs_mode == RR_STRUCTS_SIMPLE){
+		WTHROW(EX_INIT, "The -bucket_precision option cannot be used with '-rr_structs_mode simple'");
+	}
+
+	/* replicated demands are added to the nodes along with the demands of each enumeration round */
+	if (user_opts->tile_symmetry){
+		if (user_opts->enumerate_rounds == UNDEFINED){
+			WTHROW(EX_INIT, "The -tile_symmetry option requires the -enumerate_rounds option");
+		}
+		if (user_opts->rr_structs_mode == RR_STRUCTS_SIMPLE){
+			WTHROW(EX_INIT, "The -tile_symmetry option cannot be used with '-rr_structs_mode simple'");
+		}
+	}
+
 	/* if user wants a specific routing node demand (via -use_routing_node_demand) option, then path count histories should not be kept */
 	if (user_opts->use_routing_node_demand > 0){
 		if (user_opts->self_congestion_mode != MODE_NONE){
@@ -431,6 +876,11 @@ void create_virtual_sources(Routing_Structs *routing_structs){
 
 	t_rr_node &rr_node = routing_structs->rr_node;
 
+	/* the out-edges of the new nodes are appended to the out-edge table */
+	if (routing_structs->out_edge_table.get_num_nodes() != num_nodes){
+		WTHROW(EX_INIT, "Expected the out-edge table to hold the edges of all " << num_nodes << " rr nodes");
+	}
+
 	/* find and act on sink nodes */
 	for (int inode = 0; inode < num_nodes; inode++){
 		/* skip nodes that aren't sinks */
@@ -480,8 +930,8 @@ void create_virtual_sources(Routing_Structs *routing_structs){
 		}
 
 		/* create a virtual source that will have outgoing edges to those chanx/chany nodes immediately reachable (backwards) by the sink (through ipins) */
-		rr_node.push_back(RR_Node());
-		RR_Node &new_node = rr_node.back();
+		int new_node_index = routing_structs->add_rr_node();
+		RR_Node &new_node = rr_node[new_node_index];
 		//RR_Node new_node;
 		new_node.set_is_virtual_source(true);
 		new_node.set_rr_type(SOURCE);
@@ -490,20 +940,206 @@ void create_virtual_sources(Routing_Structs *routing_structs){
 
 		/* we have found unique nodes which connect into the ipins (that then connect into the sink). add these nodes as out-edges for
 		   our new virtual source */
-		int num_channel_nodes = (int)channel_nodes.size();
-		new_node.alloc_out_edges_and_switches( num_channel_nodes );
-		int iedge = 0;
-		for ( int chan_node_ind : channel_nodes ){
-			new_node.out_edges[iedge] = chan_node_ind;
-			iedge++;
-		}
+		vector<int> virtual_edges(channel_nodes.begin(), channel_nodes.end());
+		vector<short> virtual_switches(virtual_edges.size(), UNDEFINED);	/* virtual edges don't correspond to any switch */
+		routing_structs->out_edge_table.append_node(virtual_edges, virtual_switches);
 
 		/* insert new node into the rr_node structure */
 		//rr_node.push_back(new_node);
-		int new_node_index = (int)rr_node.size()-1;
 
 		/* mark the sink node with the index of this new virtual source */
 		rr_node[inode].set_virtual_source_node_ind( new_node_index );		//using rr_node instead of sink_node reference because rr_node vector changed
 	}
+
+	/* the out-edge table has grown -- point the nodes at their (possibly moved) edges */
+	routing_structs->link_rr_node_edges();
 }
 
+
+/* renumbers the rr nodes so that nodes which are close together on the FPGA grid are also close together in memory. VPR dumps nodes
+   grouped by type, so the wires of a channel can be far away from the pins they connect to. nodes are instead ordered by the index of
+   their (low) tile along a Hilbert curve, then by type and ptc. the original order breaks any remaining ties */
+static void renumber_rr_nodes_by_location(User_Options *user_opts, Arch_Structs *arch_structs, Routing_Structs *routing_structs){
+	t_rr_node &rr_node = routing_structs->rr_node;
+	int num_nodes = routing_structs->get_num_rr_nodes();
+
+	int grid_size_x, grid_size_y;
+	arch_structs->get_grid_size(&grid_size_x, &grid_size_y);
+	int curve_size = get_hilbert_curve_size(grid_size_x, grid_size_y);
+
+	/* ((curve index, type), (ptc, original index)) of each node */
+	vector< pair< pair<long,int>, pair<int,int> > > node_order_keys(num_nodes);
+	for (int inode = 0; inode < num_nodes; inode++){
+		RR_Node &node = rr_node[inode];
+		long curve_index = get_hilbert_curve_index(node.get_xlow(), node.get_ylow(), curve_size);
+		node_order_keys[inode] = make_pair( make_pair(curve_index, (int)node.get_rr_type()), make_pair((int)node.get_ptc_num(), inode) );
+	}
+	sort(node_order_keys.begin(), node_order_keys.end());
+
+	vector<int> new_node_inds(num_nodes);
+	for (int inode = 0; inode < num_nodes; inode++){
+		new_node_inds[ node_order_keys[inode].second.second ] = inode;
+	}
+
+	double distance_before = get_mean_edge_index_distance(routing_structs);
+	routing_structs->renumber_rr_nodes(new_node_inds);
+	double distance_after = get_mean_edge_index_distance(routing_structs);
+
+	cout << "Renumbered " << num_nodes << " rr nodes by location. Mean index distance along an edge: " << distance_before << " before, " <<
+		distance_after << " after" << endl;
+
+	if ( !user_opts->node_map_file.empty() ){
+		write_node_map_file(user_opts->node_map_file, routing_structs);
+	}
+}
+
+
+/* returns the average difference between the indices of the two nodes of an edge. the smaller it is, the more likely it is that
+   a traversal finds the next node in a cache line that it has recently accessed */
+static double get_mean_edge_index_distance(Routing_Structs *routing_structs){
+	t_rr_node &rr_node = routing_structs->rr_node;
+	int num_nodes = routing_structs->get_num_rr_nodes();
+
+	double total_distance = 0;
+	long num_edges = 0;
+	for (int inode = 0; inode < num_nodes; inode++){
+		int *edge_list = rr_node[inode].out_edges;
+		int num_out_edges = rr_node[inode].get_num_out_edges();
+		for (int iedge = 0; iedge < num_out_edges; iedge++){
+			total_distance += abs(edge_list[iedge] - inode);
+			num_edges++;
+		}
+	}
+
+	double mean_distance = 0;
+	if (num_edges > 0){
+		mean_distance = total_distance / (double)num_edges;
+	}
+	return mean_distance;
+}
+
+
+/* writes the original index of each renumbered rr node to the specified file, as lines of '<node index> <original node index>' */
+static void write_node_map_file(string path, Routing_Structs *routing_structs){
+	fstream file;
+	open_file(&file, path, ios::out | ios::trunc);
+
+	file << "# wotan_node_index original_node_index" << endl;
+	int num_nodes = routing_structs->get_num_rr_nodes();
+	for (int inode = 0; inode < num_nodes; inode++){
+		file << inode << " " << routing_structs->rr_node[inode].get_original_node_ind() << "\n";
+	}
+
+	file.close();
+	if (file.fail()){
+		WTHROW(EX_INIT, "Failed to write node map file " << path);
+	}
+}
+
+
+/* groups the test tiles into classes of tiles whose surroundings in the rr graph are identical up to translation. the first tile
+   of each class (in test tile order) is its representative */
+static void set_tile_classes(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, Routing_Structs *routing_structs){
+	vector<Tile_Class> &tile_classes = analysis_settings->tile_classes;
+	tile_classes.clear();
+
+	int grid_size_x, grid_size_y;
+	arch_structs->get_grid_size(&grid_size_x, &grid_size_y);
+	int radius = user_opts->max_connection_length + TILE_SYMMETRY_MARGIN;
+
+	/* give each grid location an id, such that locations get the same id if the rr graph at them is the same up to translation */
+	vector< vector<int> > location_ids(grid_size_x, vector<int>(grid_size_y, UNDEFINED));
+	map< vector<int>, int > id_of_location_signature;
+	vector<int> signature;
+	for (int ix = 0; ix < grid_size_x; ix++){
+		for (int iy = 0; iy < grid_size_y; iy++){
+			get_location_signature(ix, iy, arch_structs, routing_structs, signature);
+
+			map< vector<int>, int >::iterator it = id_of_location_signature.find(signature);
+			if (it == id_of_location_signature.end()){
+				it = id_of_location_signature.insert( make_pair(signature, (int)id_of_location_signature.size()) ).first;
+			}
+			location_ids[ix][iy] = it->second;
+		}
+	}
+
+	/* tiles are equivalent if all locations within 'radius' of them have the same ids */
+	map< vector<int>, int > class_of_tile_signature;
+	for (int itile = 0; itile < (int)analysis_settings->test_tile_coords.size(); itile++){
+		Coordinate tile_coord = analysis_settings->test_tile_coords[itile];
+
+		signature.clear();
+		for (int ix = tile_coord.x - radius; ix <= tile_coord.x + radius; ix++){
+			for (int iy = tile_coord.y - radius; iy <= tile_coord.y + radius; iy++){
+				if (ix < 0 || ix >= grid_size_x || iy < 0 || iy >= grid_size_y){
+					/* off the edge of the FPGA */
+					signature.push_back(UNDEFINED);
+				} else {
+					signature.push_back(location_ids[ix][iy]);
+				}
+			}
+		}
+
+		map< vector<int>, int >::iterator it = class_of_tile_signature.find(signature);
+		if (it == class_of_tile_signature.end()){
+			it = class_of_tile_signature.insert( make_pair(signature, (int)tile_classes.size()) ).first;
+			tile_classes.push_back( Tile_Class() );
+			tile_classes.back().representative = tile_coord;
+		}
+		tile_classes[it->second].members.push_back(tile_coord);
+	}
+
+	cout << "Tile symmetry: " << analysis_settings->test_tile_coords.size() << " test tiles in " << tile_classes.size() << " classes" << endl;
+}
+
+
+/* fills 'signature' with a description of the grid tile and rr nodes at the specified location, and of the nodes to which they connect.
+   coordinates are relative to the location, so that two locations have the same signature if the rr graph at one of them is
+   a translated copy of that at the other */
+static void get_location_signature(int x, int y, Arch_Structs *arch_structs, Routing_Structs *routing_structs, vector<int> &signature){
+	signature.clear();
+
+	t_rr_node &rr_node = routing_structs->rr_node;
+	t_rr_node_index &rr_node_index = routing_structs->rr_node_index;
+	Coordinate location(x, y);
+
+	Grid_Tile &grid_tile = arch_structs->grid[x][y];
+	signature.push_back(grid_tile.get_type_index());
+	signature.push_back(grid_tile.get_width_offset());
+	signature.push_back(grid_tile.get_height_offset());
+
+	for (int itype = 0; itype < (int)rr_node_index.size(); itype++){
+		vector<int> &index_nodes = rr_node_index[itype][x][y];
+		signature.push_back( (int)index_nodes.size() );
+
+		for (int iptc = 0; iptc < (int)index_nodes.size(); iptc++){
+			int node_ind = index_nodes[iptc];
+			if (node_ind == UNDEFINED){
+				signature.push_back(UNDEFINED);
+				continue;
+			}
+
+			RR_Node &node = rr_node[node_ind];
+			add_node_to_signature(node, location, signature);
+
+			int num_out_edges = node.get_num_out_edges();
+			short *out_switches = node.get_out_switches();
+			signature.push_back(num_out_edges);
+			for (int iedge = 0; iedge < num_out_edges; iedge++){
+				add_node_to_signature(rr_node[ node.out_edges[iedge] ], location, signature);
+				signature.push_back(out_switches[iedge]);
+			}
+		}
+	}
+}
+
+
+/* adds the type, ptc and coordinates (relative to the specified location) of a node to the signature */
+static void add_node_to_signature(RR_Node &node, Coordinate location, vector<int> &signature){
+	signature.push_back(node.get_rr_type());
+	signature.push_back(node.get_ptc_num());
+	signature.push_back(node.get_xlow() - location.x);
+	signature.push_back(node.get_ylow() - location.y);
+	signature.push_back(node.get_xhigh() - location.x);
+	signature.push_back(node.get_yhigh() - location.y);
+}
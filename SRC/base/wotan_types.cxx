@@ -22,7 +22,8 @@ const string g_rr_type_string[NUM_RR_TYPES]{
 const string g_rr_structs_mode_string[NUM_RR_STRUCTS_MODES]{
 	"RR_STRUCTS_UNDEFINED",
 	"RR_STRUCTS_VPR",
-	"RR_STRUCTS_SIMPLE"
+	"RR_STRUCTS_SIMPLE",
+	"RR_STRUCTS_VPR_XML"
 };
 
 /*==== User Options Class ====*/
@@ -30,15 +31,32 @@ User_Options::User_Options(){
 	this->nodisp = false;
 	this->rr_structs_mode = RR_STRUCTS_UNDEFINED;
 	this->num_threads = 1;
+	this->enumerate_rounds = UNDEFINED;
 	this->max_connection_length = 3;
 	this->analyze_core = true;
+	this->tile_symmetry = false;
 
 	this->use_routing_node_demand = UNDEFINED;
 
 	this->target_reliability = UNDEFINED;
+	this->search_tolerance = 0.02;
+	this->search_start_multiplier = UNDEFINED;
+	this->search_min_multiplier = UNDEFINED;
+	this->search_max_multiplier = UNDEFINED;
+	this->search_max_tries = 20;
 
 	this->self_congestion_mode = MODE_NONE;
 
+	this->bucket_precision = PRECISION_DOUBLE;
+	this->bucket_kernels = KERNELS_AUTO;
+
+	this->share_source_distances = true;
+	this->distance_cache_mb = UNDEFINED;
+	this->task_order = TASK_ORDER_ROW;
+	this->renumber_nodes = true;
+
+	this->seed = 3;
+
 	/* pin pbobabilities can be initialized from a file in the future, but for now set them
 	   to some default values */
 	this->ipin_probability = 0.0;	//was 0.3
@@ -165,21 +183,62 @@ int Analysis_Settings::get_max_path_weight(int conn_length){
 /*==== END Analysis_Settings Class ====*/
 
 
-/*==== RR_Node_Base Class ====*/
+/*==== RR_Node_Cold Class ====*/
 /* Constructor initializes everything to UNDEFINED */
+RR_Node_Cold::RR_Node_Cold(){
+	this->R = UNDEFINED;
+	this->C = UNDEFINED;
+	this->fan_in = UNDEFINED;
+	this->direction = (e_direction)UNDEFINED;
+
+	this->out_switches = NULL;
+	this->in_switches = NULL;
+
+	this->highlight = false;
+
+	this->source_sink_path_history = NULL;
+	this->path_count_history_radius = UNDEFINED;
+	this->num_lb_sources_and_sinks = UNDEFINED;
+
+	this->child_demand_contributions = NULL;
+	this->num_child_demand_buckets = UNDEFINED;
+}
+
+RR_Node_Cold::RR_Node_Cold(const RR_Node_Cold &obj){
+	this->R = obj.R;
+	this->C = obj.C;
+	this->fan_in = obj.fan_in;
+	this->direction = obj.direction;
+
+	/* switch lists are owned by the edge tables of the Routing_Structs class */
+	this->out_switches = obj.out_switches;
+	this->in_switches = obj.in_switches;
+
+	this->highlight = obj.highlight;
+
+	//TODO: copy over source-sink path history if you still want to use that
+	this->source_sink_path_history = NULL;
+	this->path_count_history_radius = UNDEFINED;
+	this->num_lb_sources_and_sinks = obj.num_lb_sources_and_sinks;
+
+	/* demand contributions are not copied */
+	this->child_demand_contributions = NULL;
+	this->num_child_demand_buckets = UNDEFINED;
+}
+/*==== END RR_Node_Cold Class ====*/
+
+
+/*==== RR_Node_Base Class ====*/
+/* Constructor initializes everything to UNDEFINED. The node has no cold entry until one is assigned by the Routing_Structs class */
 RR_Node_Base::RR_Node_Base(){
 	this->type = (e_rr_type)UNDEFINED;
 	this->xlow = UNDEFINED;
 	this->ylow = UNDEFINED;
 	this->span = UNDEFINED;
-	this->R = UNDEFINED;
-	this->C = UNDEFINED;
 	this->ptc_num = UNDEFINED;
-	this->fan_in = UNDEFINED;
 	this->num_out_edges = UNDEFINED;
-	this->direction = (e_direction)UNDEFINED;
 	this->out_edges = NULL;
-	this->out_switches = NULL;
+	this->cold = NULL;
 }
 
 RR_Node_Base::RR_Node_Base(const RR_Node_Base &obj){
@@ -188,42 +247,31 @@ RR_Node_Base::RR_Node_Base(const RR_Node_Base &obj){
 	this->xlow = obj.get_xlow();
 	this->ylow = obj.get_ylow();
 	this->span = obj.get_span();
-	this->R = obj.get_R();
-	this->C = obj.get_C();
 	this->ptc_num = obj.get_ptc_num();
-	this->fan_in = obj.get_fan_in();
-	this->num_out_edges = obj.get_num_out_edges();
-	this->direction = obj.get_direction();
 
-	this->alloc_out_edges_and_switches(obj.num_out_edges);
+	/* the cold entry is owned by the Routing_Structs class, so the copy refers to the same entry */
+	this->cold = obj.cold;
 
-	for (int iedge = 0; iedge < obj.num_out_edges; iedge++){
-		this->out_edges[iedge] = obj.out_edges[iedge];
-		this->out_switches[iedge] = obj.out_switches[iedge];
-	}
+	/* edges are owned by the edge table, so the copy refers to the same edges */
+	this->out_edges = obj.out_edges;
+	this->num_out_edges = obj.num_out_edges;
 }
 
 /* frees allocated members */
 void RR_Node_Base::free_allocated_members(){
-	//XXX this wont work with virtual sources without copy constructors
-
-	if (!this->out_edges)
-		delete [] this->out_edges;
-	if (!this->out_switches)
-		delete [] this->out_switches;
-	this->out_edges = NULL;
-	this->out_switches = NULL;
+	/* edge lists belong to the edge table of the Routing_Structs class */
+	this->set_out_edges_and_switches(NULL, NULL, UNDEFINED);
 }
 
-/* Allocates edge array and switch array, and sets num_out_edges */
-void RR_Node_Base::alloc_out_edges_and_switches(short n_edges){
+/* sets out-edge/switch lists to the specified span of an edge table, and sets num_out_edges */
+void RR_Node_Base::set_out_edges_and_switches(int *edges, short *switches, short n_edges){
 	if (n_edges > 0){
-		this->out_edges = new int[n_edges];
-		this->out_switches = new short[n_edges];
+		this->out_edges = edges;
+		this->cold->out_switches = switches;
 		this->num_out_edges = n_edges;
 	} else {
 		this->out_edges = NULL;
-		this->out_switches = NULL;
+		this->cold->out_switches = NULL;
 		this->num_out_edges = UNDEFINED;
 	}
 }
@@ -279,12 +327,12 @@ short RR_Node_Base::get_span() const{
 
 /* get node resistance */
 float RR_Node_Base::get_R() const{
-	return this->R;
+	return this->cold->R;
 }
 
 /* get node capacitance */
 float RR_Node_Base::get_C() const{
-	return this->C;
+	return this->cold->C;
 }
 
 /* gets pin-track-class number of this node */
@@ -294,7 +342,7 @@ short RR_Node_Base::get_ptc_num() const{
 
 /* gets the fan-in of this node */
 short RR_Node_Base::get_fan_in() const{
-	return this->fan_in;
+	return this->cold->fan_in;
 }
 
 /* gets the number of edges emanating from this node */
@@ -302,9 +350,14 @@ short RR_Node_Base::get_num_out_edges() const{
 	return this->num_out_edges;
 }
 
+/* get the list of switches used by the edges emanating from this node */
+short *RR_Node_Base::get_out_switches() const{
+	return this->cold->out_switches;
+}
+
 /* get directionality of this node */
 e_direction RR_Node_Base::get_direction() const{
-	return this->direction;
+	return this->cold->direction;
 }
 
 /* sets the rr type of this node */
@@ -343,12 +396,12 @@ void RR_Node_Base::set_coordinates(short x1, short y1, short x2, short y2){
 
 /* set node resistance */
 void RR_Node_Base::set_R(float res){
-	this->R = res;
+	this->cold->R = res;
 }
 
 /* set node capacitance */
 void RR_Node_Base::set_C(float cap){
-	this->C = cap;
+	this->cold->C = cap;
 }
 
 /* set pin-track-class number of the node */
@@ -358,12 +411,12 @@ void RR_Node_Base::set_ptc_num(short ptc){
 
 /* set node fan-in */
 void RR_Node_Base::set_fan_in(short f){
-	this->fan_in = f;
+	this->cold->fan_in = f;
 }
 
 /* set node direction */
 void RR_Node_Base::set_direction(e_direction dir){
-	this->direction = dir;
+	this->cold->direction = dir;
 }
 
 /*==== END RR_Node_Base Class ====*/
@@ -376,61 +429,49 @@ RR_Node::RR_Node(){
 	this->num_in_edges = UNDEFINED;
 	this->weight = UNDEFINED;
 	this->in_edges = NULL;
-	this->in_switches = NULL;
 	this->clear_demand();
 
-	this->num_lb_sources_and_sinks = UNDEFINED;
-	this->path_count_history_radius = UNDEFINED;
-
 	this->virtual_source_node_ind = UNDEFINED;
+	this->original_node_ind = UNDEFINED;
+}
 
-	pthread_mutex_init(&this->my_mutex, NULL);
-
-	this->highlight = false;
-
-	this->source_sink_path_history = NULL;
+RR_Node::RR_Node(const RR_Node &obj) : RR_Node_Base(obj){
 
-	this->num_child_demand_buckets = UNDEFINED;
-	this->child_demand_contributions = NULL;
-}
+	this->is_virtual_source = false;
+	this->weight = obj.get_weight();
+	this->demand = obj.get_demand(NULL);
+	this->virtual_source_node_ind = obj.get_virtual_source_node_ind();
+	this->original_node_ind = obj.get_original_node_ind();
 
-RR_Node::~RR_Node(){
-	this->free_allocated_members();
-	pthread_mutex_destroy(&this->my_mutex);
+	/* edges are owned by the edge table, so the copy refers to the same edges */
+	this->in_edges = obj.in_edges;
+	this->num_in_edges = obj.num_in_edges;
 }
 
-RR_Node::RR_Node(const RR_Node &obj) : RR_Node_Base(obj){
+RR_Node& RR_Node::operator=(const RR_Node &obj){
+	RR_Node_Base::operator=(obj);
 
 	this->is_virtual_source = false;
-	this->num_in_edges = obj.get_num_in_edges();
 	this->weight = obj.get_weight();
 	this->demand = obj.get_demand(NULL);
-	this->num_lb_sources_and_sinks = obj.num_lb_sources_and_sinks;
 	this->virtual_source_node_ind = obj.get_virtual_source_node_ind();
-	this->num_child_demand_buckets = obj.num_child_demand_buckets;
-	pthread_mutex_init(&this->my_mutex, NULL);
-	this->highlight = obj.highlight;
-
-	//TODO: copy over source-sink path history if you still want to use that
-	this->path_count_history_radius = UNDEFINED;
+	this->original_node_ind = obj.get_original_node_ind();
 
-	this->alloc_in_edges_and_switches(obj.num_in_edges);
+	this->in_edges = obj.in_edges;
+	this->num_in_edges = obj.num_in_edges;
 
-	for (int iedge = 0; iedge < obj.num_in_edges; iedge++){
-		this->in_edges[iedge] = obj.in_edges[iedge];
-		this->in_switches[iedge] = obj.in_switches[iedge];
-	}
+	return *this;
 }
 
-/* allocate the in_edges and in_switches array and sets num_in_edges */
-void RR_Node::alloc_in_edges_and_switches(short n_edges){
+/* sets in-edge/switch lists to the specified span of an edge table, and sets num_in_edges */
+void RR_Node::set_in_edges_and_switches(int *edges, short *switches, short n_edges){
 	if (n_edges > 0){
-		this->in_edges = new int[n_edges];
-		this->in_switches = new short[n_edges];
+		this->in_edges = edges;
+		this->cold->in_switches = switches;
 		this->num_in_edges = n_edges;
 	} else {
 		this->in_edges = NULL;
-		this->in_switches = NULL;
+		this->cold->in_switches = NULL;
 		this->num_in_edges = UNDEFINED;
 	}
 }
@@ -449,31 +490,31 @@ void RR_Node::alloc_source_sink_path_history(int set_num_lb_sources_and_sinks){
 		}
 
 		/* allocate */
-		this->source_sink_path_history = new float** [history_radius+1];
+		this->cold->source_sink_path_history = new std::atomic<float>** [history_radius+1];
 		for (int iradius = 0; iradius <= history_radius; iradius++){
 			int circumference = max(1, 4*iradius);
-			this->source_sink_path_history[iradius] = new float* [circumference];
+			this->cold->source_sink_path_history[iradius] = new std::atomic<float>* [circumference];
 
 			for (int ic = 0; ic < circumference; ic++){
-				this->source_sink_path_history[iradius][ic] = new float [set_num_lb_sources_and_sinks];
+				this->cold->source_sink_path_history[iradius][ic] = new std::atomic<float> [set_num_lb_sources_and_sinks];
 
 				/* initialize elements to UNDEFINED */
 				for (int is = 0; is < set_num_lb_sources_and_sinks; is++){
-					this->source_sink_path_history[iradius][ic][is] = UNDEFINED;
+					this->cold->source_sink_path_history[iradius][ic][is] = UNDEFINED;
 				}
 			}
 		}
 
-		this->path_count_history_radius = history_radius;
-		this->num_lb_sources_and_sinks = set_num_lb_sources_and_sinks;
+		this->cold->path_count_history_radius = history_radius;
+		this->cold->num_lb_sources_and_sinks = set_num_lb_sources_and_sinks;
 	} else {
-		this->num_lb_sources_and_sinks = UNDEFINED;
+		this->cold->num_lb_sources_and_sinks = UNDEFINED;
 	}
 }
 
 void RR_Node::alloc_child_demand_contributions(int max_path_weight){
 
-	if (this->num_child_demand_buckets != UNDEFINED){
+	if (this->cold->num_child_demand_buckets != UNDEFINED){
 		//this->free_child_demand_contributions();
 		//WTHROW(EX_INIT, "Node's child demand contributions structure has already been allocated!");
 		//XXX. should not be allocating again. fix this.
@@ -484,74 +525,60 @@ void RR_Node::alloc_child_demand_contributions(int max_path_weight){
 		return;
 	}
 
-	this->child_demand_contributions = new float* [this->get_num_out_edges()];
+	this->cold->child_demand_contributions = new std::atomic<float>* [this->get_num_out_edges()];
 
 	/* allocate "max_path_weight" buckets for each outgoing edge */
 	for (short iedge = 0; iedge < this->get_num_out_edges(); iedge++){
-		this->child_demand_contributions[iedge] = new float [max_path_weight+1];
+		this->cold->child_demand_contributions[iedge] = new std::atomic<float> [max_path_weight+1];
 		for (int ibucket = 0; ibucket < max_path_weight+1; ibucket++){
-			this->child_demand_contributions[iedge][ibucket] = 0.0;
+			this->cold->child_demand_contributions[iedge][ibucket] = 0.0;
 		}
 	}
 
-	this->num_child_demand_buckets = max_path_weight+1;
+	this->cold->num_child_demand_buckets = max_path_weight+1;
 
 }
 
 void RR_Node::free_child_demand_contributions(){
-	if (this->num_child_demand_buckets != UNDEFINED){
+	if (this->cold->num_child_demand_buckets != UNDEFINED){
 		for (short iedge = 0; iedge < this->get_num_out_edges(); iedge++){
-			delete [] this->child_demand_contributions[iedge];
+			delete [] this->cold->child_demand_contributions[iedge];
 		}
 
-		delete [] this->child_demand_contributions;
-		this->child_demand_contributions = NULL;
+		delete [] this->cold->child_demand_contributions;
+		this->cold->child_demand_contributions = NULL;
 
-		this->num_child_demand_buckets = UNDEFINED;
+		this->cold->num_child_demand_buckets = UNDEFINED;
 	}
 }
 
-/* freen in-edges and switches */
-void RR_Node::free_in_edges_and_switches(){
-	if (!this->in_edges)
-		delete [] this->in_edges;
-	if (!this->in_switches)
-		delete [] this->in_switches;
-	this->in_edges = NULL;
-	this->in_switches = NULL;
-
-	this->num_in_edges = UNDEFINED;
-}
-
 /* frees allocated members. extends the parent function of the same name */
 void RR_Node::free_allocated_members(){
 	/* call the parent function */
 	RR_Node_Base::free_allocated_members();
 
-	/* free edges and switches structures */
-	this->free_in_edges_and_switches();
+	/* drop edges and switches; free demand contributions */
+	this->set_in_edges_and_switches(NULL, NULL, UNDEFINED);
 	this->free_child_demand_contributions();
 
 	/* free path count history structure */
-	if (this->path_count_history_radius > 0){
-		int radius = this->path_count_history_radius;
+	if (this->cold->path_count_history_radius > 0){
+		int radius = this->cold->path_count_history_radius;
 
 		for (int iradius = 0; iradius <= radius; iradius++){
 			int circumference = max(1, 4*iradius);
 
 			for (int ic = 0; ic < circumference; ic++){
-				delete this->source_sink_path_history[iradius][ic];
+				delete [] this->cold->source_sink_path_history[iradius][ic];
 			}
-			delete [] this->source_sink_path_history[iradius];
+			delete [] this->cold->source_sink_path_history[iradius];
 		}
-		delete [] this->source_sink_path_history;
-		this->source_sink_path_history = NULL;
+		delete [] this->cold->source_sink_path_history;
+		this->cold->source_sink_path_history = NULL;
 
-		this->path_count_history_radius = UNDEFINED;
-		this->num_lb_sources_and_sinks = UNDEFINED;
+		this->cold->path_count_history_radius = UNDEFINED;
+		this->cold->num_lb_sources_and_sinks = UNDEFINED;
 	}
-
-	pthread_mutex_destroy(&this->my_mutex);
 }
 
 /* sets node demand to 0 */
@@ -559,16 +586,46 @@ void RR_Node::clear_demand(){
 	this->demand = 0.0;
 }
 
-/* increment node demand by specified value */
+/* resets the contents of the path count history and child demand contribution structures (if allocated) */
+void RR_Node::clear_demand_history(){
+	if (this->cold->num_child_demand_buckets != UNDEFINED){
+		for (short iedge = 0; iedge < this->get_num_out_edges(); iedge++){
+			for (int ibucket = 0; ibucket < this->cold->num_child_demand_buckets; ibucket++){
+				this->cold->child_demand_contributions[iedge][ibucket] = 0.0;
+			}
+		}
+	}
+
+	if (this->cold->path_count_history_radius != UNDEFINED){
+		int radius = this->cold->path_count_history_radius;
+
+		for (int iradius = 0; iradius <= radius; iradius++){
+			int circumference = max(1, 4*iradius);
+
+			for (int ic = 0; ic < circumference; ic++){
+				for (int is = 0; is < this->cold->num_lb_sources_and_sinks; is++){
+					this->cold->source_sink_path_history[iradius][ic][is] = UNDEFINED;
+				}
+			}
+		}
+	}
+}
+
+/* increment node demand by specified value. may be called by multiple threads at once */
 void RR_Node::increment_demand(double value, float demand_multiplier){
-	pthread_mutex_lock(&this->my_mutex);
-	this->demand += value;
-	this->set_weight(demand_multiplier);
-	pthread_mutex_unlock(&this->my_mutex);
+	double new_demand = atomic_add(this->demand, value);
+
+	/* another thread may have already set the weight corresponding to a larger demand */
+	atomic_max(this->weight, this->get_weight_at_demand(new_demand, demand_multiplier));
 }
 
 /* sets weight of this node */
 void RR_Node::set_weight(float demand_multiplier){
+	this->weight.store( this->get_weight_at_demand(this->demand.load(), demand_multiplier) );
+}
+
+/* returns the weight this node would have at the specified demand */
+float RR_Node::get_weight_at_demand(double node_demand, float demand_multiplier) const{
 	/* weight of node is its wirelength usage */
 	//short x_low, y_low, x_high, y_high;
 	//x_low = this->get_xlow();
@@ -584,17 +641,20 @@ void RR_Node::set_weight(float demand_multiplier){
 
 	float my_weight = 0.0;
 	if (this->get_rr_type() == CHANX || this->get_rr_type() == CHANY){
-		my_weight = 1.0 + min(this->demand*demand_multiplier, 1.0)*((float)this->get_span());// + 1.0);
+		my_weight = 1.0 + min(node_demand*demand_multiplier, 1.0)*((float)this->get_span());// + 1.0);
 		my_weight = ceil(my_weight);
 	}
 	
-	this->weight = my_weight;
+	return my_weight;
 }
 
 /* sets the index of the virtual source node corresponding to this node. can be used for enumerating paths from non-source nodes */
 void RR_Node::set_virtual_source_node_ind(int node_ind){
 	this->virtual_source_node_ind = node_ind;
 }
+void RR_Node::set_original_node_ind(int node_ind){
+	this->original_node_ind = node_ind;
+}
 
 void RR_Node::set_is_virtual_source(bool is_virt){
 	this->is_virtual_source = is_virt;
@@ -633,11 +693,14 @@ short RR_Node::get_num_in_edges() const{
 	return this->num_in_edges;
 }
 
+/* get the list of switches used by the edges linking into this node */
+short *RR_Node::get_in_switches() const{
+	return this->cold->in_switches;
+}
+
 /* returns weight of this node */
 float RR_Node::get_weight() const{
-	//pthread_mutex_lock(&this->my_mutex);
-	float _weight = this->weight;
-	//pthread_mutex_unlock(&this->my_mutex);
+	float _weight = this->weight.load(std::memory_order_relaxed);
 	return _weight;
 }
 
@@ -645,6 +708,9 @@ float RR_Node::get_weight() const{
 int RR_Node::get_virtual_source_node_ind() const{
 	return this->virtual_source_node_ind;
 }
+int RR_Node::get_original_node_ind() const{
+	return this->original_node_ind;
+}
 
 /* increments path count history at this node due to the specified target node.
    the specified target node is either the source or sink of a connection that
@@ -681,7 +747,7 @@ float RR_Node::access_path_count_history(float increment_val, RR_Node &target_no
 
 	e_rr_type my_type = this->get_rr_type();
 	if (my_type == OPIN || my_type == IPIN /*|| my_type == CHANX || my_type == CHANY*/){		//FIXME: why was this commented out? why didn't i comment it? :(
-		int radius = this->path_count_history_radius;
+		int radius = this->cold->path_count_history_radius;
 		int my_x = this->get_xlow();
 		int my_y = this->get_ylow();
 
@@ -713,18 +779,20 @@ float RR_Node::access_path_count_history(float increment_val, RR_Node &target_no
 			}
 
 			/* perform access */
-			float path_count = this->source_sink_path_history[target_dist][arc][target_ptc];
+			std::atomic<float> &history_entry = this->cold->source_sink_path_history[target_dist][arc][target_ptc];
+			float path_count = history_entry.load(std::memory_order_relaxed);
 			if (increment){
-				if (path_count == UNDEFINED){
-					path_count = increment_val;
-				} else {
-					path_count += increment_val;
-				}
+				/* multiple threads may be incrementing path counts -- retry until the entry hasn't changed under us */
+				float new_path_count;
+				do {
+					if (path_count == UNDEFINED){
+						new_path_count = increment_val;
+					} else {
+						new_path_count = path_count + increment_val;
+					}
+				} while ( !history_entry.compare_exchange_weak(path_count, new_path_count, std::memory_order_relaxed) );
 
-				/* multiple threads may be incrementing path counts -- use mutex to synchronize */
-				pthread_mutex_lock(&this->my_mutex);
-				this->source_sink_path_history[target_dist][arc][target_ptc] = path_count;
-				pthread_mutex_unlock(&this->my_mutex);
+				path_count = new_path_count;
 			}
 			result = path_count;
 		} else {
@@ -1085,6 +1153,25 @@ void Routing_Structs::alloc_and_create_rr_node(int n_rr_nodes){
 	this->rr_node.assign(n_rr_nodes, RR_Node());
 	//this->rr_node = new RR_Node[n_rr_nodes];
 	//this->num_rr_nodes = n_rr_nodes;
+
+	/* each node gets its own cold entry */
+	this->rr_node_cold.clear();
+	this->rr_node_cold.resize(n_rr_nodes);
+	for (int inode = 0; inode < n_rr_nodes; inode++){
+		this->rr_node[inode].cold = &this->rr_node_cold[inode];
+		this->rr_node[inode].set_original_node_ind(inode);
+	}
+}
+
+/* adds an uninitialized rr node (along with its cold entry) to the end of the rr node list. returns the index of the new node */
+int Routing_Structs::add_rr_node(){
+	this->rr_node_cold.push_back(RR_Node_Cold());
+	this->rr_node.push_back(RR_Node());
+
+	int node_ind = this->get_num_rr_nodes() - 1;
+	this->rr_node[node_ind].cold = &this->rr_node_cold.back();
+	this->rr_node[node_ind].set_original_node_ind(node_ind);
+	return node_ind;
 }
 /* allocates path count history structures for each node */
 void Routing_Structs::alloc_rr_node_path_histories(int num_lb_sources_and_sinks){
@@ -1119,14 +1206,224 @@ void Routing_Structs::init_rr_node_weights(){
 	}
 }
 
+/* resets node demands and demand histories, and sets node weights back to their initial values. used to redo path enumeration
+   (i.e. with a different demand multiplier) without re-initializing the graph */
+void Routing_Structs::clear_rr_node_demands(){
+	int num_nodes = this->get_num_rr_nodes();
+
+	for (int inode = 0; inode < num_nodes; inode++){
+		this->rr_node[inode].clear_demand();
+		this->rr_node[inode].clear_demand_history();
+	}
+
+	this->init_rr_node_weights();
+}
+
 /* returns number of rr nodes */
 int Routing_Structs::get_num_rr_nodes() const{
 	return (int)this->rr_node.size();
 	//return this->num_rr_nodes;
 }
+
+/* returns the node of the same type and ptc as the specified node which is offset from it by dx/dy tiles (and spans the same
+   number of tiles). returns UNDEFINED if there is no such node */
+int Routing_Structs::get_translated_node(int node_ind, int dx, int dy) const{
+	const RR_Node &node = this->rr_node[node_ind];
+	e_rr_type rr_type = node.get_rr_type();
+
+	/* virtual sources are not in the node index -- they are found through the sinks they were created for */
+	bool is_virtual_source = node.get_is_virtual_source();
+	if (is_virtual_source){
+		rr_type = SINK;
+	}
+
+	/* sinks share the node index of sources, and opins that of ipins */
+	e_rr_type index_type = rr_type;
+	if (index_type == SINK){
+		index_type = SOURCE;
+	} else if (index_type == OPIN){
+		index_type = IPIN;
+	}
+
+	int x = node.get_xlow() + dx;
+	int y = node.get_ylow() + dy;
+	const t_rr_node_index &index = this->rr_node_index;
+	if (x < 0 || x >= (int)index[index_type].size() || y < 0 || y >= (int)index[index_type][x].size()){
+		return UNDEFINED;
+	}
+
+	const vector<int> &index_nodes = index[index_type][x][y];
+	int ptc = node.get_ptc_num();
+	if (ptc < 0 || ptc >= (int)index_nodes.size() || index_nodes[ptc] == UNDEFINED){
+		return UNDEFINED;
+	}
+
+	int translated_ind = index_nodes[ptc];
+	const RR_Node &translated_node = this->rr_node[translated_ind];
+	if (translated_node.get_rr_type() != rr_type ||
+	    translated_node.get_xlow() != node.get_xlow() + dx || translated_node.get_xhigh() != node.get_xhigh() + dx ||
+	    translated_node.get_ylow() != node.get_ylow() + dy || translated_node.get_yhigh() != node.get_yhigh() + dy){
+		return UNDEFINED;
+	}
+
+	if (is_virtual_source){
+		translated_ind = translated_node.get_virtual_source_node_ind();
+	}
+
+	return translated_ind;
+}
+
+/* renumbers the rr nodes so that node 'inode' becomes node new_node_inds[inode]. the edge tables, the rr node index and virtual
+   source links are updated to match, and the edges of each node keep their order. nodes keep their cold entries.
+   has to be called before any per-node analysis structures are allocated */
+void Routing_Structs::renumber_rr_nodes(const vector<int> &new_node_inds){
+	int num_nodes = this->get_num_rr_nodes();
+	if ((int)new_node_inds.size() != num_nodes){
+		WTHROW(EX_GRAPH, "Expected a new index for each of the " << num_nodes << " rr nodes, but got " << new_node_inds.size());
+	}
+	if (this->out_edge_table.get_num_nodes() != num_nodes || this->in_edge_table.get_num_nodes() != num_nodes){
+		WTHROW(EX_GRAPH, "The rr nodes can only be renumbered once the out- and in-edges of all nodes are known");
+	}
+
+	vector<int> old_node_inds(num_nodes, UNDEFINED);
+	for (int inode = 0; inode < num_nodes; inode++){
+		int new_ind = new_node_inds[inode];
+		if (new_ind < 0 || new_ind >= num_nodes || old_node_inds[new_ind] != UNDEFINED){
+			WTHROW(EX_GRAPH, "The new rr node indices are not a permutation of the old ones");
+		}
+		old_node_inds[new_ind] = inode;
+	}
+
+	/* move the nodes. the copy constructor doesn't carry over the virtual source flag */
+	t_rr_node renumbered_rr_node(num_nodes, RR_Node());
+	for (int inode = 0; inode < num_nodes; inode++){
+		RR_Node &node = this->rr_node[ old_node_inds[inode] ];
+		RR_Node &renumbered_node = renumbered_rr_node[inode];
+
+		renumbered_node = node;
+		renumbered_node.set_is_virtual_source( node.get_is_virtual_source() );
+		if (node.get_virtual_source_node_ind() != UNDEFINED){
+			renumbered_node.set_virtual_source_node_ind( new_node_inds[node.get_virtual_source_node_ind()] );
+		}
+	}
+	this->rr_node.swap(renumbered_rr_node);
+
+	this->out_edge_table.renumber_nodes(new_node_inds, old_node_inds);
+	this->in_edge_table.renumber_nodes(new_node_inds, old_node_inds);
+	this->link_rr_node_edges();
+
+	for (int itype = 0; itype < (int)this->rr_node_index.size(); itype++){
+		for (int ix = 0; ix < (int)this->rr_node_index[itype].size(); ix++){
+			for (int iy = 0; iy < (int)this->rr_node_index[itype][ix].size(); iy++){
+				vector<int> &index_nodes = this->rr_node_index[itype][ix][iy];
+				for (int iptc = 0; iptc < (int)index_nodes.size(); iptc++){
+					if (index_nodes[iptc] != UNDEFINED){
+						index_nodes[iptc] = new_node_inds[ index_nodes[iptc] ];
+					}
+				}
+			}
+		}
+	}
+}
+
+/* points the out/in edge lists of each rr node at its span of the edge tables. has to be called whenever
+   the edge tables are (re)allocated. nodes which are beyond the end of a table get no edges */
+void Routing_Structs::link_rr_node_edges(){
+	RR_Edge_Table &out_table = this->out_edge_table;
+	RR_Edge_Table &in_table = this->in_edge_table;
+
+	int num_nodes = this->get_num_rr_nodes();
+	int num_out_table_nodes = out_table.get_num_nodes();
+	int num_in_table_nodes = in_table.get_num_nodes();
+	for (int inode = 0; inode < num_nodes; inode++){
+		RR_Node &node = this->rr_node[inode];
+
+		if (inode < num_out_table_nodes){
+			int offset = out_table.offsets[inode];
+			node.set_out_edges_and_switches(out_table.edges.data() + offset, out_table.switches.data() + offset,
+			                                (short)out_table.get_num_node_edges(inode));
+		} else {
+			node.set_out_edges_and_switches(NULL, NULL, UNDEFINED);
+		}
+
+		if (inode < num_in_table_nodes){
+			int offset = in_table.offsets[inode];
+			node.set_in_edges_and_switches(in_table.edges.data() + offset, in_table.switches.data() + offset,
+			                               (short)in_table.get_num_node_edges(inode));
+		} else {
+			node.set_in_edges_and_switches(NULL, NULL, UNDEFINED);
+		}
+	}
+}
 /*==== END Routing_Structs Class ====*/
 
 
+/*==== RR_Edge_Table Class ====*/
+/* allocates the table based on the number of edges of each node. edge and switch entries are set to UNDEFINED */
+void RR_Edge_Table::alloc_from_edge_counts(const vector<int> &num_node_edges){
+	int num_nodes = (int)num_node_edges.size();
+
+	this->offsets.assign(num_nodes+1, 0);
+	for (int inode = 0; inode < num_nodes; inode++){
+		this->offsets[inode+1] = this->offsets[inode] + num_node_edges[inode];
+	}
+
+	this->edges.assign(this->offsets[num_nodes], UNDEFINED);
+	this->switches.assign(this->offsets[num_nodes], UNDEFINED);
+}
+
+/* adds a node with the specified edges to the end of the table */
+void RR_Edge_Table::append_node(const vector<int> &node_edges, const vector<short> &node_switches){
+	if (this->offsets.empty()){
+		this->offsets.push_back(0);
+	}
+	this->edges.insert(this->edges.end(), node_edges.begin(), node_edges.end());
+	this->switches.insert(this->switches.end(), node_switches.begin(), node_switches.end());
+	this->offsets.push_back( (int)this->edges.size() );
+}
+
+/* renumbers the nodes of the table: node 'inode' becomes node new_node_inds[inode], along with the edges that lead to it.
+   'old_node_inds' is the inverse of 'new_node_inds'. the edges of each node stay in the same order */
+void RR_Edge_Table::renumber_nodes(const vector<int> &new_node_inds, const vector<int> &old_node_inds){
+	int num_nodes = this->get_num_nodes();
+
+	vector<int> num_node_edges(num_nodes);
+	for (int inode = 0; inode < num_nodes; inode++){
+		num_node_edges[inode] = this->get_num_node_edges( old_node_inds[inode] );
+	}
+
+	RR_Edge_Table renumbered;
+	renumbered.alloc_from_edge_counts(num_node_edges);
+	for (int inode = 0; inode < num_nodes; inode++){
+		int from_offset = this->offsets[ old_node_inds[inode] ];
+		int to_offset = renumbered.offsets[inode];
+		for (int iedge = 0; iedge < num_node_edges[inode]; iedge++){
+			renumbered.edges[to_offset + iedge] = new_node_inds[ this->edges[from_offset + iedge] ];
+			renumbered.switches[to_offset + iedge] = this->switches[from_offset + iedge];
+		}
+	}
+
+	this->swap(renumbered);
+}
+
+void RR_Edge_Table::swap(RR_Edge_Table &other){
+	this->offsets.swap(other.offsets);
+	this->edges.swap(other.edges);
+	this->switches.swap(other.switches);
+}
+
+int RR_Edge_Table::get_num_nodes() const{
+	return max(0, (int)this->offsets.size() - 1);
+}
+int RR_Edge_Table::get_num_edges() const{
+	return (int)this->edges.size();
+}
+int RR_Edge_Table::get_num_node_edges(int node_ind) const{
+	return this->offsets[node_ind+1] - this->offsets[node_ind];
+}
+/*==== END RR_Edge_Table Class ====*/
+
+
 
 /*==== SS_Distances Class ====*/
 SS_Distances::SS_Distances(){
@@ -1249,17 +1546,267 @@ bool SS_Distances::is_legal(int my_node_weight, int max_path_weight) const{
 /*==== END SS_Distances Class ====*/
 
 
+
+/*==== SS_Distances_Vector Class ====*/
+SS_Distances_Vector::SS_Distances_Vector(){
+	this->shared_source_epoch = 1;
+}
+
+SS_Distances_Vector::SS_Distances_Vector(int num_entries){
+	this->shared_source_epoch = 1;
+	this->assign(num_entries);
+}
+
+/* sets the vector to 'num_entries' cleared entries, with no shared source distances */
+void SS_Distances_Vector::assign(int num_entries){
+	My_Epoch_Vector<SS_Distances>::assign(num_entries, SS_Distances());
+	this->shared_source_distances.assign(num_entries, UNDEFINED);
+	this->shared_source_epochs.assign(num_entries, 0);
+	this->shared_source_epoch = 1;
+}
+
+/* forgets all shared source distances */
+void SS_Distances_Vector::reset_shared_source_distances(){
+	this->shared_source_epoch++;
+
+	if (this->shared_source_epoch == 0){
+		/* the epoch counter wrapped around (see My_Epoch_Vector::reset) */
+		this->shared_source_epochs.assign(this->shared_source_distances.size(), 0);
+		this->shared_source_epoch = 1;
+	}
+}
+
+/* sets the shared source distance of the specified node */
+void SS_Distances_Vector::set_shared_source_distance(int ind, int distance){
+	this->shared_source_distances[ind] = distance;
+	this->shared_source_epochs[ind] = this->shared_source_epoch;
+}
+
+/* returns the shared source distance of the specified node, or UNDEFINED if it hasn't been set */
+int SS_Distances_Vector::get_shared_source_distance(int ind) const{
+	int distance = UNDEFINED;
+	if (this->shared_source_epochs[ind] == this->shared_source_epoch){
+		distance = this->shared_source_distances[ind];
+	}
+	return distance;
+}
+
+/* resets the specified entry to the shared source distance of its node, if any */
+void SS_Distances_Vector::reset_entry(int ind){
+	SS_Distances &entry = this->entries[ind];
+	entry.clear();
+
+	int shared_distance = this->get_shared_source_distance(ind);
+	if (shared_distance != UNDEFINED){
+		entry.set_source_distance(shared_distance);
+		entry.set_visited_from_source(true);
+	}
+
+	this->entry_epochs[ind] = this->epoch;
+}
+/*==== END SS_Distances_Vector Class ====*/
+
+
+
+/*==== Distance_Cache_Key Class ====*/
+bool Distance_Cache_Key::operator==(const Distance_Cache_Key &obj) const{
+	return (this->source_ind == obj.source_ind && this->sink_ind == obj.sink_ind && this->max_path_weight == obj.max_path_weight &&
+	        this->weight_snapshot == obj.weight_snapshot);
+}
+
+size_t Distance_Cache_Key_Hash::operator()(const Distance_Cache_Key &key) const{
+	size_t result = (size_t)key.weight_snapshot;
+	result = result*31 + (size_t)key.source_ind;
+	result = result*31 + (size_t)key.sink_ind;
+	result = result*31 + (size_t)key.max_path_weight;
+	return result;
+}
+/*==== END Distance_Cache_Key Class ====*/
+
+
+
+/*==== Distance_Field Class ====*/
+Distance_Field::Distance_Field(){
+	this->reachable = false;
+	this->adjusted_max_path_weight = UNDEFINED;
+	this->source_sink_dist = UNDEFINED;
+	this->has_hops = false;
+}
+
+/* returns roughly how many bytes of memory this field takes up */
+size_t Distance_Field::get_num_bytes() const{
+	return sizeof(Distance_Field) + this->node_inds.capacity()*sizeof(int) + this->node_distances.capacity()*sizeof(SS_Distances);
+}
+/*==== END Distance_Field Class ====*/
+
+
+
+/*==== Distance_Cache Class ====*/
+Distance_Cache::Distance_Cache(){
+	this->max_bytes = 0;
+	this->num_bytes = 0;
+	this->weight_snapshot = 0;
+	this->current_field = NULL;
+	this->num_lookups = 0;
+	this->num_hits = 0;
+}
+
+/* sets the size limit of the cache. a limit of 0 disables it */
+void Distance_Cache::set_max_bytes(size_t bytes){
+	this->max_bytes = bytes;
+	this->evict();
+}
+
+bool Distance_Cache::is_enabled() const{
+	return (this->max_bytes > 0);
+}
+
+/* sets the snapshot ID of the node weights with which connections will be analyzed from now on */
+void Distance_Cache::set_weight_snapshot(unsigned long long snapshot){
+	this->weight_snapshot = snapshot;
+	this->current_field = NULL;
+}
+
+/* returns the key of the specified connection at the current node weights */
+Distance_Cache_Key Distance_Cache::get_key(int source_ind, int sink_ind, int max_path_weight) const{
+	Distance_Cache_Key key;
+	key.source_ind = source_ind;
+	key.sink_ind = sink_ind;
+	key.max_path_weight = max_path_weight;
+	key.weight_snapshot = this->weight_snapshot;
+	return key;
+}
+
+/* returns whether the fields of the specified connection are in the cache */
+bool Distance_Cache::contains(int source_ind, int sink_ind, int max_path_weight) const{
+	return (this->field_map.count( this->get_key(source_ind, sink_ind, max_path_weight) ) > 0);
+}
+
+/* looks up the fields of the specified connection, copying them into 'ss_distances' on a hit. returns NULL on a miss */
+Distance_Field* Distance_Cache::restore(int source_ind, int sink_ind, int max_path_weight, t_ss_distances &ss_distances){
+	this->num_lookups++;
+	this->current_field = NULL;
+
+	t_field_map::iterator it = this->field_map.find( this->get_key(source_ind, sink_ind, max_path_weight) );
+	if (it == this->field_map.end()){
+		return NULL;
+	}
+	this->num_hits++;
+
+	/* move the field to the front of the list */
+	this->fields.splice(this->fields.begin(), this->fields, it->second);
+	Distance_Field &field = this->fields.front();
+
+	int num_entries = (int)field.node_inds.size();
+	for (int ientry = 0; ientry < num_entries; ientry++){
+		ss_distances[ field.node_inds[ientry] ] = field.node_distances[ientry];
+	}
+
+	this->current_field = &field;
+	return &field;
+}
+
+/* stores the fields of the specified connection */
+void Distance_Cache::store(int source_ind, int sink_ind, int max_path_weight, bool reachable, int adjusted_max_path_weight, int source_sink_dist,
+			const std::vector<int> &node_inds, t_ss_distances &ss_distances){
+
+	Distance_Cache_Key key = this->get_key(source_ind, sink_ind, max_path_weight);
+
+	/* replace any field already stored under this key */
+	t_field_map::iterator it = this->field_map.find(key);
+	if (it != this->field_map.end()){
+		this->num_bytes -= it->second->get_num_bytes();
+		this->fields.erase(it->second);
+		this->field_map.erase(it);
+	}
+
+	this->fields.push_front( Distance_Field() );
+	Distance_Field &field = this->fields.front();
+	field.key = key;
+	field.reachable = reachable;
+	field.adjusted_max_path_weight = adjusted_max_path_weight;
+	field.source_sink_dist = source_sink_dist;
+
+	if (reachable){
+		int num_nodes = (int)node_inds.size();
+		for (int inode = 0; inode < num_nodes; inode++){
+			int node_ind = node_inds[inode];
+			SS_Distances &entry = ss_distances[node_ind];
+			if (entry.get_visited_from_sink()){
+				field.node_inds.push_back(node_ind);
+				field.node_distances.push_back(entry);
+			}
+		}
+		field.node_inds.shrink_to_fit();
+		field.node_distances.shrink_to_fit();
+	}
+
+	this->field_map[key] = this->fields.begin();
+	this->num_bytes += field.get_num_bytes();
+	this->current_field = &field;
+
+	this->evict();
+}
+
+/* copies the source/sink hops that have been found for the current field's nodes from 'ss_distances' */
+void Distance_Cache::store_hops(t_ss_distances &ss_distances){
+	Distance_Field *field = this->current_field;
+	if (field == NULL){
+		return;
+	}
+
+	int num_entries = (int)field->node_inds.size();
+	for (int ientry = 0; ientry < num_entries; ientry++){
+		field->node_distances[ientry] = ss_distances[ field->node_inds[ientry] ];
+	}
+	field->has_hops = true;
+}
+
+/* drops least recently used fields until the cache fits its size limit */
+void Distance_Cache::evict(){
+	while (this->num_bytes > this->max_bytes && !this->fields.empty()){
+		Distance_Field &field = this->fields.back();
+		if (&field == this->current_field){
+			this->current_field = NULL;
+		}
+		this->num_bytes -= field.get_num_bytes();
+		this->field_map.erase(field.key);
+		this->fields.pop_back();
+	}
+}
+
+Distance_Field* Distance_Cache::get_current_field(){
+	return this->current_field;
+}
+
+long Distance_Cache::get_num_lookups() const{
+	return this->num_lookups;
+}
+
+long Distance_Cache::get_num_hits() const{
+	return this->num_hits;
+}
+
+void Distance_Cache::reset_stats(){
+	this->num_lookups = 0;
+	this->num_hits = 0;
+}
+/*==== END Distance_Cache Class ====*/
+
+
 /*==== Node_Waiting Class ====*/
 
 Node_Waiting::Node_Waiting(){
 	this->node_ind = UNDEFINED;
+	this->original_node_ind = UNDEFINED;
 	this->path_weight = UNDEFINED;
 	this->source_dist = UNDEFINED;
 }
 
 /* set methods */
-void Node_Waiting::set( int set_ind, int set_path_weight, int set_source_dist ){
+void Node_Waiting::set( int set_ind, int set_original_ind, int set_path_weight, int set_source_dist ){
 	this->node_ind = set_ind;
+	this->original_node_ind = set_original_ind;
 	this->path_weight = set_path_weight;
 	this->source_dist = set_source_dist;
 }
@@ -1267,11 +1814,12 @@ void Node_Waiting::set( int set_ind, int set_path_weight, int set_source_dist ){
 /* clears variables */
 void Node_Waiting::clear(){
 	this->node_ind = UNDEFINED;
+	this->original_node_ind = UNDEFINED;
 	this->path_weight = UNDEFINED;
 	this->source_dist = UNDEFINED;
 }
 
-/* returns index of node that this structure is associated with -- used as a tertiary sort to the cycle-breaking structure */
+/* returns index of node that this structure is associated with */
 int Node_Waiting::get_node_ind() const{
 	return this->node_ind;
 }
@@ -1290,7 +1838,7 @@ int Node_Waiting::get_source_distance() const{
 bool Node_Waiting::operator < (const Node_Waiting &obj) const{
 	bool result;
 	
-	/* primary sorting based on path_weight, secondary on source distance, tertiary on node index */
+	/* primary sorting based on path_weight, secondary on source distance, tertiary on original node index */
 	if (this->path_weight > obj.get_path_weight()){
 		result = true;
 	} else {
@@ -1299,7 +1847,7 @@ bool Node_Waiting::operator < (const Node_Waiting &obj) const{
 				result = true;
 			} else {
 				if (this->source_dist == obj.get_source_distance()){
-					if (this->node_ind < obj.get_node_ind()){
+					if (this->original_node_ind < obj.original_node_ind){
 						result = true;
 					} else {
 						result = false;
@@ -1319,56 +1867,91 @@ bool Node_Waiting::operator < (const Node_Waiting &obj) const{
 /*==== END Node_Waiting Class ====*/
 
 
-/*==== Node_Buckets Class ====*/
-Node_Buckets::Node_Buckets(){
-	this->num_source_buckets = UNDEFINED;
-	this->num_sink_buckets = UNDEFINED;
-	this->source_buckets = NULL;
-	this->sink_buckets = NULL;
+/*==== Bucket_Arena Class ====*/
+Bucket_Arena::Bucket_Arena(){
+	this->current_block = 0;
+	this->current_offset = 0;
 }
 
-Node_Buckets::~Node_Buckets(){
-	delete [] this->source_buckets;
-	delete [] this->sink_buckets;
-	this->source_buckets = NULL;
-	this->sink_buckets = NULL;
-	this->num_source_buckets = UNDEFINED;
-	this->num_sink_buckets = UNDEFINED;
+/* returns 'num_bytes' of memory aligned for any bucket type */
+char* Bucket_Arena::alloc_bytes(size_t num_bytes){
+	/* keep every array aligned to the largest bucket type */
+	num_bytes = (num_bytes + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+
+	/* move on to the next block if there isn't enough room left in the current one */
+	while (this->current_block < (int)this->blocks.size() &&
+	       this->current_offset + num_bytes > this->blocks[this->current_block].size()){
+		this->current_block++;
+		this->current_offset = 0;
+	}
+
+	/* all blocks are in use -- get a new one */
+	if (this->current_block == (int)this->blocks.size()){
+		this->blocks.push_back( vector<char>( max((size_t)BUCKET_ARENA_BLOCK_SIZE, num_bytes) ) );
+	}
+
+	char *bytes = this->blocks[this->current_block].data() + this->current_offset;
+	this->current_offset += num_bytes;
+
+	return bytes;
+}
+
+/* returns an array of 'num_entries' values of type T, each set to 'init_value' */
+template <typename T> T* Bucket_Arena::alloc(int num_entries, T init_value){
+	T *entries = (T*)this->alloc_bytes(num_entries * sizeof(T));
+
+	for (int ientry = 0; ientry < num_entries; ientry++){
+		entries[ientry] = init_value;
+	}
+
+	return entries;
+}
+
+/* releases all arrays allocated so far (the underlying blocks are kept) */
+void Bucket_Arena::release(){
+	this->current_block = 0;
+	this->current_offset = 0;
 }
+/* IMPORTANT: this function will only work for types explicitely specified in below templates */
+template double* Bucket_Arena::alloc<double>(int num_entries, double init_value);
+template float* Bucket_Arena::alloc<float>(int num_entries, float init_value);
+/*==== END Bucket_Arena Class ====*/
 
-Node_Buckets::Node_Buckets(int max_path_weight_bound){
+
+/*==== Node_Buckets Class ====*/
+template <typename T> Node_Buckets<T>::Node_Buckets(){
 	this->num_source_buckets = UNDEFINED;
 	this->num_sink_buckets = UNDEFINED;
-
-	this->alloc_source_sink_buckets(max_path_weight_bound+1, max_path_weight_bound+1);	//[0..max_path_weight+bound]
+	this->source_buckets = NULL;
+	this->sink_buckets = NULL;
+	this->multiplier_buckets = NULL;
 }
 
-/* allocates the specified number of source and sink buckets */
-void Node_Buckets::alloc_source_sink_buckets(int set_num_source_buckets, int set_num_sink_buckets){
+/* allocates the specified number of source and sink buckets from the specified arena */
+template <typename T> void Node_Buckets<T>::alloc_source_sink_buckets(Bucket_Arena &arena, int set_num_source_buckets, int set_num_sink_buckets){
 	if (set_num_source_buckets != set_num_sink_buckets){
 		WTHROW(EX_INIT, "number of source and sink buckets is expected to be equal");
 	}
 
-	this->source_buckets = new double[set_num_source_buckets];
-	this->sink_buckets = new double[set_num_sink_buckets];
-
-	/* initialize to 0 */
-	for (int ibucket = 0; ibucket < set_num_source_buckets; ibucket++){
-		this->source_buckets[ibucket] = UNDEFINED;
-		this->sink_buckets[ibucket] = UNDEFINED;
-	}
+	/* initialize to 0 (no paths) */
+	this->source_buckets = arena.alloc<T>(set_num_source_buckets, 0);
+	this->sink_buckets = arena.alloc<T>(set_num_sink_buckets, 0);
 
 	this->num_source_buckets = set_num_source_buckets;
 	this->num_sink_buckets = set_num_sink_buckets;
 }
 
-/* deallocate memory for bucket structures */
-void Node_Buckets::free_source_sink_buckets(){
-	//TODO: does this never get called?
-	delete [] this->source_buckets;
-	delete [] this->sink_buckets;
+/* allocates 'num_multipliers' multiplier buckets for each source bucket from the specified arena. the source/sink
+   buckets must already be allocated */
+template <typename T> void Node_Buckets<T>::alloc_multiplier_buckets(Bucket_Arena &arena, int num_multipliers){
+	this->multiplier_buckets = arena.alloc<T>(this->num_source_buckets * num_multipliers, 0);
+}
+
+/* detaches the bucket structures from their memory (which is released along with the rest of the arena it came from) */
+template <typename T> void Node_Buckets<T>::free_source_sink_buckets(){
 	this->source_buckets = NULL;
 	this->sink_buckets = NULL;
+	this->multiplier_buckets = NULL;
 
 	this->num_source_buckets = 0;
 	this->num_sink_buckets = 0;
@@ -1376,124 +1959,91 @@ void Node_Buckets::free_source_sink_buckets(){
 }
 
 /* resets all bucket entries to 0 */
-void Node_Buckets::clear(){
+template <typename T> void Node_Buckets<T>::clear(){
 	for (int i = 0; i < this->num_source_buckets; i++){
-		this->source_buckets[i] = UNDEFINED;
+		this->source_buckets[i] = 0;
 	}
 
 	for (int i = 0; i < this->num_sink_buckets; i++){
-		this->sink_buckets[i] = UNDEFINED;
+		this->sink_buckets[i] = 0;
 	}
 }
 
 /* resets all bucket entries up to and including the index specified to 0 */
-void Node_Buckets::clear_up_to(int max_ind){
+template <typename T> void Node_Buckets<T>::clear_up_to(int max_ind){
 	for (int i = 0; i <= max_ind; i++){
-		this->source_buckets[i] = UNDEFINED;
+		this->source_buckets[i] = 0;
 	}
 
 	for (int i = 0; i <= max_ind; i++){
-		this->sink_buckets[i] = UNDEFINED;
+		this->sink_buckets[i] = 0;
 	}
 }
 
 /* sets the mode of the node buckets */
-void Node_Buckets::set_bucket_mode(e_bucket_mode mode){
+template <typename T> void Node_Buckets<T>::set_bucket_mode(e_bucket_mode mode){
 	this->bucket_mode = mode;
 }
 
 
 /* returns number of buckets associated with connections to source */
-int Node_Buckets::get_num_source_buckets() const{
+template <typename T> int Node_Buckets<T>::get_num_source_buckets() const{
 	return this->num_source_buckets;
 }
 
 /* returns number of buckets associated with connections to sink */
-int Node_Buckets::get_num_sink_buckets() const{
+template <typename T> int Node_Buckets<T>::get_num_sink_buckets() const{
 	return this->num_sink_buckets;
 }
 
 /* returns the mode of the node buckets */
-e_bucket_mode Node_Buckets::get_bucket_mode() const{
+template <typename T> e_bucket_mode Node_Buckets<T>::get_bucket_mode() const{
 	return this->bucket_mode;
 }
 
 
 /* returns number of legal paths which go through the node associated with this structure */
-float Node_Buckets::get_num_paths(int my_node_weight, int my_dist_to_source, int max_path_weight ) const{
+template <typename T> float Node_Buckets<T>::get_num_paths(int my_node_weight, int my_dist_to_source, int max_path_weight ) const{
 
 	float paths_through_node = 0;
 
 	float incremental_sink_paths = 0;
 	int next_j = my_node_weight + 1;
 
-	if (next_j >= this->num_sink_buckets){
-		WTHROW(EX_PATH_ENUM, "Out of bounds: " << " next_j: " << next_j << " sink_buckets: " << this->num_sink_buckets);
+	/* the loop below reads source buckets max_path_weight..my_dist_to_source and sink buckets up to last_j */
+	int last_j = next_j + max_path_weight - my_dist_to_source;
+	if (next_j >= this->num_sink_buckets || (max_path_weight >= my_dist_to_source && last_j >= this->num_sink_buckets)){
+		WTHROW(EX_PATH_ENUM, "Out of bounds: " << " next_j: " << max(next_j, last_j) << " sink_buckets: " << this->num_sink_buckets);
+	}
+	if (max_path_weight >= my_dist_to_source && max_path_weight >= this->num_source_buckets){
+		WTHROW(EX_PATH_ENUM, "Out of bounds: " << " i: " << max_path_weight << " source_buckets: " << this->num_source_buckets);
 	}
 
 	for (int j = 0; j < next_j; j++){
-		if (this->sink_buckets[j] != UNDEFINED){
-			incremental_sink_paths += this->sink_buckets[j];
-		}
+		incremental_sink_paths += this->sink_buckets[j];
 	}
 
 	for (int i = max_path_weight; i >= my_dist_to_source; i--){
-		if (next_j >= this->num_sink_buckets){
-			WTHROW(EX_PATH_ENUM, "Out of bounds: " << " next_j: " << next_j << " sink_buckets: " << this->num_sink_buckets);
-		}
-		if (i >= this->num_source_buckets){
-			WTHROW(EX_PATH_ENUM, "Out of bounds: " << " i: " << i << " source_buckets: " << this->num_source_buckets);
-		}
-
-		if (this->source_buckets[i] != UNDEFINED){
-			paths_through_node += this->source_buckets[i] * incremental_sink_paths;
-		}
-		if (this->sink_buckets[next_j] != UNDEFINED){
-			incremental_sink_paths += this->sink_buckets[next_j];
-		}
+		paths_through_node += this->source_buckets[i] * incremental_sink_paths;
+		incremental_sink_paths += this->sink_buckets[next_j];
 		next_j++;
 	}
 
 	return paths_through_node;
 }
-
-
-/* returns the probability of this node being unreachable from source (the node structures must contain probabilities instead of path counts) */
-float Node_Buckets::get_probability_not_reachable(int my_node_weight, float my_node_demand) const{
-	float probability_unreachable = 1;
-
-	/* the probability of the node being unreachable from source is the probability that none of its incoming paths are available
-	   OR this node is unavailable. The incoming paths are assumed to all be independent of eachother; this is really not the case
-	   because many paths share the same nodes upstream -- remains to be seen if this assumption is OK */
-
-	/* AND bucket probabilities */
-	for (int ibucket = my_node_weight; ibucket < this->num_source_buckets; ibucket++){
-		if (this->source_buckets[ibucket] != UNDEFINED){
-			probability_unreachable *= this->source_buckets[ibucket];
-		}
-	}
-
-	my_node_demand = min(1.0F, my_node_demand);
-
-	/* OR with the probability of this node being unavailable */
-	probability_unreachable = probability_unreachable + my_node_demand - (probability_unreachable * my_node_demand);
-
-	return probability_unreachable;
-}
+/* IMPORTANT: the Node_Buckets class will only work for types explicitely specified in below templates */
+template class Node_Buckets<double>;
+template class Node_Buckets<float>;
 /*==== END Node_Buckets Class ====*/
 	
 
 /*==== Node_Topological_Info Class ====*/
 Node_Topological_Info::Node_Topological_Info(){
+	this->demand_discounts = NULL;
 	this->clear();
-	pthread_mutex_init(&this->my_mutex, NULL);
-}
-
-Node_Topological_Info::~Node_Topological_Info(){
-	pthread_mutex_destroy(&this->my_mutex);
 }
 
-/* resets variables. does not deallocate node buckets structure (only clears contents) */
+/* resets variables. does not touch the bucket arrays (a node is handed fresh arrays for each connection, see Node_Topo_Inf_Vector) */
 void Node_Topological_Info::clear(){
 	this->times_visited_from_source = 0;
 	this->times_visited_from_sink = 0;
@@ -1507,11 +2057,6 @@ void Node_Topological_Info::clear(){
 	this->was_visited = false;
 
 	this->node_waiting_info.clear();
-	this->buckets.clear();
-
-	for (int ibucket = 0; ibucket < (int)this->demand_discounts.size(); ibucket++){
-		this->demand_discounts[ibucket] = 0.0;
-	}
 }
 
 /* sets whether this node has has already been placed onto expansion queue for a traversal from source */
@@ -1657,3 +2202,78 @@ short Node_Topological_Info::get_num_legal_nodes(int *edge_list, int num_edges,
 	return num_legal_nodes;	
 }
 /*==== END Node_Topological_Info Class ====*/
+
+
+/*==== Node_Topo_Inf_Vector Class ====*/
+Node_Topo_Inf_Vector::Node_Topo_Inf_Vector(){
+	this->num_buckets = 0;
+	this->use_float_buckets = false;
+	this->num_multipliers = 0;
+	this->use_demand_discounts = false;
+}
+
+Node_Topo_Inf_Vector::Node_Topo_Inf_Vector(int num_entries){
+	this->num_buckets = 0;
+	this->use_float_buckets = false;
+	this->num_multipliers = 0;
+	this->use_demand_discounts = false;
+	this->assign(num_entries);
+}
+
+/* sets the vector to 'num_entries' entries, none of which have been accessed yet */
+void Node_Topo_Inf_Vector::assign(int num_entries){
+	My_Epoch_Vector<Node_Topological_Info>::assign(num_entries, Node_Topological_Info());
+
+	/* entries get their bucket arrays on first access */
+	this->reset();
+}
+
+/* sets which per-bucket arrays, other than the source/sink buckets, are handed to each node */
+void Node_Topo_Inf_Vector::set_bucket_options(int set_num_multipliers, bool set_use_demand_discounts){
+	this->num_multipliers = set_num_multipliers;
+	this->use_demand_discounts = set_use_demand_discounts;
+}
+
+/* sets the number (and precision) of source/sink buckets handed to nodes first accessed from now on */
+void Node_Topo_Inf_Vector::set_num_buckets(int set_num_buckets, bool set_use_float_buckets){
+	if (set_num_buckets <= 0){
+		WTHROW(EX_PATH_ENUM, "Expected a positive number of node buckets. Got: " << set_num_buckets);
+	}
+	this->num_buckets = set_num_buckets;
+	this->use_float_buckets = set_use_float_buckets;
+}
+
+/* starts a new connection. all entries will read as cleared, and all bucket arrays are released */
+void Node_Topo_Inf_Vector::reset(){
+	My_Epoch_Vector<Node_Topological_Info>::reset();
+	this->arena.release();
+}
+
+/* resets the specified entry and hands it fresh bucket arrays */
+void Node_Topo_Inf_Vector::reset_entry(int ind){
+	Node_Topological_Info &entry = this->entries[ind];
+	entry.clear();
+
+	/* only the buckets of the precision used during this connection are allocated */
+	if (this->use_float_buckets){
+		entry.buckets.free_source_sink_buckets();
+		entry.float_buckets.alloc_source_sink_buckets(this->arena, this->num_buckets, this->num_buckets);
+		if (this->num_multipliers > 0){
+			entry.float_buckets.alloc_multiplier_buckets(this->arena, this->num_multipliers);
+		}
+	} else {
+		entry.float_buckets.free_source_sink_buckets();
+		entry.buckets.alloc_source_sink_buckets(this->arena, this->num_buckets, this->num_buckets);
+		if (this->num_multipliers > 0){
+			entry.buckets.alloc_multiplier_buckets(this->arena, this->num_multipliers);
+		}
+	}
+
+	entry.demand_discounts = NULL;
+	if (this->use_demand_discounts){
+		entry.demand_discounts = this->arena.alloc<double>(this->num_buckets, 0.0);
+	}
+
+	this->entry_epochs[ind] = this->epoch;
+}
+/*==== END Node_Topo_Inf_Vector Class ====*/
@@ -3,6 +3,10 @@
 
 #include <string>
 #include <vector>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <atomic>
 #include <cmath>
 #include "wotan_util.h"
 #include <pthread.h>
@@ -17,6 +21,9 @@
 /* a define for comparing whether two probabilities are equal */
 #define PROBS_EQUAL(f1, f2) (std::fabs(f1 - f2) <= FLOAT_PROB_TOL ? true : false)
 
+/* the size, in bytes, of each of the blocks from which a Bucket_Arena carves out bucket arrays */
+#define BUCKET_ARENA_BLOCK_SIZE 524288
+
 
 
 /**** Enums ****/
@@ -64,6 +71,13 @@ enum e_traversal_dir{
 			- grid entries
 			- rr node indices
 
+	RR_STRUCTS_VPR_XML -- an rr graph XML file written by newer versions of VPR (--write_rr_graph). Should include:
+			- rr nodes and rr edges
+			- switches
+			- block types
+			- grid locations
+			(rr node indices are derived from the nodes)
+
 	RR_STRUCTS_SIMPLE -- indicates a simple one-source/one-sink graph. Should include lists of:
 			- rr nodes
 */
@@ -71,6 +85,7 @@ enum e_rr_structs_mode{
 	RR_STRUCTS_UNDEFINED = 0,
 	RR_STRUCTS_VPR,
 	RR_STRUCTS_SIMPLE,
+	RR_STRUCTS_VPR_XML,
 	NUM_RR_STRUCTS_MODES
 };
 extern const std::string g_rr_structs_mode_string[NUM_RR_STRUCTS_MODES];
@@ -107,17 +122,45 @@ enum e_self_congestion_mode{
 	MODE_PATH_DEPENDENCE
 };
 
+/* the floating point type in which the probability analysis keeps node bucket probabilities. path enumeration always uses double */
+enum e_bucket_precision{
+	PRECISION_DOUBLE = 0,	/* double-precision buckets */
+	PRECISION_FLOAT,	/* single-precision buckets, which halves the bucket memory traffic of the probability analysis */
+	PRECISION_COMPARE	/* single-precision buckets, but each connection is also analyzed with double-precision buckets and the
+				   differences are reported */
+};
+
+/* the instruction set used by the kernels that operate on node bucket arrays (see bucket_kernels.h) */
+enum e_bucket_kernels{
+	KERNELS_AUTO = 0,	/* the widest instruction set supported by the CPU */
+	KERNELS_SCALAR,
+	KERNELS_AVX2,
+	KERNELS_AVX512
+};
+
+/* the order in which the sources of the test tiles are handed to the threads that analyze their connections */
+enum e_task_order{
+	TASK_ORDER_ROW = 0,	/* tiles in row-major order. sources are dealt out to the threads round-robin */
+	TASK_ORDER_HILBERT	/* tiles in the order of a Hilbert curve over the grid. each thread gets a contiguous block of sources, so
+				   consecutive connections of a thread start from nearby tiles and go through many of the same nodes */
+};
+
 
 /**** Forward Declarations ****/
 class RR_Node;
+class RR_Edge_Table;
 class Physical_Type_Descriptor;
 class RR_Switch_Inf;
 class Grid_Tile;
 class Arch_Structs;
 class Routing_Structs;
 class SS_Distances;
-class Node_Buckets;
+class SS_Distances_Vector;
+class Distance_Cache;
+class Bucket_Arena;
+template <typename T> class Node_Buckets;
 class Node_Topological_Info;
+class Node_Topo_Inf_Vector;
 
 
 /**** Typedefs ****/
@@ -144,11 +187,13 @@ typedef std::vector< std::vector< std::vector< std::vector<int> > > > t_rr_node_
 /* a chanwidth value for each x/y coordinate */
 typedef std::vector< std::vector< int > > t_chanwidth;
 
-/* for keeping track of the distance from a given node to a source/sink for which path enumeration is being performed */
-typedef std::vector< SS_Distances > t_ss_distances;
+/* for keeping track of the distance from a given node to a source/sink for which path enumeration is being performed.
+   reset (lazily) after each connection, except for distances from a source that are shared by several of its connections */
+typedef SS_Distances_Vector t_ss_distances;
 
-/* topological traversal info structures for each node */
-typedef std::vector< Node_Topological_Info > t_node_topo_inf;
+/* topological traversal info structures for each node. reset (lazily) after each connection, and the bucket arrays of a node
+   are only allocated once it is accessed during a connection */
+typedef Node_Topo_Inf_Vector t_node_topo_inf;
 
 
 /**** Classes ****/
@@ -158,18 +203,47 @@ public:
 	bool nodisp;				/* specifies whether to do graphics or not */
 	e_rr_structs_mode rr_structs_mode;	/* Wotan's routing structures are read-in according to this mode */
 	std::string rr_structs_file;		/* path to file from which rr structures are to be read */
+	std::string rr_graph_cache_file;	/* if not empty, path to a binary rr graph cache that is loaded in place of (or written after) parsing the rr structs file */
 	int max_connection_length;		/* maximum connection length to be considered during path enumeration */
 	bool analyze_core;			/* reachability analysis will only be performed for a core region of the FPGA */ //TODO: defined as what?
+	bool tile_symmetry;			/* paths are only enumerated from one tile of each class of test tiles whose surroundings in the rr graph
+						   are identical up to translation; the resulting demands are replicated to the other tiles of the class */
 
 	float use_routing_node_demand;		/* if not UNDEFINED, then demand for routing nodes (CHANX/CHANY) will be considered to be whatever is specified here.
 						   demand for all non-routing nodes will be considered to be 0 */
 
 	int num_threads;			/* number of threads to use for path enumeration & probability analysis */
 
+	int enumerate_rounds;			/* if not UNDEFINED, path enumeration is performed in this many rounds. node weights are fixed during a round and
+						   node demands are merged in a fixed order after each round, so that results don't depend on the number of threads */
+
 	float target_reliability; 		/* if not UNDEFINED, Wotan will search for a demand multiplier that results in the specified value of reliability */
+	float search_tolerance;			/* the search for the above demand multiplier stops once reliability is within this much of the target */
+	float search_start_multiplier;		/* if not UNDEFINED, the demand multiplier search starts here (i.e. at the result for a similar architecture) */
+	float search_min_multiplier;		/* if not UNDEFINED, the demand multiplier search doesn't go below this multiplier */
+	float search_max_multiplier;		/* if not UNDEFINED, the demand multiplier search doesn't go above this multiplier */
+	int search_max_tries;			/* maximum number of analyses performed by the demand multiplier search */
+	std::vector<double> demand_multiplier_list;	/* if not empty, the routability metric is also computed at each of these demand multipliers, from the same
+							   path enumeration and probability traversals as the run at 'demand_multiplier' */
 
 	e_self_congestion_mode self_congestion_mode;	/* method for dealing with self-congestion effects. see comment on enum */
 
+	e_bucket_precision bucket_precision;	/* precision of the node buckets used during probability analysis. see comment on enum */
+	e_bucket_kernels bucket_kernels;	/* instruction set of the node bucket kernels. see comment on enum */
+
+	bool share_source_distances;		/* if true, the connections of a source share one forward traversal that finds node distances from the
+						   source, instead of each connection doing its own. only used while node weights are fixed (probability
+						   analysis, and path enumeration in rounds) */
+	int distance_cache_mb;			/* if > 0, each thread keeps the distance fields of up to this many megabytes worth of connections, so that
+						   they don't have to be found again if a connection is analyzed with the same node weights (see Distance_Cache).
+						   if UNDEFINED, a default size is used in the modes where connections are analyzed again */
+	e_task_order task_order;		/* order in which test tile sources are handed to the threads. see comment on enum */
+	bool renumber_nodes;			/* if true, rr nodes are renumbered after the graph is read so that nodes which are close together on the
+						   FPGA grid are also close together in memory (see Routing_Structs::renumber_rr_nodes) */
+	std::string node_map_file;		/* if not empty, the original rr node index of every renumbered node is written to this file */
+
+	unsigned int seed;			/* seed for the random number generator */
+
 	double ipin_probability;
 	double opin_probability;
 	double demand_multiplier;
@@ -179,6 +253,15 @@ public:
 };
 
 
+/* A set of test tiles whose surroundings in the rr graph are translated copies of each other. Paths only need to be enumerated from
+   the representative tile; the demands they place on nodes are replicated to the equivalent nodes of the other tiles of the class */
+class Tile_Class{
+public:
+	Coordinate representative;
+	std::vector< Coordinate > members;	/* all tiles of the class, including the representative */
+};
+
+
 /* A class used to pass around some settings specific to path enumeration & probability analysis.
    The contents of this class are either derived from the contents of the User_Options class, or hard-coded 
    in the appropriate alloc/get functions */
@@ -191,6 +274,9 @@ public:
 	/* A list of tile coordinates representing FPGA tiles from which path enumeration is to be performed */
 	std::vector< Coordinate > test_tile_coords;
 
+	/* If tile symmetry is used (see User_Options::tile_symmetry), the test tiles above grouped into equivalence classes */
+	std::vector< Tile_Class > tile_classes;
+
 	/* Contains the probabilities of using each given pin belonging to the 'fill' block type (the block type can be
 	   determined from Arch_Structs::get_fill_type_index()). If a pin probability is 0, no paths will be enumerated from it */
 	t_prob_list pin_probabilities;
@@ -217,7 +303,54 @@ public:
 };
 
 
-/* A routing resource node on the graph. This structure is based from the corresponding VPR structure, but with slight modifications */
+/* The members of an rr node that graph traversals don't need (electrical properties, switch lists, graphics state,
+   self-congestion bookkeeping). They are kept in a side table of the Routing_Structs class, one entry per rr node,
+   so that the RR_Node objects which are visited during path enumeration stay small. The getters/setters of RR_Node
+   for these members go through the node's 'cold' pointer */
+class RR_Node_Cold{
+public:
+	float R;					/* resistance (ohms) to go through this node (doesn't include switch resistances) */
+	float C;					/* total capacitance (farads) of this node (including switches that hang off from it) */
+	short fan_in;					/* the fan-in to this node */
+	enum e_direction direction;			/* direction along which signals would travel on this node (if applicable) */
+
+	short *out_switches;				/* a list of switches which are used by the edges emanating from this node */
+	short *in_switches;				/* a list of switches which are used by the edges linking into this node */
+
+	bool highlight;
+
+	/* each node keeps track of the number of paths from/to all nearby sources/sinks that are within the 
+	   (manhattan distance w.r.t. logic blocks) radius 'path_count_history_radius'. The center of the 
+	   manhattan circle is at the xlow/ylow coordinates of this node
+
+	In general, a manhattan circle of radius r has 4*r CLBs in the circumference. Adding up successive
+	circumferences gives the #elements in a manhattan circle of radius r as 1 + 4*[r(r+1)/2].
+
+	It is convenient to allocate path history elements in terms of polar coordinates as opposed to cartesian.
+	The indexing variables for the path count histories structure are then:
+	   - radius: the manhattan distance between this node and the target node
+	   - arc: distance along circumference to target node (count starts at (0,r) cartesian coordinate)
+	   - source/sink class index: identifies the source/sink
+	Multiple threads may increment the same entry, so entries are atomic */
+	std::atomic<float> ***source_sink_path_history;	//[0..radius][0..circumference-1][0..num_source/sinks -1]
+	int path_count_history_radius;
+	int num_lb_sources_and_sinks;			/* total number of sources and sinks on a logic block */
+
+	//TODO: make this float if possible
+	/* keeps track of demand contributes from each of the children, for each of the possible path lengths
+	   That is, this array has dimensions [0..num_children-1][0..num_child_demand_buckets-1]  where num_buckets.
+	   This is used to account for self-congestion effects if the corresponding self-congestion mode is selected (see e_self_congestion_mode enum).
+	   Entries are atomic because threads enumerating different connections may add to them concurrently */
+	std::atomic<float> **child_demand_contributions;
+	int num_child_demand_buckets;
+
+	RR_Node_Cold();
+	RR_Node_Cold(const RR_Node_Cold &obj);
+};
+
+
+/* A routing resource node on the graph. This structure is based from the corresponding VPR structure, but with slight modifications.
+   Only members which are used during graph traversals are stored in the node itself; the rest are in the node's RR_Node_Cold entry */
 class RR_Node_Base{
 private:
 	e_rr_type type;					/* the routing resource type of this node (pin, wire, etc) */
@@ -227,25 +360,23 @@ private:
 	short ylow;					/* y coordinate of the low end of this routing resource */
 	short span;					/* how many CLBs this node spans */
 
-	float R;					/* resistance (ohms) to go through this node (doesn't include switch resistances) */
-	float C;					/* total capacitance (farads) of this node (including switches that hang off from it) */
-	
 	short ptc_num;					/* pin-track-class number. allows lookups of which pin/track/etc an rr node represents */
-	short fan_in;					/* the fan-in to this node */
 	short num_out_edges;				/* number of edges emanating from this node */
 
-	enum e_direction direction;			/* direction along which signals would travel on this node (if applicable) */
-
 public:
 
 	RR_Node_Base();
 	RR_Node_Base(const RR_Node_Base &obj);
 
+	/* the out-edge list points into the out-edge table of the Routing_Structs class (see RR_Edge_Table) */
 	int *out_edges;					/* a list of rr nodes *to* which this node connects [0..get_num_out_edges()-1] */
-	short *out_switches;				/* a list of switches which are used by the edges emanating from this node */
+
+	/* members of this node that aren't needed for graph traversals. points into the cold node table of the Routing_Structs class.
+	   copies of a node refer to the same cold entry */
+	RR_Node_Cold *cold;
 	
-	/* allocator functions */
-	void alloc_out_edges_and_switches(short);
+	/* sets out-edge/switch lists to the specified span of an edge table */
+	void set_out_edges_and_switches(int *edges, short *switches, short n_edges);
 
 	/* freeing function */
 	void free_allocated_members();
@@ -263,6 +394,7 @@ public:
 	short get_ptc_num() const;			/* get the pin-track-class number of this node */
 	short get_fan_in() const;			/* get the fan-in of this node */
 	short get_num_out_edges() const;		/* get the number of edges emanating from this node */
+	short *get_out_switches() const;		/* get the list of switches used by the edges emanating from this node */
 	e_direction get_direction() const;		/* get the directionality of this node in relation to the coordinate system (increasing/decreasing/bidir) */
 
 	/* set methods */
@@ -281,84 +413,66 @@ public:
 class RR_Node : public RR_Node_Base {
 private:
 	short num_in_edges;				/* number of edges linking into this node */
-	float weight;					/* weight of this node */
-	double demand;					/* fractional demand for this node. used for routability analysis */
-
-	
-
-	/* each node keeps track of the number of paths from/to all nearby sources/sinks that are within the 
-	   (manhattan distance w.r.t. logic blocks) radius 'path_count_history_radius'. The center of the 
-	   manhattan circle is at the xlow/ylow coordinates of this node
-
-	In general, a manhattan circle of radius r has 4*r CLBs in the circumference. Adding up successive
-	circumferences gives the #elements in a manhattan circle of radius r as 1 + 4*[r(r+1)/2].
-
-	It is convenient to allocate path history elements in terms of polar coordinates as opposed to cartesian.
-	The indexing variables for the path count histories structure are then:
-	   - radius: the manhattan distance between this node and the target node
-	   - arc: distance along circumference to target node (count starts at (0,r) cartesian coordinate)
-	   - source/sink class index: identifies the source/sink */
-	float ***source_sink_path_history;	//[0..radius][0..circumference-1][0..num_source/sinks -1]
-	int path_count_history_radius;
+	/* is this node a virtual source? */
+	bool is_virtual_source;
+	/* weight and demand are updated by all threads enumerating paths through this node. increments to the demand are never negative,
+	   so the weight (a non-decreasing function of demand) is kept at the value corresponding to the largest demand seen so far */
+	std::atomic<float> weight;			/* weight of this node */
+	std::atomic<double> demand;			/* fractional demand for this node. used for routability analysis */
 
 	/* a hack that allows paths to be enumerated out of non-source nodes -- a virtual source node can be created to connect to some
 	   subset of predecessors of this node which can be useful for things like accounting for fanout (by enumerating paths backward
 	   through ipins essentially).
 	   this variable marks the index of the virtual source corresponding to this IPIN (if this is an IPIN) */
 	int virtual_source_node_ind;
-	/* is this node a virtual source? */
-	bool is_virtual_source;
+
+	/* the index at which this node was created (i.e. its index in the rr structs file, or the index Wotan gave it if it is a virtual
+	   source). unlike the node's current index, this doesn't change if the rr nodes are renumbered (see Routing_Structs::renumber_rr_nodes) */
+	int original_node_ind;
 
 protected:
+	/* returns the weight this node would have at the specified demand */
+	float get_weight_at_demand(double node_demand, float demand_multiplier) const;
+
 	/* Increments + returns path count history, or simply returns path count history
 	   of this node based on the 'increment' bool variable */
 	float access_path_count_history(float increment_val, RR_Node &target_node, bool increment);
 
 public:
 
-	int num_lb_sources_and_sinks;			/* total number of sources and sinks on a logic block */
-	int num_child_demand_buckets;
-	pthread_mutex_t my_mutex;
-
 	RR_Node();
-	~RR_Node();
 	RR_Node(const RR_Node &obj);
+	RR_Node& operator=(const RR_Node &obj);		/* same semantics as the copy constructor (the atomic members can't be copied implicitly) */
 
-	bool highlight;
-
-	/* these structures are used to do backwards traversals of the graph. */
+	/* these structures are used to do backwards traversals of the graph. they point into the in-edge table of the Routing_Structs class */
 	int *in_edges;					/* a list of rr nodes *from* which this node receives connections [0..get_num_in_edges()-1] */
-	short *in_switches;				/* a list of switches which are used by the edges linking into this node */
-
-	//TODO: make this float if possible
-	/* keeps track of demand contributes from each of the children, for each of the possible path lengths
-	   That is, this array has dimensions [0..num_children-1][0..num_child_demand_buckets-1]  where num_buckets.
-	   This is used to account for self-congestion effects if the corresponding self-congestion mode is selected (see e_self_congestion_mode enum) */
-	float **child_demand_contributions;
 
 
 	/* allocator functions */
-	void alloc_in_edges_and_switches(short);
 	void alloc_source_sink_path_history(int num_lb_sources_and_sinks);
 	void alloc_child_demand_contributions(int max_path_weight);
 
 	/* free functions */
-	void free_in_edges_and_switches();
 	void free_allocated_members();
 	void free_child_demand_contributions();
 
 	/* set methods */
+	void set_in_edges_and_switches(int *edges, short *switches, short n_edges);	/* sets in-edge/switch lists to the specified span of an edge table */
 	void clear_demand();
+	void clear_demand_history();			/* resets the contents of the path count history & child demand contribution structures */
 	void increment_demand(double increment, float demand_multiplier);
 	void set_virtual_source_node_ind(int);
+	void set_original_node_ind(int);
 	void set_weight(float demand_multiplier);
 	void set_is_virtual_source(bool is_virt);
 
 	/* get methods */
 	short get_num_in_edges() const;
+	short *get_in_switches() const;			/* get the list of switches used by the edges linking into this node */
 	double get_demand(User_Options*) const;
 	float get_weight() const;
 	int get_virtual_source_node_ind() const;
+	int get_original_node_ind() const;
 	bool get_is_virtual_source() const;
 
 	/* increments path count history at this node due to the specified target node.
@@ -515,6 +629,31 @@ public:
 };
 
 
+/* Holds the edges of all rr nodes in compressed sparse row form: the edges of node 'inode' are entries
+   [offsets[inode]..offsets[inode+1]-1] of the 'edges' and 'switches' arrays. Keeping the edges of all nodes in
+   a handful of contiguous arrays (rather than in separate allocations for each node) means that graph traversals
+   step through memory in order */
+class RR_Edge_Table{
+public:
+	std::vector<int> offsets;			/* [0..num_nodes]. where the edges of each node start */
+	std::vector<int> edges;				/* the node at the other end of each edge */
+	std::vector<short> switches;			/* the switch used by each edge */
+
+	/* allocates the table based on the number of edges of each node. edge and switch entries are set to UNDEFINED */
+	void alloc_from_edge_counts(const std::vector<int> &num_node_edges);
+	/* adds a node with the specified edges to the end of the table */
+	void append_node(const std::vector<int> &node_edges, const std::vector<short> &node_switches);
+	void swap(RR_Edge_Table &other);
+	/* renumbers the nodes of the table: node 'inode' becomes node new_node_inds[inode], along with the edges that lead to it.
+	   'old_node_inds' is the inverse of 'new_node_inds'. the edges of each node stay in the same order */
+	void renumber_nodes(const std::vector<int> &new_node_inds, const std::vector<int> &old_node_inds);
+
+	int get_num_nodes() const;
+	int get_num_edges() const;
+	int get_num_node_edges(int node_ind) const;
+};
+
+
 /* contains routing structures */
 class Routing_Structs{
 private:
@@ -522,11 +661,20 @@ private:
 public:
 
 	t_rr_node rr_node;				/* a 1-D array of rr nodes */
+	std::deque<RR_Node_Cold> rr_node_cold;		/* the cold members of each rr node (see RR_Node_Cold). a deque, so that adding nodes doesn't move existing entries */
 	t_rr_switch_inf rr_switch_inf;			/* a 1-D array of rr switch types */
 	t_rr_node_index rr_node_index;			/* a matrix for lookups of rr nodes at some physical location */
 
+	RR_Edge_Table out_edge_table;			/* out-edges/switches of every rr node */
+	RR_Edge_Table in_edge_table;			/* in-edges/switches of every rr node (i.e. the transposed graph) */
+
+	/* points the out/in edge lists of each rr node at its span of the edge tables. has to be called whenever
+	   the edge tables are (re)allocated. nodes which are beyond the end of a table get no edges */
+	void link_rr_node_edges();
+
 	/* allocator functions. if we want to move from vectors to C-style arrays, can change this, and deallocate in destructor */
 	void alloc_and_create_rr_node(int);
+	int add_rr_node();				/* adds an uninitialized rr node to the end of the rr node list. returns its index */
 	void alloc_rr_node_path_histories(int num_lb_sources_and_sinks);
 
 	void alloc_and_create_rr_switch_inf(int);
@@ -534,9 +682,15 @@ public:
 	void alloc_and_create_rr_node_index(int num_rr_types, int x_size, int y_size);
 
 	void init_rr_node_weights();
+	void clear_rr_node_demands();			/* resets node demands, demand histories and weights to their state before path enumeration */
+
+	/* renumbers the rr nodes so that node 'inode' becomes node new_node_inds[inode]. the edge tables, the rr node index and virtual
+	   source links are updated to match. has to be called before any per-node analysis structures are allocated */
+	void renumber_rr_nodes(const std::vector<int> &new_node_inds);
 
 	/* get methods */
 	int get_num_rr_nodes() const;
+	int get_translated_node(int node_ind, int dx, int dy) const;	/* returns the node equivalent to the specified one, dx/dy tiles away (or UNDEFINED) */
 };
 
 
@@ -588,6 +742,142 @@ public:
 };
 
 
+/* Source/sink distances of each node, for use by one thread. Like My_Epoch_Vector, entries are reset lazily after each connection.
+   Distances from a source can also be 'shared' by several connections of that source: shared distances are kept across resets, and
+   an entry is given its node's shared source distance (and marked as visited from the source) whenever it is reset */
+class SS_Distances_Vector : public My_Epoch_Vector< SS_Distances >{
+private:
+	std::vector<int> shared_source_distances;	/* shared distance of each node from the source. only valid if stamped with the current shared epoch */
+	std::vector<unsigned> shared_source_epochs;	/* shared epoch in which each of the above distances was set */
+	unsigned shared_source_epoch;			/* the current shared epoch */
+
+	/* resets the specified entry to the shared source distance of its node, if any */
+	void reset_entry(int ind);
+public:
+	SS_Distances_Vector();
+	SS_Distances_Vector(int num_entries);
+
+	/* sets the vector to 'num_entries' cleared entries, with no shared source distances */
+	void assign(int num_entries);
+
+	/* forgets all shared source distances. should be followed by a reset (see My_Epoch_Vector::reset) before entries are accessed */
+	void reset_shared_source_distances();
+
+	/* sets/gets the shared source distance of the specified node. the getter returns UNDEFINED if the distance hasn't been set */
+	void set_shared_source_distance(int ind, int distance);
+	int get_shared_source_distance(int ind) const;
+
+	/* returns the specified entry, resetting it first if it was last accessed during an earlier connection */
+	SS_Distances& operator[](int ind);
+};
+
+/* defined here so that it can be inlined into the graph traversal loops */
+inline SS_Distances& SS_Distances_Vector::operator[](int ind){
+	if (this->entry_epochs[ind] != this->epoch){
+		this->reset_entry(ind);
+	}
+	return this->entries[ind];
+}
+
+
+/* identifies the distance fields of a connection (see Distance_Cache) */
+class Distance_Cache_Key{
+public:
+	int source_ind;
+	int sink_ind;
+	int max_path_weight;			/* maximum path weight of the connection, before it was adjusted based on the source/sink distance */
+	unsigned long long weight_snapshot;	/* identifies the node weights with which the fields were found */
+
+	bool operator==(const Distance_Cache_Key &obj) const;
+};
+
+/* hash function for Distance_Cache_Key, for use with std::unordered_map */
+class Distance_Cache_Key_Hash{
+public:
+	size_t operator()(const Distance_Cache_Key &key) const;
+};
+
+/* the source/sink distances found for a connection, as kept by Distance_Cache */
+class Distance_Field{
+public:
+	Distance_Cache_Key key;
+	bool reachable;				/* false if the source and sink can't reach each other. there are no node entries in that case */
+	int adjusted_max_path_weight;		/* maximum path weight after adjustment based on the source/sink distance */
+	int source_sink_dist;			/* distance from source to sink */
+	bool has_hops;				/* true if the source/sink hops of the entries below have been found as well */
+
+	std::vector<int> node_inds;			/* nodes that have a distance to the sink. no other nodes can be part of the legal subgraph */
+	std::vector<SS_Distances> node_distances;	/* entry of each of the above nodes */
+
+	Distance_Field();
+
+	/* returns roughly how many bytes of memory this field takes up */
+	size_t get_num_bytes() const;
+};
+
+/* A bounded cache of the distance fields of recently analyzed connections, for use by one thread. A connection's fields depend on
+   nothing but its source, sink, maximum path weight and the node weights, so a connection that is analyzed again while the node weights are
+   the same as before (i.e. in the first enumeration round of each try of a demand multiplier search, or when a connection is analyzed at
+   both bucket precisions) can have its fields copied into t_ss_distances rather than found again by graph traversals.
+   Node weights are identified by a snapshot ID that is set before each job; fields found with other weights are never handed out, and
+   the least recently used fields are dropped once the cache grows past its size limit */
+class Distance_Cache{
+private:
+	typedef std::list< Distance_Field > t_field_list;
+	typedef std::unordered_map< Distance_Cache_Key, t_field_list::iterator, Distance_Cache_Key_Hash > t_field_map;
+
+	t_field_list fields;			/* most recently used field first */
+	t_field_map field_map;			/* position of each field in the above list */
+	size_t max_bytes;
+	size_t num_bytes;
+	unsigned long long weight_snapshot;	/* snapshot ID of the current node weights */
+	Distance_Field *current_field;		/* field of the connection that was last looked up or stored. NULL if the last lookup missed */
+
+	long num_lookups;
+	long num_hits;
+
+	/* returns the key of the specified connection at the current node weights */
+	Distance_Cache_Key get_key(int source_ind, int sink_ind, int max_path_weight) const;
+
+	/* drops least recently used fields until the cache fits its size limit */
+	void evict();
+public:
+	std::vector<int> visited_nodes;		/* used by the caller to collect the nodes whose entries make up a field. kept here so that its
+						   storage is reused between connections */
+
+	Distance_Cache();
+
+	/* sets the size limit of the cache. a limit of 0 disables it */
+	void set_max_bytes(size_t bytes);
+	bool is_enabled() const;
+
+	/* sets the snapshot ID of the node weights with which connections will be analyzed from now on */
+	void set_weight_snapshot(unsigned long long snapshot);
+
+	/* returns whether the fields of the specified connection are in the cache. doesn't count as a use of the fields */
+	bool contains(int source_ind, int sink_ind, int max_path_weight) const;
+
+	/* looks up the fields of the specified connection. on a hit the distances (and hops, if any) are copied into 'ss_distances' and the
+	   field is returned; NULL is returned on a miss */
+	Distance_Field* restore(int source_ind, int sink_ind, int max_path_weight, t_ss_distances &ss_distances);
+
+	/* stores the fields of the specified connection. the entries of those of 'node_inds' which have a distance to the sink are copied
+	   from 'ss_distances' */
+	void store(int source_ind, int sink_ind, int max_path_weight, bool reachable, int adjusted_max_path_weight, int source_sink_dist,
+			const std::vector<int> &node_inds, t_ss_distances &ss_distances);
+
+	/* copies the source/sink hops that have been found for the current field's nodes from 'ss_distances' */
+	void store_hops(t_ss_distances &ss_distances);
+
+	Distance_Field* get_current_field();
+
+	/* number of lookups / hits since the statistics were last reset */
+	long get_num_lookups() const;
+	long get_num_hits() const;
+	void reset_stats();
+};
+
+
 /* Represents a node that has been visited during topological graph traversal, but who's dependencies
    aren't fully satisfied (i.e. it still has parents which have not been visited).
    This structure is used to deal with graph cycles -- objects of this class are put on a sorted
@@ -597,12 +887,14 @@ class Node_Waiting{
 private:
 	int path_weight;	/* the 'path_weight' attributed to the waiting node -- primary sort for cycle breaking */
 	int source_dist;	/* the distance from corresponding node to the source node -- secondary sort for cycle breaking */
-	int node_ind;		/* the index of the corresponding node -- tertiary sort for cycle breaking */
+	int node_ind;		/* the index of the corresponding node */
+	int original_node_ind;	/* the original index of the corresponding node (see RR_Node::original_node_ind) -- tertiary sort for cycle breaking.
+				   the order in which cycles are broken therefore doesn't change if the rr nodes are renumbered */
 public:
 	Node_Waiting();
 
 	/* set methods */
-	void set( int set_ind, int set_path_weight, int set_source_dist );
+	void set( int set_ind, int set_original_ind, int set_path_weight, int set_source_dist );
 	void clear();
 
 	/* get methods */
@@ -615,14 +907,37 @@ public:
 };
 
 
+/* A bump allocator for the per-node bucket arrays used while analyzing a connection. Arrays are carved out of large blocks
+   as nodes are first visited, and are all released at once when the connection is done; the blocks are kept for reuse
+   by the next connection. Arrays handed out before a release never move */
+class Bucket_Arena{
+private:
+	std::vector< std::vector<char> > blocks;	/* the blocks from which arrays are carved out */
+	int current_block;				/* index of the block from which arrays are currently being carved out */
+	size_t current_offset;				/* the first unused byte of the current block */
+
+	/* returns 'num_bytes' of memory aligned for any bucket type */
+	char* alloc_bytes(size_t num_bytes);
+public:
+	Bucket_Arena();
+
+	/* returns an array of 'num_entries' values of type T, each set to 'init_value' */
+	template <typename T> T* alloc(int num_entries, T init_value);
+
+	/* releases all arrays allocated so far (the underlying blocks are kept) */
+	void release();
+};
+
+
 /* nodes have associated with them two bucket structures. one bucket structure is associated with a source and
    one with a sink (during path enumeration between a specific source/sink). the index of the bucket structure
    corresponds to a particular path weight. the buckets can then be used to keep track of how many paths there
    are of each weight going to a source/sink; or during the probability analysis step, what is the probability
-   of a path of some weight not existing to the source/sink.
+   of a path of some weight not existing to the source/sink. A bucket without any paths holds 0.
 
-   This structure is used in the topological traversal of the graph to count paths */
-class Node_Buckets{
+   This structure is used in the topological traversal of the graph to count paths. The buckets are of type T
+   (double, or float for single-precision probability analysis) */
+template <typename T> class Node_Buckets{
 private:
 	int num_source_buckets;
 	int num_sink_buckets;
@@ -631,16 +946,20 @@ private:
 public:
 
 	Node_Buckets();
-	Node_Buckets(int max_path_weight_bound);	/* allocates source/sink buckets based on the maximum path weight bound specified */
-	~Node_Buckets();
 
-	double *source_buckets;
-	double *sink_buckets;
+	/* the bucket arrays are owned by the Bucket_Arena they were allocated from */
+	T *source_buckets;
+	T *sink_buckets;
+
+	/* source bucket probabilities at each demand multiplier of User_Options::demand_multiplier_list, indexed as
+	   [bucket*num_multipliers + imultiplier]. only allocated if such a list was specified */
+	T *multiplier_buckets;
 
 	/* allocator methods */
-	void alloc_source_sink_buckets(int set_num_source_buckets, int set_num_sink_buckets);
+	void alloc_source_sink_buckets(Bucket_Arena &arena, int set_num_source_buckets, int set_num_sink_buckets);
+	void alloc_multiplier_buckets(Bucket_Arena &arena, int num_multipliers);
 
-	/* free methods */
+	/* free methods. the memory itself is released along with the rest of the arena */
 	void free_source_sink_buckets();
 
 	/* set methods */
@@ -655,9 +974,6 @@ public:
 
 	/* returns number of legal paths which go through the node associated with this structure */
 	float get_num_paths(int my_node_weight, int my_dist_to_source, int max_path_weight) const;
-
-	/* returns the probability of this node being unreachable from source (the node structures must contain probabilities instead of path counts) */
-	float get_probability_not_reachable(int my_node_weight, float my_node_probability) const;
 };
 
 
@@ -684,25 +1000,28 @@ protected:
 	/* returns number of legal nodes on specified edge list */
 	short get_num_legal_nodes(int *edge_list, int num_edges, t_rr_node &rr_node, t_ss_distances &ss_distances, int max_path_weight);
 public:
-	pthread_mutex_t my_mutex;
-
 	Node_Topological_Info();
-	~Node_Topological_Info();
 
 	/* used to limit which paths are considered during topological path enumeration, based on path weight */
-	Node_Buckets buckets;
+	Node_Buckets<double> buckets;
+
+	/* used instead of 'buckets' by probability analysis with single-precision buckets (see User_Options::bucket_precision) */
+	Node_Buckets<float> float_buckets;
 
 	/* used to discount demand contributed to this node by parents for the current s-t connection.
 	   during path propagation, each parent makes a note of how much demand they have contributed to this node
-	   for paths of a given length */
-	std::vector<double> demand_discounts;
+	   for paths of a given length. one entry per source bucket; only allocated in path dependence self-congestion mode */
+	double *demand_discounts;
 
-	/* keeps info that is essential for accessing the corresponding node on a set structure used for breaking cycles */
+	/* the cycle-breaking sort key this node was given when it was put on the heap used for breaking cycles (see Nodes_Waiting_Heap) */
 	Node_Waiting node_waiting_info;
 
-	/* resets variables. does not deallocate node buckets structure (only clears contents) */
+	/* resets variables. does not touch the bucket arrays (a node is handed fresh arrays for each connection, see Node_Topo_Inf_Vector) */
 	void clear();
 
+	/* returns 'buckets' if T is double, and 'float_buckets' if T is float */
+	template <typename T> Node_Buckets<T>& get_buckets();
+
 	/* set methods */
 	void set_done_from_source(bool);
 	void set_done_from_sink(bool);
@@ -739,4 +1058,56 @@ public:
 	short set_and_or_get_num_legal_out_nodes(int my_node_index, t_rr_node &rr_node, t_ss_distances &ss_distances, int max_path_weight);
 };
 
+template <> inline Node_Buckets<double>& Node_Topological_Info::get_buckets<double>(){
+	return this->buckets;
+}
+
+template <> inline Node_Buckets<float>& Node_Topological_Info::get_buckets<float>(){
+	return this->float_buckets;
+}
+
+
+/* Topological traversal info of each node, for use by one thread. Like My_Epoch_Vector, entries are reset lazily: an entry
+   last accessed during an earlier connection is reset on its first access during the current one. At that point the
+   node is also handed bucket arrays (sized to the current connection) from a per-thread arena, so that bucket memory
+   scales with the number of nodes a connection touches rather than with the size of the graph */
+class Node_Topo_Inf_Vector : public My_Epoch_Vector< Node_Topological_Info >{
+private:
+	Bucket_Arena arena;		/* holds the bucket arrays of all nodes accessed during the current connection */
+	int num_buckets;		/* number of source/sink buckets handed to each node during the current connection */
+	bool use_float_buckets;		/* whether nodes are handed Node_Topological_Info::float_buckets instead of the double-precision buckets */
+	int num_multipliers;		/* number of multiplier buckets per source bucket (see Node_Buckets::multiplier_buckets) */
+	bool use_demand_discounts;	/* whether nodes get demand discount arrays (see Node_Topological_Info::demand_discounts) */
+
+	/* resets the specified entry and hands it fresh bucket arrays */
+	void reset_entry(int ind);
+public:
+	Node_Topo_Inf_Vector();
+	Node_Topo_Inf_Vector(int num_entries);
+
+	/* sets the vector to 'num_entries' entries, none of which have been accessed yet */
+	void assign(int num_entries);
+
+	/* sets which per-bucket arrays, other than the source/sink buckets, are handed to each node */
+	void set_bucket_options(int set_num_multipliers, bool set_use_demand_discounts);
+
+	/* sets the number (and precision) of source/sink buckets handed to nodes first accessed from now on. should be set at
+	   the start of each connection, before any entry is accessed */
+	void set_num_buckets(int set_num_buckets, bool set_use_float_buckets);
+
+	/* starts a new connection. all entries will read as cleared, and all bucket arrays are released */
+	void reset();
+
+	/* returns the specified entry, resetting it first if it was last accessed during an earlier connection */
+	Node_Topological_Info& operator[](int ind);
+};
+
+/* defined here so that it can be inlined into the graph traversal loops */
+inline Node_Topological_Info& Node_Topo_Inf_Vector::operator[](int ind){
+	if (this->entry_epochs[ind] != this->epoch){
+		this->reset_entry(ind);
+	}
+	return this->entries[ind];
+}
+
 #endif
@@ -1,6 +1,7 @@
 
 #include <cmath>
 #include <utility>
+#include <algorithm>
 #include <functional>
 #include "wotan_util.h"
 #include "exception.h"
@@ -33,6 +34,62 @@ template <typename T> T or_two_probs(T p1, T p2){
 template float or_two_probs(float, float);
 template double or_two_probs(double, double);
 
+/* atomically adds 'value' to 'target' (which may be updated by multiple threads). returns the updated value */
+template <typename T> T atomic_add(std::atomic<T> &target, T value){
+	/* there is no fetch_add for floating point atomics -- retry until no other thread has changed 'target'
+	   between the load and the exchange (a failed exchange reloads 'expected') */
+	T expected = target.load(std::memory_order_relaxed);
+	T desired = expected + value;
+	while ( !target.compare_exchange_weak(expected, desired, std::memory_order_relaxed) ){
+		desired = expected + value;
+	}
+	return desired;
+}
+/* only defined for float/double types */
+template float atomic_add(std::atomic<float>&, float);
+template double atomic_add(std::atomic<double>&, double);
+
+/* atomically sets 'target' to 'value' if 'value' is larger than the current value of 'target' */
+template <typename T> void atomic_max(std::atomic<T> &target, T value){
+	T expected = target.load(std::memory_order_relaxed);
+	while (expected < value && !target.compare_exchange_weak(expected, value, std::memory_order_relaxed)){
+		/* a failed exchange reloads 'expected' */
+	}
+}
+/* only defined for float/double types */
+template void atomic_max(std::atomic<float>&, float);
+template void atomic_max(std::atomic<double>&, double);
+
+/* returns the size of the smallest Hilbert curve (a power of 2) that covers a grid of the specified size */
+int get_hilbert_curve_size(int grid_size_x, int grid_size_y){
+	int curve_size = 1;
+	while (curve_size < max(grid_size_x, grid_size_y)){
+		curve_size *= 2;
+	}
+	return curve_size;
+}
+
+/* returns the index of the specified tile along a Hilbert curve that covers a curve_size*curve_size grid (curve_size is a power of 2).
+   tiles that are close together along the curve are also close together on the grid */
+long get_hilbert_curve_index(int x, int y, int curve_size){
+	long curve_index = 0;
+	for (int quadrant_size = curve_size / 2; quadrant_size > 0; quadrant_size /= 2){
+		int quadrant_x = (x & quadrant_size) > 0 ? 1 : 0;
+		int quadrant_y = (y & quadrant_size) > 0 ? 1 : 0;
+		curve_index += (long)quadrant_size * quadrant_size * ((3 * quadrant_x) ^ quadrant_y);
+
+		/* rotate the coordinates so that the curve within the quadrant has the standard orientation */
+		if (quadrant_y == 0){
+			if (quadrant_x == 1){
+				x = curve_size-1 - x;
+				y = curve_size-1 - y;
+			}
+			swap(x, y);
+		}
+	}
+	return curve_index;
+}
+
 
 /**** Class Function Definitions ****/
 
@@ -92,42 +149,78 @@ std::ostream& operator<<(std::ostream &os, const Coordinate &coord){
 /*=== End Coordinate Class ===*/
 
 
-/*=== My_Bounded_Priority_Queue Class ===*/
+/*=== My_Monotone_Bucket_Queue Class ===*/
+
+#define BUCKET_QUEUE_WORD_BITS 64
 
-template <typename T> My_Bounded_Priority_Queue<T>::My_Bounded_Priority_Queue(){
+template <typename T> My_Monotone_Bucket_Queue<T>::My_Monotone_Bucket_Queue(){
 	this->max_weight = UNDEFINED;
 	this->current_lowest_weight = UNDEFINED;
+	this->last_popped_weight = 0;
 	this->num_objects = 0;
 }
 
-template <typename T> My_Bounded_Priority_Queue<T>::My_Bounded_Priority_Queue(int max_w){
-	this->max_weight = UNDEFINED;
+/* empties the queue and sets the maximum weight for the next traversal. storage is reused */
+template <typename T> void My_Monotone_Bucket_Queue<T>::reset(int max_w){
+	if (max_w < 0){
+		WTHROW(EX_OTHER, "Bucket priority queue needs a non-negative maximum weight. Got: " << max_w);
+	}
+
+	/* empty buckets that still hold objects (normally none -- a traversal runs until the queue is empty) */
+	if (this->num_objects > 0){
+		for (int iweight = this->find_occupied_weight(0); iweight != UNDEFINED; iweight = this->find_occupied_weight(iweight+1)){
+			this->buckets[iweight].clear();
+			this->bucket_heads[iweight] = 0;
+		}
+		this->occupied.assign(this->occupied.size(), 0);
+	}
+
+	/* grow storage if the new maximum weight hasn't been seen before.
+	   priority queue will have weight 0..max_w */
+	if (max_w + 1 > (int)this->buckets.size()){
+		this->buckets.resize(max_w + 1);
+		this->bucket_heads.resize(max_w + 1, 0);
+		this->occupied.resize(max_w / BUCKET_QUEUE_WORD_BITS + 1, 0);
+	}
+
+	this->max_weight = max_w;
 	this->current_lowest_weight = UNDEFINED;
+	this->last_popped_weight = 0;
 	this->num_objects = 0;
-
-	this->set_max_weight(max_w);
 }
 
-/* sets maximum weight */
-template <typename T> void My_Bounded_Priority_Queue<T>::set_max_weight(int max_w){
-	if (max_weight == UNDEFINED){
-		this->max_weight = max_w;
-	
-		/* size the priority queue.
-		   priority queue will have weight 0..max_w */
-		this->my_pq.assign(max_w + 1, queue<T>());
-	} else {
-		WTHROW(EX_OTHER, "Not allowing re-sizing of bounded-height priority queue. May be implemented later.");
+/* returns the lowest non-empty weight that is >= 'from_weight', or UNDEFINED if there is none */
+template <typename T> int My_Monotone_Bucket_Queue<T>::find_occupied_weight(int from_weight) const{
+	int num_words = (int)this->occupied.size();
+	int iword = from_weight / BUCKET_QUEUE_WORD_BITS;
+	if (iword >= num_words){
+		return UNDEFINED;
+	}
+
+	/* ignore bits below 'from_weight' in the first word */
+	unsigned long long word = this->occupied[iword] & (~0ULL << (from_weight % BUCKET_QUEUE_WORD_BITS));
+	while (word == 0){
+		iword++;
+		if (iword >= num_words){
+			return UNDEFINED;
+		}
+		word = this->occupied[iword];
 	}
+
+	return iword * BUCKET_QUEUE_WORD_BITS + __builtin_ctzll(word);
 }
 
 /* push object of specified weight to queue */
-template <typename T> void My_Bounded_Priority_Queue<T>::push(T object, int weight){
+template <typename T> void My_Monotone_Bucket_Queue<T>::push(T object, int weight){
 	if (weight > this->max_weight || weight < 0){
-		WTHROW(EX_OTHER, "Object pushed into bounded-height priority queue has weight outside 0..max_weight. Object weight: " << weight << "  Max weight: " << this->max_weight);
+		WTHROW(EX_OTHER, "Object pushed into bucket priority queue has weight outside 0..max_weight. Object weight: " << weight << "  Max weight: " << this->max_weight);
+	}
+	if (weight < this->last_popped_weight){
+		WTHROW(EX_OTHER, "Object pushed into monotone bucket priority queue has weight below that of the last-popped object. Object weight: " << weight << "  Last-popped weight: " << this->last_popped_weight);
 	}
 
-	this->my_pq[weight].push( object );
+	this->buckets[weight].push_back( object );
+	this->occupied[weight / BUCKET_QUEUE_WORD_BITS] |= (1ULL << (weight % BUCKET_QUEUE_WORD_BITS));
 	this->num_objects++;
 
 	/* update current lowest weight */
@@ -137,63 +230,93 @@ template <typename T> void My_Bounded_Priority_Queue<T>::push(T object, int weig
 }
 
 /* pop lowest-weight object from queue */
-template <typename T> void My_Bounded_Priority_Queue<T>::pop(){
+template <typename T> void My_Monotone_Bucket_Queue<T>::pop(){
 	if (this->current_lowest_weight != UNDEFINED){
-		this->my_pq[this->current_lowest_weight].pop();
+		int weight = this->current_lowest_weight;
+		this->bucket_heads[weight]++;
+		this->last_popped_weight = weight;
 		this->num_objects--;
 
-		int objects_at_current_lowest = (int)this->my_pq[this->current_lowest_weight].size();
+		if (this->bucket_heads[weight] == (int)this->buckets[weight].size()){
+			/* bucket is drained. rewind it and look for the next non-empty bucket */
+			this->buckets[weight].clear();
+			this->bucket_heads[weight] = 0;
+			this->occupied[weight / BUCKET_QUEUE_WORD_BITS] &= ~(1ULL << (weight % BUCKET_QUEUE_WORD_BITS));
 
-		if (objects_at_current_lowest == 0){
 			if (this->num_objects == 0){
 				this->current_lowest_weight = UNDEFINED;
 			} else {
-				/* must search for the next current lowest weight */
-				for (int iweight = this->current_lowest_weight; iweight <= this->max_weight; iweight++){
-					int num_objs = (int)this->my_pq[iweight].size();
-
-					if (num_objs > 0){
-						this->current_lowest_weight = iweight;
-						break;
-					}
-				}
+				this->current_lowest_weight = this->find_occupied_weight(weight+1);
 			}
 		}
 	}
 }
 
 /* gets the top (lowest-weight) element */
-template <typename T> const T& My_Bounded_Priority_Queue<T>::top() const{
+template <typename T> const T& My_Monotone_Bucket_Queue<T>::top() const{
 
 	if (this->current_lowest_weight == UNDEFINED){
-		WTHROW(EX_OTHER, "Called top on empty bounded-height priority queue");
+		WTHROW(EX_OTHER, "Called top on empty bucket priority queue");
 	}
 
-	const T &obj = this->my_pq[this->current_lowest_weight].front();
+	int weight = this->current_lowest_weight;
+	const T &obj = this->buckets[weight][ this->bucket_heads[weight] ];
 
 	return obj;
 }
 
 /* returns weight of top (lowest-weight) node */
-template <typename T> int My_Bounded_Priority_Queue<T>::top_weight() const{
+template <typename T> int My_Monotone_Bucket_Queue<T>::top_weight() const{
 	return this->current_lowest_weight;
 }
 
 /* # of entries in priority queue */
-template <typename T> int My_Bounded_Priority_Queue<T>::size() const{
+template <typename T> int My_Monotone_Bucket_Queue<T>::size() const{
 	return this->num_objects;
 }
 
-/* clears entire priority queue */
-template <typename T> void My_Bounded_Priority_Queue<T>::clear(){
-	this->max_weight = UNDEFINED;
-	this->current_lowest_weight = UNDEFINED;	
-	this->num_objects = UNDEFINED;
+/* IMPORTANT: the bucket priority queue will only work for types explicitely specified in below templates */
+template class My_Monotone_Bucket_Queue<int>;
+/*=== END My_Monotone_Bucket_Queue Class ===*/
+
+
+
+/*=== My_Epoch_Vector Class ===*/
+
+template <typename T> My_Epoch_Vector<T>::My_Epoch_Vector(){
+	this->epoch = 0;
+}
+
+template <typename T> My_Epoch_Vector<T>::My_Epoch_Vector(int num_entries, const T &value){
+	this->epoch = 0;
+	this->assign(num_entries, value);
+}
+
+/* sets the vector to 'num_entries' copies of 'value', all belonging to the current epoch */
+template <typename T> void My_Epoch_Vector<T>::assign(int num_entries, const T &value){
+	this->entries.assign(num_entries, value);
+	this->entry_epochs.assign(num_entries, this->epoch);
+}
+
+/* starts a new epoch. all entries will read as cleared */
+template <typename T> void My_Epoch_Vector<T>::reset(){
+	this->epoch++;
+
+	if (this->epoch == 0){
+		/* the epoch counter wrapped around, so entries stamped with epoch 1 long ago would look current. mark every entry as stale */
+		this->entry_epochs.assign(this->entries.size(), 0);
+		this->epoch = 1;
+	}
+}
+
+template <typename T> int My_Epoch_Vector<T>::size() const{
+	return (int)this->entries.size();
 }
 
-/* IMPORTANT: the bounded-height priority queue will only work for types explicitely specified in below templates */
-template class My_Bounded_Priority_Queue<int>;
-/*=== END My_Bounded_Priority_Queue Class ===*/
+/* IMPORTANT: the epoch vector will only work for types explicitely specified in below templates */
+template class My_Epoch_Vector<SS_Distances>;
+template class My_Epoch_Vector<Node_Topological_Info>;
+/*=== END My_Epoch_Vector Class ===*/
 
 
 
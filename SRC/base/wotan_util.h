@@ -6,6 +6,7 @@
 #include <vector>
 #include <queue>
 #include <set>
+#include <atomic>
 
 /**** Classes ****/
 
@@ -36,24 +37,31 @@ public:
 std::ostream& operator<<(std::ostream &os, const Coordinate &coord);
 
 
-/* A fixed-weight (aka bounded-height) priority queue. Only accepts elements that have a weight up to (and including)
-   the maximum, as set in the constructor / the set_max_weight function.
-   The weight of an object being pushed-in is given to the 'push' function alongside the object.
-   Having a queue of a fixed weight allows push/top operation to have complexity of O(1) and the
-   pop operation to have a complexity of O(max_weight) */
-template <typename T> class My_Bounded_Priority_Queue{
+/* A monotone bucket priority queue for integer weights in 0..max_weight (Dial's algorithm). Objects are popped in order of
+   increasing weight, and in FIFO order among objects of the same weight. The queue is monotone: an object may not be pushed with
+   a weight lower than that of the last-popped object, which holds for graph traversals with non-negative node weights.
+   Each weight has a flat buffer that is read from a moving head index and rewound once it is drained, and an occupancy bitmap
+   holds one bit per non-empty weight so that pop can find the next non-empty weight with a bit scan rather than by checking
+   each weight in turn. Storage only ever grows, so a queue that is reused for many traversals (see 'reset') stops allocating
+   once it has seen the largest traversal */
+template <typename T> class My_Monotone_Bucket_Queue{
 private:
-	std::vector< std::queue<T> > my_pq;	/* will implement fixed-size priority queue */
-	int max_weight;				/* the fixed size of the priority queue */
-	int current_lowest_weight;		/* lowest-weight at which an object exists*/
-	int num_objects;			/* number of objects in priority queue */
+	std::vector< std::vector<T> > buckets;		/* objects of each weight. entries before the bucket's head have already been popped */
+	std::vector<int> bucket_heads;			/* index of the next object to be popped from each bucket */
+	std::vector<unsigned long long> occupied;	/* bit w is set if bucket w holds objects that haven't been popped yet */
+	int max_weight;					/* largest weight that can currently be pushed */
+	int current_lowest_weight;			/* lowest weight at which an object exists */
+	int last_popped_weight;				/* weight of the last-popped object. no object of lower weight may be pushed */
+	int num_objects;				/* number of objects in priority queue */
+
+	/* returns the lowest non-empty weight that is >= 'from_weight', or UNDEFINED if there is none */
+	int find_occupied_weight(int from_weight) const;
 public:
 
-	My_Bounded_Priority_Queue();
-	My_Bounded_Priority_Queue(int max_w);
+	My_Monotone_Bucket_Queue();
 
-	/* sets maximum weight */
-	void set_max_weight(int max_w);
+	/* empties the queue and sets the maximum weight for the next traversal. storage is reused */
+	void reset(int max_w);
 
 	/* push, pop, top */
 	void push(T object, int weight);
@@ -65,11 +73,43 @@ public:
 
 	/* # of entries in priority queue */
 	int size() const;
+};
 
-	/* clears entire priority queue */
-	void clear();
+/* A vector whose entries are reset lazily. Each entry is stamped with the epoch in which it was last accessed; 'reset' starts a
+   new epoch, and an entry from an older epoch is cleared (with its 'clear' method) the first time it is accessed in the new one.
+   Resetting the whole vector therefore costs a counter increment, and only entries that are actually accessed are ever cleared.
+   Used for per-node traversal state that has to be reset after each connection is analyzed */
+template <typename T> class My_Epoch_Vector{
+protected:
+	std::vector<T> entries;
+	std::vector<unsigned> entry_epochs;	/* epoch in which each entry was last accessed (and cleared, if needed) */
+	unsigned epoch;				/* the current epoch */
+public:
+	My_Epoch_Vector();
+	My_Epoch_Vector(int num_entries, const T &value);
+
+	/* sets the vector to 'num_entries' copies of 'value', all belonging to the current epoch */
+	void assign(int num_entries, const T &value);
+
+	/* starts a new epoch. all entries will read as cleared */
+	void reset();
+
+	/* returns the specified entry, clearing it first if it was last accessed in an earlier epoch */
+	T& operator[](int ind);
+
+	int size() const;
 };
 
+/* defined here rather than with the rest of the class so that it can be inlined into the graph traversal loops */
+template <typename T> inline T& My_Epoch_Vector<T>::operator[](int ind){
+	T &entry = this->entries[ind];
+	if (this->entry_epochs[ind] != this->epoch){
+		entry.clear();
+		this->entry_epochs[ind] = this->epoch;
+	}
+	return entry;
+}
+
 /* A fixed size priority queue. Can contain up to the number of objects
    as specified to the constructor. If the priority queue
    exceeds the maximum number of objects, the object at the TOP of the queue is kicked out
@@ -100,4 +140,16 @@ bool contains_substring(std::string str, std::string substr);
 /* ORs two independent probability numbers */
 template <typename T> T or_two_probs(T p1, T p2);
 
+/* atomically adds 'value' to 'target' (which may be updated by multiple threads). returns the updated value */
+template <typename T> T atomic_add(std::atomic<T> &target, T value);
+
+/* atomically sets 'target' to 'value' if 'value' is larger than the current value of 'target' */
+template <typename T> void atomic_max(std::atomic<T> &target, T value);
+
+/* returns the size of the smallest Hilbert curve (a power of 2) that covers a grid of the specified size */
+int get_hilbert_curve_size(int grid_size_x, int grid_size_y);
+
+/* returns the index of the specified tile along a Hilbert curve that covers a curve_size*curve_size grid (curve_size is a power of 2) */
+long get_hilbert_curve_index(int x, int y, int curve_size);
+
 #endif
@@ -148,7 +148,7 @@ static void handle_button_press(float x, float y, t_event_buttonPressed event_bu
 
 			/* display demand */
 			stringstream ss;
-			ss << "CHANX node: " << node_ind << "  demand: " << node_demand;
+			ss << "CHANX node: " << f_routing_structs_ptr->rr_node[node_ind].get_original_node_ind() << "  demand: " << node_demand;
 			update_message(ss.str().c_str());
 		}
 	} else if (relative_x > tile_width && relative_y <= tile_width){
@@ -160,7 +160,7 @@ static void handle_button_press(float x, float y, t_event_buttonPressed event_bu
 
 			/* display demand */
 			stringstream ss;
-			ss << "CHANY node: " << node_ind << "  demand: " << node_demand;
+			ss << "CHANY node: " << f_routing_structs_ptr->rr_node[node_ind].get_original_node_ind() << "  demand: " << node_demand;
 			update_message(ss.str().c_str());
 		}
 	} else {
@@ -283,7 +283,7 @@ static void draw_rr(void) {
 static t_color get_node_color(int node_ind, t_rr_node &rr_node){
 	t_color color(BLACK);	//TODO. provisional
 
-	if (rr_node[node_ind].highlight){
+	if (rr_node[node_ind].cold->highlight){
 		color = t_color(RED);
 		//setlinewidth(3);
 		
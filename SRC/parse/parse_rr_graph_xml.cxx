@@ -0,0 +1,984 @@
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include "exception.h"
+#include "io.h"
+#include "wotan_types.h"
+#include "parse_rr_graph_xml.h"
+
+using namespace std;
+
+
+/**** Defines ****/
+/* the XML file is read in chunks of this many bytes */
+#define XML_READ_BUFFER_SIZE (1 << 20)
+/* longest terminator string that the XML reader can skip past (i.e. "-->" for comments) */
+#define MAX_XML_TERMINATOR_LENGTH 4
+
+
+/**** Enums ****/
+/* events reported by the XML stream reader */
+enum e_xml_event{
+	XML_START_ELEMENT = 0,		/* an element was opened. its name and attributes can be queried */
+	XML_END_ELEMENT,		/* an element was closed. a self-closing element reports a start and then an end event */
+	XML_END_OF_FILE
+};
+
+
+/**** Classes ****/
+/* a name="value" pair belonging to an XML element */
+class Xml_Attribute{
+public:
+	string name;
+	string value;
+};
+
+/* Reads an XML file as a stream of start/end element events (SAX-style). The file is read in chunks of XML_READ_BUFFER_SIZE
+   bytes, and only the attributes of the most recent element are kept around. Character data, comments, processing
+   instructions and DTDs are skipped -- Wotan only needs element attributes */
+class Xml_Stream_Reader{
+private:
+	fstream file;
+	string path;
+	vector<char> buffer;
+	size_t buffer_pos;
+	size_t buffer_end;
+	int line_num;				/* current line of the file. used for error messages */
+
+	bool pending_end;			/* true if the last element was self-closing; its end event is reported next */
+	string element_name;
+	vector<Xml_Attribute> attributes;	/* attributes of the last element. entries past 'num_attributes' are left over from previous elements */
+	int num_attributes;
+
+	/* reads the next chunk of the file into the buffer. returns false at end of file */
+	bool refill();
+	/* returns the next character without consuming it (EOF at end of file) */
+	int peek();
+	/* consumes and returns the next character (EOF at end of file) */
+	int get();
+	/* consumes characters up to and including the specified terminator */
+	void skip_past(const char *terminator);
+	/* consumes whitespace */
+	void skip_whitespace();
+	/* reads an element/attribute name */
+	void read_name(string &name);
+	/* reads a quoted attribute value, decoding character references */
+	void read_attribute_value(string &value);
+	/* throws an exception that points to the current line of the file */
+	void throw_xml_error(string what) const;
+public:
+	Xml_Stream_Reader(string set_path);
+
+	/* advances to the next start/end element event */
+	e_xml_event next_event();
+
+	/* returns the name of the element of the current event */
+	const string &get_element_name() const;
+	/* returns the value of the specified attribute of the current element, or NULL if the element has no such attribute */
+	const char *find_attribute(const char *name) const;
+	/* returns the value of the specified attribute of the current element. throws if the element has no such attribute */
+	const char *get_attribute(const char *name) const;
+	/* returns the specified attribute converted to an int. throws if the attribute is missing */
+	int get_int_attribute(const char *name) const;
+	/* returns the specified attribute converted to an int, or 'default_value' if the attribute is missing */
+	int get_int_attribute(const char *name, int default_value) const;
+	/* returns the specified attribute converted to a float, or 'default_value' if the attribute is missing */
+	float get_float_attribute(const char *name, float default_value) const;
+};
+
+/* a grid location as read from the XML file */
+class Xml_Grid_Loc{
+public:
+	int x;
+	int y;
+	int block_type_id;
+	int width_offset;
+	int height_offset;
+};
+
+/* what the first pass over the XML file learns. the number of nodes/switches/etc isn't stated up-front in the XML format and
+   edges are listed separately from their nodes, so the file is read twice: the first pass collects the (small) switch, block type
+   and grid structures and counts the edges of each node, and the second pass writes nodes and edges straight into the rr node
+   list and the edge table, which are allocated to their final size in between */
+class Xml_Graph{
+public:
+	int num_nodes;			/* one more than the largest node id */
+	vector<int> num_out_edges;	/* number of out-edges of each node. indexed by node id */
+	vector<int> fan_in;		/* number of in-edges of each node. indexed by node id */
+	int max_switch_id;		/* largest switch id used by an edge */
+
+	vector<RR_Switch_Inf> switches;
+	vector<bool> switch_defined;
+	vector<Physical_Type_Descriptor> block_types;
+	vector<bool> block_type_defined;
+	vector<Xml_Grid_Loc> grid_locs;
+
+	Xml_Graph();
+};
+
+
+/**** Function Declarations ****/
+/* first pass over the XML file: reads switches, block types and grid locations into 'graph', and counts the nodes and the edges of each node */
+static void read_xml_elements(Xml_Stream_Reader &xml, Xml_Graph &graph);
+/* counts an <edge> element into the edge counts of its nodes */
+static void count_edge_element(Xml_Stream_Reader &xml, Xml_Graph &graph);
+/* second pass over the XML file: reads nodes and edges straight into the (already allocated) rr nodes and out-edge table */
+static void read_xml_nodes_and_edges(Xml_Stream_Reader &xml, Xml_Graph &graph, Routing_Structs *routing_structs);
+/* reads a <node> element into the corresponding rr node. returns the node's id */
+static int read_node_element(Xml_Stream_Reader &xml, Xml_Graph &graph, t_rr_node &rr_node, vector<bool> &node_defined);
+/* reads a <loc> element belonging to the specified node */
+static void read_loc_element(Xml_Stream_Reader &xml, RR_Node &node);
+/* reads a <switch> element. returns the switch's id */
+static int read_switch_element(Xml_Stream_Reader &xml, Xml_Graph &graph);
+/* reads a <block_type> element. returns the block type's id */
+static int read_block_type_element(Xml_Stream_Reader &xml, Xml_Graph &graph);
+/* reads a <pin_class> element belonging to the specified block type. returns the index of the new class */
+static int read_pin_class_element(Xml_Stream_Reader &xml, Physical_Type_Descriptor &block_type);
+/* returns the rr type corresponding to the specified string */
+static e_rr_type get_rr_type_from_string(const char *type_str);
+/* returns the direction corresponding to the specified string. non-directional nodes are treated as bidirectional */
+static e_direction get_direction_from_string(const char *direction_str);
+/* creates Wotan's rr switch structures from the read switches */
+static void create_rr_switch_inf(Xml_Graph &graph, Routing_Structs *routing_structs);
+/* creates Wotan's block type structures from the read block types. derives pin counts and the pin-to-class lookup */
+static void create_block_type(Xml_Graph &graph, Arch_Structs *arch_structs);
+/* creates Wotan's grid structure from the read grid locations */
+static void create_grid(Xml_Graph &graph, Arch_Structs *arch_structs);
+/* allocates Wotan's rr nodes and out-edge table according to the node and edge counts of the first pass, and fills them in
+   during a second pass over the file. node fan-ins are derived from the edges */
+static void create_rr_node(string rr_graph_file, Xml_Graph &graph, Routing_Structs *routing_structs);
+/* creates the rr node indices, following VPR's conventions: source/sink nodes are indexed by class and ipin/opin nodes by pin
+   (the SOURCE/SINK and IPIN/OPIN lookups are shared), and channel nodes are indexed by track at each location they span */
+static void create_rr_node_index(Arch_Structs *arch_structs, Routing_Structs *routing_structs);
+/* the XML format doesn't mark global pins. a block pin is taken to be global if it has pin nodes in the graph, but none of them
+   connect to the routing */
+static void set_global_pins(Arch_Structs *arch_structs, Routing_Structs *routing_structs);
+
+
+/**** Function Definitions ****/
+/* Parses the specified VPR rr graph XML file into Wotan's architecture and routing structures. As with a dumped rr structs file,
+   reverse edges and virtual sources still need to be created afterwards */
+void parse_rr_graph_xml( std::string rr_graph_file, Arch_Structs *arch_structs, Routing_Structs *routing_structs ){
+
+	cout << "Parsing rr graph XML file (" << rr_graph_file << ")" << endl;
+
+	Xml_Graph graph;
+	{
+		Xml_Stream_Reader xml(rr_graph_file);
+		read_xml_elements(xml, graph);
+	}
+
+	create_rr_switch_inf(graph, routing_structs);
+	create_block_type(graph, arch_structs);
+	create_grid(graph, arch_structs);
+	create_rr_node(rr_graph_file, graph, routing_structs);
+	create_rr_node_index(arch_structs, routing_structs);
+	set_global_pins(arch_structs, routing_structs);
+}
+
+/* first pass over the XML file: reads switches, block types and grid locations into 'graph', and counts the nodes and the edges of each node */
+static void read_xml_elements(Xml_Stream_Reader &xml, Xml_Graph &graph){
+
+	/* elements that are currently open. the <timing> element, for example, means different things inside <node> and <switch> */
+	int switch_id = UNDEFINED;
+	int block_type_id = UNDEFINED;
+	int class_ind = UNDEFINED;
+
+	e_xml_event event;
+	while ( (event = xml.next_event()) != XML_END_OF_FILE ){
+		const string &name = xml.get_element_name();
+
+		if (event == XML_START_ELEMENT){
+			if (name == "node"){
+				int id = xml.get_int_attribute("id");
+				if (id < 0){
+					WTHROW(EX_INIT, "Negative rr node id: " << id);
+				}
+				graph.num_nodes = max(graph.num_nodes, id+1);
+			} else if (name == "edge"){
+				count_edge_element(xml, graph);
+			} else if (name == "switch"){
+				switch_id = read_switch_element(xml, graph);
+			} else if (name == "timing" && switch_id != UNDEFINED){
+				RR_Switch_Inf &rr_switch = graph.switches[switch_id];
+				rr_switch.set_R( xml.get_float_attribute("R", 0) );
+				rr_switch.set_Cin( xml.get_float_attribute("Cin", 0) );
+				rr_switch.set_Cout( xml.get_float_attribute("Cout", 0) );
+				rr_switch.set_Tdel( xml.get_float_attribute("Tdel", 0) );
+			} else if (name == "sizing" && switch_id != UNDEFINED){
+				RR_Switch_Inf &rr_switch = graph.switches[switch_id];
+				rr_switch.set_mux_trans_size( xml.get_float_attribute("mux_trans_size", 0) );
+				rr_switch.set_buf_size( xml.get_float_attribute("buf_size", 0) );
+			} else if (name == "block_type"){
+				block_type_id = read_block_type_element(xml, graph);
+			} else if (name == "pin_class" && block_type_id != UNDEFINED){
+				class_ind = read_pin_class_element(xml, graph.block_types[block_type_id]);
+			} else if (name == "pin" && class_ind != UNDEFINED){
+				int ptc = xml.get_int_attribute("ptc");
+				if (ptc < 0){
+					WTHROW(EX_INIT, "Block type " << block_type_id << " has a pin with a negative ptc number: " << ptc);
+				}
+				graph.block_types[block_type_id].class_inf[class_ind].pinlist.push_back(ptc);
+			} else if (name == "grid_loc"){
+				Xml_Grid_Loc grid_loc;
+				grid_loc.x = xml.get_int_attribute("x");
+				grid_loc.y = xml.get_int_attribute("y");
+				grid_loc.block_type_id = xml.get_int_attribute("block_type_id");
+				grid_loc.width_offset = xml.get_int_attribute("width_offset", 0);
+				grid_loc.height_offset = xml.get_int_attribute("height_offset", 0);
+				graph.grid_locs.push_back(grid_loc);
+			}
+		} else {
+			if (name == "switch"){
+				switch_id = UNDEFINED;
+			} else if (name == "block_type"){
+				block_type_id = UNDEFINED;
+			} else if (name == "pin_class"){
+				class_ind = UNDEFINED;
+			}
+		}
+	}
+}
+
+/* counts an <edge> element into the edge counts of its nodes */
+static void count_edge_element(Xml_Stream_Reader &xml, Xml_Graph &graph){
+	int src_node = xml.get_int_attribute("src_node");
+	int sink_node = xml.get_int_attribute("sink_node");
+	int switch_id = xml.get_int_attribute("switch_id");
+	if (src_node < 0 || sink_node < 0){
+		WTHROW(EX_INIT, "rr edge from node " << src_node << " to node " << sink_node << " refers to a negative node id");
+	}
+	if (switch_id < 0){
+		WTHROW(EX_INIT, "rr edge from node " << src_node << " to node " << sink_node << " uses unknown switch " << switch_id);
+	}
+
+	int max_node = max(src_node, sink_node);
+	if (max_node >= (int)graph.num_out_edges.size()){
+		graph.num_out_edges.resize(max_node+1, 0);
+		graph.fan_in.resize(max_node+1, 0);
+	}
+	graph.num_out_edges[src_node]++;
+	graph.fan_in[sink_node]++;
+	graph.max_switch_id = max(graph.max_switch_id, switch_id);
+}
+
+/* second pass over the XML file: reads nodes and edges straight into the (already allocated) rr nodes and out-edge table */
+static void read_xml_nodes_and_edges(Xml_Stream_Reader &xml, Xml_Graph &graph, Routing_Structs *routing_structs){
+	t_rr_node &rr_node = routing_structs->rr_node;
+	RR_Edge_Table &out_table = routing_structs->out_edge_table;
+
+	vector<bool> node_defined(graph.num_nodes, false);
+
+	/* edges of a node keep the order in which they appear in the file */
+	vector<int> next_edge(out_table.offsets.begin(), out_table.offsets.end()-1);
+
+	int node_id = UNDEFINED;
+
+	e_xml_event event;
+	while ( (event = xml.next_event()) != XML_END_OF_FILE ){
+		const string &name = xml.get_element_name();
+
+		if (event == XML_START_ELEMENT){
+			if (name == "node"){
+				node_id = read_node_element(xml, graph, rr_node, node_defined);
+			} else if (name == "loc" && node_id != UNDEFINED){
+				read_loc_element(xml, rr_node[node_id]);
+			} else if (name == "timing" && node_id != UNDEFINED){
+				rr_node[node_id].set_R( xml.get_float_attribute("R", 0) );
+				rr_node[node_id].set_C( xml.get_float_attribute("C", 0) );
+			} else if (name == "edge"){
+				int src_node = xml.get_int_attribute("src_node");
+				int ind = next_edge[src_node]++;
+				out_table.edges[ind] = xml.get_int_attribute("sink_node");
+				out_table.switches[ind] = (short)xml.get_int_attribute("switch_id");
+			}
+		} else if (name == "node"){
+			node_id = UNDEFINED;
+		}
+	}
+
+	for (int inode = 0; inode < graph.num_nodes; inode++){
+		if (!node_defined[inode]){
+			WTHROW(EX_INIT, "Expected rr node ids to be contiguous, but node " << inode << " is missing");
+		}
+	}
+}
+
+/* reads a <node> element into the corresponding rr node. returns the node's id */
+static int read_node_element(Xml_Stream_Reader &xml, Xml_Graph &graph, t_rr_node &rr_node, vector<bool> &node_defined){
+	int id = xml.get_int_attribute("id");
+
+	if (node_defined[id]){
+		WTHROW(EX_INIT, "rr node " << id << " is defined more than once");
+	}
+	node_defined[id] = true;
+
+	RR_Node &node = rr_node[id];
+	node.set_rr_type( get_rr_type_from_string( xml.get_attribute("type") ) );
+
+	/* defaults for the parts of a node that are optional in the file */
+	node.set_coordinates(0, 0, 0, 0);
+	node.set_ptc_num(UNDEFINED);
+	node.set_R(0);
+	node.set_C(0);
+
+	const char *direction_str = xml.find_attribute("direction");
+	if (direction_str != NULL){
+		node.set_direction( get_direction_from_string(direction_str) );
+	} else {
+		node.set_direction(BI_DIRECTION);
+	}
+
+	node.set_fan_in( (short)graph.fan_in[id] );
+
+	return id;
+}
+
+/* reads a <loc> element belonging to the specified node */
+static void read_loc_element(Xml_Stream_Reader &xml, RR_Node &node){
+	node.set_coordinates( (short)xml.get_int_attribute("xlow"), (short)xml.get_int_attribute("ylow"),
+	                      (short)xml.get_int_attribute("xhigh"), (short)xml.get_int_attribute("yhigh") );
+	node.set_ptc_num( (short)xml.get_int_attribute("ptc") );
+}
+
+/* reads a <switch> element. returns the switch's id */
+static int read_switch_element(Xml_Stream_Reader &xml, Xml_Graph &graph){
+	int id = xml.get_int_attribute("id");
+	if (id < 0 || id > SHRT_MAX){
+		WTHROW(EX_INIT, "rr switch id out of range: " << id);
+	}
+
+	if (id >= (int)graph.switches.size()){
+		graph.switches.resize(id+1);
+		graph.switch_defined.resize(id+1, false);
+	}
+	if (graph.switch_defined[id]){
+		WTHROW(EX_INIT, "rr switch " << id << " is defined more than once");
+	}
+	graph.switch_defined[id] = true;
+
+	/* newer VPR versions give the switch type, older ones say whether the switch is buffered */
+	bool buffered;
+	const char *type_str = xml.find_attribute("type");
+	if (type_str != NULL){
+		buffered = (0 == strcmp(type_str, "mux") || 0 == strcmp(type_str, "tristate") || 0 == strcmp(type_str, "buffer"));
+	} else {
+		buffered = (bool)xml.get_int_attribute("buffered", 1);
+	}
+	graph.switches[id].set_buffered(buffered);
+
+	return id;
+}
+
+/* reads a <block_type> element. returns the block type's id */
+static int read_block_type_element(Xml_Stream_Reader &xml, Xml_Graph &graph){
+	int id = xml.get_int_attribute("id");
+	if (id < 0){
+		WTHROW(EX_INIT, "Negative block type id: " << id);
+	}
+
+	if (id >= (int)graph.block_types.size()){
+		graph.block_types.resize(id+1);
+		graph.block_type_defined.resize(id+1, false);
+	}
+	if (graph.block_type_defined[id]){
+		WTHROW(EX_INIT, "Block type " << id << " is defined more than once");
+	}
+	graph.block_type_defined[id] = true;
+
+	Physical_Type_Descriptor &block_type = graph.block_types[id];
+	block_type.set_name( string(xml.get_attribute("name")) );
+	block_type.set_index(id);
+	block_type.set_width( xml.get_int_attribute("width", 1) );
+	block_type.set_height( xml.get_int_attribute("height", 1) );
+
+	return id;
+}
+
+/* reads a <pin_class> element belonging to the specified block type. returns the index of the new class */
+static int read_pin_class_element(Xml_Stream_Reader &xml, Physical_Type_Descriptor &block_type){
+	const char *type_str = xml.get_attribute("type");
+
+	e_pin_type pin_type;
+	if (0 == strcmp(type_str, "OUTPUT")){
+		pin_type = DRIVER;
+	} else if (0 == strcmp(type_str, "INPUT")){
+		pin_type = RECEIVER;
+	} else if (0 == strcmp(type_str, "OPEN")){
+		pin_type = OPEN;
+	} else {
+		WTHROW(EX_INIT, "Unexpected pin class type: " << type_str);
+	}
+
+	block_type.class_inf.push_back( Pin_Class() );
+	block_type.class_inf.back().set_pin_type(pin_type);
+
+	return (int)block_type.class_inf.size() - 1;
+}
+
+/* returns the rr type corresponding to the specified string */
+static e_rr_type get_rr_type_from_string(const char *type_str){
+	for (int itype = 0; itype < NUM_RR_TYPES; itype++){
+		if (g_rr_type_string[itype] == type_str){
+			return (e_rr_type)itype;
+		}
+	}
+	WTHROW(EX_INIT, "Unexpected rr_type: " << type_str);
+}
+
+/* returns the direction corresponding to the specified string. non-directional nodes are treated as bidirectional */
+static e_direction get_direction_from_string(const char *direction_str){
+	e_direction direction;
+	if (0 == strcmp(direction_str, "INC_DIR")){
+		direction = INC_DIRECTION;
+	} else if (0 == strcmp(direction_str, "DEC_DIR")){
+		direction = DEC_DIRECTION;
+	} else if (0 == strcmp(direction_str, "BI_DIR") || 0 == strcmp(direction_str, "NONE")){
+		direction = BI_DIRECTION;
+	} else {
+		WTHROW(EX_INIT, "Unexpected rr node direction: " << direction_str);
+	}
+	return direction;
+}
+
+/* creates Wotan's rr switch structures from the read switches */
+static void create_rr_switch_inf(Xml_Graph &graph, Routing_Structs *routing_structs){
+	int num_switches = (int)graph.switches.size();
+	for (int iswitch = 0; iswitch < num_switches; iswitch++){
+		if (!graph.switch_defined[iswitch]){
+			WTHROW(EX_INIT, "Expected rr switch ids to be contiguous, but switch " << iswitch << " is missing");
+		}
+	}
+
+	routing_structs->rr_switch_inf.swap(graph.switches);
+}
+
+/* creates Wotan's block type structures from the read block types. derives pin counts and the pin-to-class lookup */
+static void create_block_type(Xml_Graph &graph, Arch_Structs *arch_structs){
+	int num_block_types = (int)graph.block_types.size();
+	for (int itype = 0; itype < num_block_types; itype++){
+		if (!graph.block_type_defined[itype]){
+			WTHROW(EX_INIT, "Expected block type ids to be contiguous, but block type " << itype << " is missing");
+		}
+
+		Physical_Type_Descriptor &block_type = graph.block_types[itype];
+		int num_classes = (int)block_type.class_inf.size();
+
+		/* pins are numbered by their ptc */
+		int num_pins = 0;
+		int num_drivers = 0;
+		int num_receivers = 0;
+		for (int iclass = 0; iclass < num_classes; iclass++){
+			Pin_Class &pin_class = block_type.class_inf[iclass];
+			for (int ipin = 0; ipin < pin_class.get_num_pins(); ipin++){
+				num_pins = max(num_pins, pin_class.pinlist[ipin]+1);
+			}
+
+			if (pin_class.get_pin_type() == DRIVER){
+				num_drivers += pin_class.get_num_pins();
+			} else if (pin_class.get_pin_type() == RECEIVER){
+				num_receivers += pin_class.get_num_pins();
+			}
+		}
+		block_type.set_num_pins(num_pins);
+		block_type.set_num_drivers(num_drivers);
+		block_type.set_num_receivers(num_receivers);
+
+		block_type.pin_class.assign(num_pins, UNDEFINED);
+		for (int iclass = 0; iclass < num_classes; iclass++){
+			Pin_Class &pin_class = block_type.class_inf[iclass];
+			for (int ipin = 0; ipin < pin_class.get_num_pins(); ipin++){
+				int pin = pin_class.pinlist[ipin];
+				if (block_type.pin_class[pin] != UNDEFINED){
+					WTHROW(EX_INIT, "Pin " << pin << " of block type " << block_type.get_name() << " belongs to more than one pin class");
+				}
+				block_type.pin_class[pin] = iclass;
+			}
+		}
+
+		/* determined once the rr nodes have been created */
+		block_type.is_global_pin.assign(num_pins, false);
+	}
+
+	arch_structs->block_type.swap(graph.block_types);
+}
+
+/* creates Wotan's grid structure from the read grid locations */
+static void create_grid(Xml_Graph &graph, Arch_Structs *arch_structs){
+	int x_size = 0;
+	int y_size = 0;
+	int num_grid_locs = (int)graph.grid_locs.size();
+	for (int iloc = 0; iloc < num_grid_locs; iloc++){
+		Xml_Grid_Loc &grid_loc = graph.grid_locs[iloc];
+		if (grid_loc.x < 0 || grid_loc.y < 0){
+			WTHROW(EX_INIT, "Negative grid location: x " << grid_loc.x << ", y " << grid_loc.y);
+		}
+		x_size = max(x_size, grid_loc.x+1);
+		y_size = max(y_size, grid_loc.y+1);
+	}
+
+	if (num_grid_locs != x_size*y_size){
+		WTHROW(EX_INIT, "Expected to find " << x_size*y_size << " grid elements, but found " << num_grid_locs);
+	}
+
+	arch_structs->alloc_and_create_grid(x_size, y_size);
+	t_grid &grid = arch_structs->grid;
+
+	vector< vector<bool> > loc_defined;
+	loc_defined.assign(x_size, vector<bool>(y_size, false));
+
+	int num_block_types = arch_structs->get_num_block_types();
+	for (int iloc = 0; iloc < num_grid_locs; iloc++){
+		Xml_Grid_Loc &grid_loc = graph.grid_locs[iloc];
+		if (loc_defined[grid_loc.x][grid_loc.y]){
+			WTHROW(EX_INIT, "Grid location x " << grid_loc.x << ", y " << grid_loc.y << " is defined more than once");
+		}
+		loc_defined[grid_loc.x][grid_loc.y] = true;
+
+		if (grid_loc.block_type_id < 0 || grid_loc.block_type_id >= num_block_types){
+			WTHROW(EX_INIT, "Grid location x " << grid_loc.x << ", y " << grid_loc.y << " has an unknown block type id: " << grid_loc.block_type_id);
+		}
+
+		Grid_Tile &tile = grid[grid_loc.x][grid_loc.y];
+		tile.set_type_index(grid_loc.block_type_id);
+		tile.set_width_offset(grid_loc.width_offset);
+		tile.set_height_offset(grid_loc.height_offset);
+	}
+
+	/* determine what the block 'fill' type is for the grid (i.e. which block type index corresponds to the logic block) */
+	arch_structs->set_fill_type();
+}
+
+/* allocates Wotan's rr nodes and out-edge table according to the node and edge counts of the first pass, and fills them in
+   during a second pass over the file. node fan-ins are derived from the edges */
+static void create_rr_node(string rr_graph_file, Xml_Graph &graph, Routing_Structs *routing_structs){
+	int num_rr_nodes = graph.num_nodes;
+	int num_switches = (int)routing_structs->rr_switch_inf.size();
+
+	if ((int)graph.num_out_edges.size() > num_rr_nodes){
+		WTHROW(EX_INIT, "rr edges refer to node " << graph.num_out_edges.size()-1 << ", which is out of range of the " <<
+		                num_rr_nodes << " rr nodes");
+	}
+	if (graph.max_switch_id >= num_switches){
+		WTHROW(EX_INIT, "rr edges use unknown switch " << graph.max_switch_id);
+	}
+	graph.num_out_edges.resize(num_rr_nodes, 0);
+	graph.fan_in.resize(num_rr_nodes, 0);
+
+	for (int inode = 0; inode < num_rr_nodes; inode++){
+		if (graph.num_out_edges[inode] > SHRT_MAX || graph.fan_in[inode] > SHRT_MAX){
+			WTHROW(EX_INIT, "rr node " << inode << " has more edges than Wotan supports (" << SHRT_MAX << ")");
+		}
+	}
+
+	routing_structs->alloc_and_create_rr_node(num_rr_nodes);
+	routing_structs->out_edge_table.alloc_from_edge_counts(graph.num_out_edges);
+
+	/* the edge counts were all the first pass needed to keep of the nodes and edges */
+	vector<int>().swap(graph.num_out_edges);
+	{
+		Xml_Stream_Reader xml(rr_graph_file);
+		read_xml_nodes_and_edges(xml, graph, routing_structs);
+	}
+	vector<int>().swap(graph.fan_in);
+
+	routing_structs->link_rr_node_edges();
+}
+
+/* creates the rr node indices, following VPR's conventions: source/sink nodes are indexed by class and ipin/opin nodes by pin
+   (the SOURCE/SINK and IPIN/OPIN lookups are shared), and channel nodes are indexed by track at each location they span */
+static void create_rr_node_index(Arch_Structs *arch_structs, Routing_Structs *routing_structs){
+	int grid_size_x, grid_size_y;
+	arch_structs->get_grid_size(&grid_size_x, &grid_size_y);
+
+	routing_structs->alloc_and_create_rr_node_index(NUM_RR_TYPES, grid_size_x, grid_size_y);
+	t_rr_node_index &rr_node_index = routing_structs->rr_node_index;
+
+	int num_rr_nodes = routing_structs->get_num_rr_nodes();
+	for (int inode = 0; inode < num_rr_nodes; inode++){
+		RR_Node &node = routing_structs->rr_node[inode];
+
+		e_rr_type index_type = node.get_rr_type();
+		if (index_type == SINK){
+			index_type = SOURCE;
+		} else if (index_type == OPIN){
+			index_type = IPIN;
+		}
+
+		int ptc = node.get_ptc_num();
+		if (ptc < 0){
+			WTHROW(EX_INIT, "rr node " << inode << " has a negative ptc number: " << ptc);
+		}
+
+		for (int ix = node.get_xlow(); ix <= node.get_xhigh(); ix++){
+			for (int iy = node.get_ylow(); iy <= node.get_yhigh(); iy++){
+				if (ix < 0 || ix >= grid_size_x || iy < 0 || iy >= grid_size_y){
+					WTHROW(EX_INIT, "rr node " << inode << " lies outside of the " << grid_size_x << "x" << grid_size_y << " grid");
+				}
+
+				vector<int> &index_nodes = rr_node_index[index_type][ix][iy];
+				if ((int)index_nodes.size() <= ptc){
+					index_nodes.resize(ptc+1, UNDEFINED);
+				}
+				if (index_nodes[ptc] != UNDEFINED){
+					WTHROW(EX_INIT, "rr nodes " << index_nodes[ptc] << " and " << inode << " have the same " << g_rr_type_string[index_type] <<
+					                " index at x " << ix << ", y " << iy << ", ptc " << ptc);
+				}
+				index_nodes[ptc] = inode;
+			}
+		}
+	}
+
+	rr_node_index[SINK] = rr_node_index[SOURCE];
+	rr_node_index[OPIN] = rr_node_index[IPIN];
+}
+
+/* the XML format doesn't mark global pins. a block pin is taken to be global if it has pin nodes in the graph, but none of them
+   connect to the routing */
+static void set_global_pins(Arch_Structs *arch_structs, Routing_Structs *routing_structs){
+	int num_block_types = arch_structs->get_num_block_types();
+
+	vector< vector<bool> > has_node(num_block_types);
+	vector< vector<bool> > is_connected(num_block_types);
+	for (int itype = 0; itype < num_block_types; itype++){
+		int num_pins = arch_structs->block_type[itype].get_num_pins();
+		has_node[itype].assign(num_pins, false);
+		is_connected[itype].assign(num_pins, false);
+	}
+
+	int num_rr_nodes = routing_structs->get_num_rr_nodes();
+	for (int inode = 0; inode < num_rr_nodes; inode++){
+		RR_Node &node = routing_structs->rr_node[inode];
+		e_rr_type rr_type = node.get_rr_type();
+		if (rr_type != IPIN && rr_type != OPIN){
+			continue;
+		}
+
+		int itype = arch_structs->grid[node.get_xlow()][node.get_ylow()].get_type_index();
+		int pin = node.get_ptc_num();
+		if (pin >= arch_structs->block_type[itype].get_num_pins()){
+			WTHROW(EX_INIT, "rr node " << inode << " refers to pin " << pin << " of block type " << arch_structs->block_type[itype].get_name() <<
+			                " which only has " << arch_structs->block_type[itype].get_num_pins() << " pins");
+		}
+
+		has_node[itype][pin] = true;
+		if ((rr_type == IPIN && node.get_fan_in() > 0) || (rr_type == OPIN && node.get_num_out_edges() > 0)){
+			is_connected[itype][pin] = true;
+		}
+	}
+
+	for (int itype = 0; itype < num_block_types; itype++){
+		Physical_Type_Descriptor &block_type = arch_structs->block_type[itype];
+		for (int ipin = 0; ipin < block_type.get_num_pins(); ipin++){
+			block_type.is_global_pin[ipin] = has_node[itype][ipin] && !is_connected[itype][ipin];
+		}
+	}
+}
+
+
+/*==== Xml_Stream_Reader Class ====*/
+Xml_Stream_Reader::Xml_Stream_Reader(string set_path){
+	this->path = set_path;
+	open_file(&this->file, set_path, ios::in | ios::binary);
+
+	this->buffer.assign(XML_READ_BUFFER_SIZE, 0);
+	this->buffer_pos = 0;
+	this->buffer_end = 0;
+	this->line_num = 1;
+
+	this->pending_end = false;
+	this->num_attributes = 0;
+}
+
+/* reads the next chunk of the file into the buffer. returns false at end of file */
+bool Xml_Stream_Reader::refill(){
+	this->buffer_pos = 0;
+	this->buffer_end = 0;
+	if (this->file.good()){
+		this->file.read(&this->buffer[0], this->buffer.size());
+		this->buffer_end = (size_t)this->file.gcount();
+	}
+	return this->buffer_end > 0;
+}
+
+/* returns the next character without consuming it (EOF at end of file) */
+int Xml_Stream_Reader::peek(){
+	if (this->buffer_pos == this->buffer_end && !this->refill()){
+		return EOF;
+	}
+	return (unsigned char)this->buffer[this->buffer_pos];
+}
+
+/* consumes and returns the next character (EOF at end of file) */
+int Xml_Stream_Reader::get(){
+	if (this->buffer_pos == this->buffer_end && !this->refill()){
+		return EOF;
+	}
+	char c = this->buffer[this->buffer_pos++];
+	if (c == '\n'){
+		this->line_num++;
+	}
+	return (unsigned char)c;
+}
+
+/* consumes characters up to and including the specified terminator */
+void Xml_Stream_Reader::skip_past(const char *terminator){
+	int length = (int)strlen(terminator);
+	char window[MAX_XML_TERMINATOR_LENGTH] = {0};
+
+	/* keep the last 'length' characters in a window -- terminators such as "-->" can partially overlap with themselves */
+	int num_read = 0;
+	while (true){
+		int c = this->get();
+		if (c == EOF){
+			this->throw_xml_error(string("Unexpected end of file while looking for '") + terminator + "'");
+		}
+		memmove(window, window+1, length-1);
+		window[length-1] = (char)c;
+		num_read++;
+
+		if (num_read >= length && 0 == memcmp(window, terminator, length)){
+			break;
+		}
+	}
+}
+
+/* consumes whitespace */
+void Xml_Stream_Reader::skip_whitespace(){
+	int c = this->peek();
+	while (c == ' ' || c == '\t' || c == '\n' || c == '\r'){
+		this->get();
+		c = this->peek();
+	}
+}
+
+/* reads an element/attribute name */
+void Xml_Stream_Reader::read_name(string &name){
+	name.clear();
+	int c = this->peek();
+	while (c != EOF && c != ' ' && c != '\t' && c != '\n' && c != '\r' && c != '=' && c != '/' && c != '>'){
+		name += (char)this->get();
+		c = this->peek();
+	}
+
+	if (name.empty()){
+		this->throw_xml_error("Expected an element or attribute name");
+	}
+}
+
+/* reads a quoted attribute value, decoding character references */
+void Xml_Stream_Reader::read_attribute_value(string &value){
+	value.clear();
+	int quote = this->get();
+	if (quote != '"' && quote != '\''){
+		this->throw_xml_error("Expected a quoted attribute value");
+	}
+
+	int c = this->get();
+	while (c != quote){
+		if (c == EOF){
+			this->throw_xml_error("Unexpected end of file inside an attribute value");
+		}
+
+		if (c == '&'){
+			/* character reference */
+			string ref;
+			c = this->get();
+			while (c != ';'){
+				if (c == EOF || ref.size() > 8){
+					this->throw_xml_error("Malformed character reference in attribute value");
+				}
+				ref += (char)c;
+				c = this->get();
+			}
+
+			if (ref == "lt"){
+				value += '<';
+			} else if (ref == "gt"){
+				value += '>';
+			} else if (ref == "amp"){
+				value += '&';
+			} else if (ref == "quot"){
+				value += '"';
+			} else if (ref == "apos"){
+				value += '\'';
+			} else if (ref.size() > 1 && ref[0] == '#'){
+				long code;
+				if (ref[1] == 'x'){
+					code = strtol(ref.c_str()+2, NULL, 16);
+				} else {
+					code = strtol(ref.c_str()+1, NULL, 10);
+				}
+				/* names/numbers that Wotan cares about are plain ASCII */
+				if (code > 0 && code < 128){
+					value += (char)code;
+				} else {
+					value += "&" + ref + ";";
+				}
+			} else {
+				this->throw_xml_error("Unknown entity '&" + ref + ";' in attribute value");
+			}
+		} else {
+			value += (char)c;
+		}
+		c = this->get();
+	}
+}
+
+/* throws an exception that points to the current line of the file */
+void Xml_Stream_Reader::throw_xml_error(string what) const{
+	WTHROW(EX_INIT, what << " (" << this->path << ", line " << this->line_num << ")");
+}
+
+/* advances to the next start/end element event */
+e_xml_event Xml_Stream_Reader::next_event(){
+	if (this->pending_end){
+		this->pending_end = false;
+		this->num_attributes = 0;
+		return XML_END_ELEMENT;
+	}
+
+	while (true){
+		/* skip character data up to the next markup */
+		int c = this->get();
+		while (c != EOF && c != '<'){
+			c = this->get();
+		}
+		if (c == EOF){
+			return XML_END_OF_FILE;
+		}
+
+		c = this->peek();
+		if (c == '?'){
+			/* processing instruction / XML declaration */
+			this->skip_past("?>");
+			continue;
+		} else if (c == '!'){
+			this->get();
+			c = this->peek();
+			if (c == '-'){
+				/* comment */
+				this->skip_past("-->");
+			} else if (c == '['){
+				/* CDATA section */
+				this->skip_past("]]>");
+			} else {
+				/* DTD */
+				this->skip_past(">");
+			}
+			continue;
+		} else if (c == '/'){
+			/* end tag */
+			this->get();
+			this->read_name(this->element_name);
+			this->skip_past(">");
+			this->num_attributes = 0;
+			return XML_END_ELEMENT;
+		}
+
+		/* start tag */
+		this->read_name(this->element_name);
+		this->num_attributes = 0;
+		while (true){
+			this->skip_whitespace();
+			c = this->peek();
+			if (c == '>'){
+				this->get();
+				return XML_START_ELEMENT;
+			} else if (c == '/'){
+				this->get();
+				if (this->get() != '>'){
+					this->throw_xml_error("Expected '>' after '/' in tag <" + this->element_name + ">");
+				}
+				this->pending_end = true;
+				return XML_START_ELEMENT;
+			} else if (c == EOF){
+				this->throw_xml_error("Unexpected end of file inside tag <" + this->element_name + ">");
+			}
+
+			/* attribute -- reuse the strings of previous elements' attributes */
+			if ((int)this->attributes.size() <= this->num_attributes){
+				this->attributes.push_back( Xml_Attribute() );
+			}
+			Xml_Attribute &attribute = this->attributes[this->num_attributes];
+			this->read_name(attribute.name);
+			this->skip_whitespace();
+			if (this->get() != '='){
+				this->throw_xml_error("Expected '=' after attribute '" + attribute.name + "' of tag <" + this->element_name + ">");
+			}
+			this->skip_whitespace();
+			this->read_attribute_value(attribute.value);
+			this->num_attributes++;
+		}
+	}
+}
+
+/* returns the name of the element of the current event */
+const string &Xml_Stream_Reader::get_element_name() const{
+	return this->element_name;
+}
+
+/* returns the value of the specified attribute of the current element, or NULL if the element has no such attribute */
+const char *Xml_Stream_Reader::find_attribute(const char *name) const{
+	for (int iattr = 0; iattr < this->num_attributes; iattr++){
+		if (this->attributes[iattr].name == name){
+			return this->attributes[iattr].value.c_str();
+		}
+	}
+	return NULL;
+}
+
+/* returns the value of the specified attribute of the current element. throws if the element has no such attribute */
+const char *Xml_Stream_Reader::get_attribute(const char *name) const{
+	const char *value = this->find_attribute(name);
+	if (value == NULL){
+		this->throw_xml_error("Expected tag <" + this->element_name + "> to have a '" + name + "' attribute");
+	}
+	return value;
+}
+
+/* returns the specified attribute converted to an int. throws if the attribute is missing */
+int Xml_Stream_Reader::get_int_attribute(const char *name) const{
+	const char *value = this->get_attribute(name);
+
+	char *end;
+	long result = strtol(value, &end, 10);
+	if (end == value || *end != '\0' || result < INT_MIN || result > INT_MAX){
+		this->throw_xml_error(string("Expected attribute '") + name + "' of tag <" + this->element_name + "> to be an integer, got '" + value + "'");
+	}
+	return (int)result;
+}
+
+/* returns the specified attribute converted to an int, or 'default_value' if the attribute is missing */
+int Xml_Stream_Reader::get_int_attribute(const char *name, int default_value) const{
+	if (this->find_attribute(name) == NULL){
+		return default_value;
+	}
+	return this->get_int_attribute(name);
+}
+
+/* returns the specified attribute converted to a float, or 'default_value' if the attribute is missing */
+float Xml_Stream_Reader::get_float_attribute(const char *name, float default_value) const{
+	const char *value = this->find_attribute(name);
+	if (value == NULL){
+		return default_value;
+	}
+
+	char *end;
+	float result = strtof(value, &end);
+	if (end == value || *end != '\0'){
+		this->throw_xml_error(string("Expected attribute '") + name + "' of tag <" + this->element_name + "> to be a number, got '" + value + "'");
+	}
+	return result;
+}
+/*==== END Xml_Stream_Reader Class ====*/
+
+
+/*==== Xml_Graph Class ====*/
+Xml_Graph::Xml_Graph(){
+	this->num_nodes = 0;
+	this->max_switch_id = UNDEFINED;
+}
+/*==== END Xml_Graph Class ====*/
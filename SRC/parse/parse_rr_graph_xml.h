@@ -0,0 +1,30 @@
+#ifndef PARSE_RR_GRAPH_XML_H
+#define PARSE_RR_GRAPH_XML_H
+
+#include <string>
+#include "wotan_types.h"
+
+/*
+	Newer versions of VPR write the routing resource graph as an XML file (vpr ... --write_rr_graph rr_graph.xml) rather than
+dumping their internal structures. This reader initializes Wotan's architecture and routing structures from such a file
+(rr structs mode RR_STRUCTS_VPR_XML).
+
+	The file is read in fixed-size chunks and tokenized in a single forward pass -- no document tree is built, so aside from
+the graph itself memory use does not grow with the size of the file. The following elements are used:
+		<switches>     -- <switch id type|buffered> with <timing R Cin Cout Tdel/> and <sizing mux_trans_size buf_size/>
+		<block_types>  -- <block_type id name width height> with <pin_class type> lists of <pin ptc>
+		<grid>         -- <grid_loc x y block_type_id width_offset height_offset/>
+		<rr_nodes>     -- <node id type direction> with <loc xlow ylow xhigh yhigh ptc/> and <timing R C/>
+		<rr_edges>     -- <edge src_node sink_node switch_id/>
+Everything else (channels, segments, metadata, pin names) is skipped. The rr node indices, node fan-ins and per-block-type
+pin counts that are part of the dumped VPR structures are derived from the above.
+*/
+
+
+/**** Function Declarations ****/
+/* Parses the specified VPR rr graph XML file into Wotan's architecture and routing structures. As with a dumped rr structs file,
+   reverse edges and virtual sources still need to be created afterwards */
+void parse_rr_graph_xml( std::string rr_graph_file, Arch_Structs *arch_structs, Routing_Structs *routing_structs );
+
+
+#endif
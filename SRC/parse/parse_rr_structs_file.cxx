@@ -1,9 +1,14 @@
 
 #include <iostream>
-#include <fstream>
 #include <cstring>
 #include <cstdlib>
 #include <cstdio>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "exception.h"
 #include "io.h"
 #include "wotan_types.h"
@@ -13,6 +18,13 @@
 using namespace std;
 
 
+/**** Defines ****/
+/* node sections smaller than this (in bytes) are not worth splitting between threads */
+#define MIN_NODE_CHUNK_SIZE (1 << 20)
+/* longest number token (in characters) that the scanner will convert */
+#define MAX_NUMBER_TOKEN_LENGTH 64
+
+
 /**** Enums ****/
 /* enums for the different sections of the dumped VPR structs file */
 enum e_file_section{
@@ -26,43 +38,126 @@ enum e_file_section{
 };
 
 
+/**** Classes ****/
+/* a read-only memory mapping of the rr structs file. unmapped when the object goes out of scope */
+class Mapped_File{
+private:
+	void *mapping;
+public:
+	const char *data;
+	size_t size;
+
+	Mapped_File(string path);
+	~Mapped_File();
+};
+
+/* Steps through a region of a memory-mapped file. Values are scanned directly out of the mapped text (without copying lines
+   into strings), following the same conventions as the sscanf format strings that the dumped structs file was parsed with before:
+   a space in an expected literal matches any number of spaces/tabs, and everything else has to match exactly */
+class Text_Scanner{
+private:
+	const char *begin;
+	const char *pos;
+	const char *end;
+
+	/* returns pointer to the end of the current line (the '\n' character, or end of the region) */
+	const char *get_line_end() const;
+	/* throws an exception that shows the current line */
+	void throw_scan_error(string what) const;
+public:
+	Text_Scanner(const char *set_begin, const char *set_end);
+
+	/* returns true if the whole region has been consumed */
+	bool at_end() const;
+	/* returns current position within the mapped file */
+	const char *get_pos() const;
+	/* moves to the specified position within the region */
+	void set_pos(const char *new_pos);
+
+	/* copies the current line into 'line' (without the newline) and moves to the next line. returns false if there are no more lines */
+	bool get_line(string &line);
+	/* moves to the start of the next line */
+	void next_line();
+	/* returns true if the current line is exactly 'str' */
+	bool line_is(const char *str) const;
+	/* returns the start of the first line at/after the current position that is exactly 'str', or NULL if there is no such line */
+	const char *find_line(const char *str) const;
+	/* returns the start of the first line at/after 'from' that begins with 'prefix', or NULL if there is no such line */
+	const char *find_line_starting_with(const char *from, const char *prefix) const;
+
+	/* consumes the specified literal (see class comment) */
+	void expect(const char *literal);
+	/* scans an integer */
+	int read_int();
+	/* scans a floating point number */
+	float read_float();
+	/* copies characters into 'buf' until one of the characters in 'delimiters' is hit */
+	void read_token(char *buf, int buf_size, const char *delimiters);
+};
+
+/* a contiguous chunk of the rr node section, parsed by one thread */
+class Node_Chunk{
+public:
+	const char *begin;
+	const char *end;
+	t_rr_node *rr_node;
+	int num_rr_nodes;
+
+	int first_node;		/* index of the first node parsed from this chunk */
+	int num_nodes_parsed;	/* number of nodes parsed from this chunk */
+	vector<int> num_node_edges;	/* number of out-edges of each node parsed from this chunk */
+	vector<int> edges;		/* out-edges of the nodes parsed from this chunk, in order */
+	vector<short> switches;		/* switches used by the above edges */
+	bool failed;		/* true if parsing this chunk threw an exception */
+	string error_message;
+
+	Node_Chunk();
+};
+
+
 /**** Function Declarations ****/
 /* returns the file section which is just about to begin based on that section's 'header' line */
 static e_file_section get_line_section(string header_line);
 /* parses lines of the referenced file, expecting that they belong to the specified section.
    continues parsing until the .end directive is hit. 
    creates the structure(s) into which the section is parsed */
-static void make_struct_and_parse_section(e_file_section section, string header_line, fstream &file, 
-		Arch_Structs *arch_structs, Routing_Structs *routing_structs);
-/* parses rr node section of file into created rr_node structure */
-static void parse_rr_node_section(int num_rr_nodes, t_rr_node &rr_node, fstream &file);
+static void make_struct_and_parse_section(e_file_section section, string header_line, Text_Scanner &file, 
+		Arch_Structs *arch_structs, Routing_Structs *routing_structs, int num_threads);
+/* parses rr node section of file into created rr_node structure and the out-edge table. the section is split into chunks which are parsed in parallel */
+static void parse_rr_node_section(int num_rr_nodes, t_rr_node &rr_node, RR_Edge_Table &out_edge_table, Text_Scanner &file, int num_threads);
+/* thread function. parses the nodes in the specified Node_Chunk */
+static void* parse_rr_node_chunk(void *ptr);
+/* parses a single rr node record (node line + edge list) at the current scanner position. the node's edges and switches are
+   appended to 'edges' and 'switches'. returns the node's index */
+static int parse_rr_node_record(Text_Scanner &scanner, t_rr_node &rr_node, int num_rr_nodes, vector<int> &edges, vector<short> &switches);
 /* parses rr switch section of file into created rr_switch_inf structure */
-static void parse_rr_switch_inf_section(int num_rr_switches, t_rr_switch_inf &rr_switch_inf, fstream &file);
+static void parse_rr_switch_inf_section(int num_rr_switches, t_rr_switch_inf &rr_switch_inf, Text_Scanner &file);
 /* parses block types section of file into created block_type structure */
-static void parse_block_type_section(int num_block_types, t_block_type &block_type, fstream &file);
+static void parse_block_type_section(int num_block_types, t_block_type &block_type, Text_Scanner &file);
 /* parses grid section of file into the created grid structure */
-static void parse_grid_section(int x_size, int y_size, t_grid &grid, fstream &file);
+static void parse_grid_section(int x_size, int y_size, t_grid &grid, Text_Scanner &file);
 /* parses rr node indices section of file into the created rr_node_index structure */
-static void parse_rr_node_index_section(int num_rr_types, int x_size, int y_size, t_rr_node_index &rr_node_index, fstream &file);
+static void parse_rr_node_index_section(int num_rr_types, int x_size, int y_size, t_rr_node_index &rr_node_index, Text_Scanner &file);
 /* checks whether an sscanf function read as many arguments as were expected and throws an exception if not. 'line' is the line that was scanned */
 static void check_expected_vs_read(int num_expected, int num_read, string line);
 
 /**** Function Definitions ****/
-/* Parses the specified rr structs file according the specified rr structs mode */
-void parse_rr_structs_file( std::string rr_structs_file, Arch_Structs *arch_structs, Routing_Structs *routing_structs, e_rr_structs_mode rr_structs_mode ){
+/* Parses the specified rr structs file according the specified rr structs mode. The rr node section is parsed with 'num_threads' threads */
+void parse_rr_structs_file( std::string rr_structs_file, Arch_Structs *arch_structs, Routing_Structs *routing_structs, e_rr_structs_mode rr_structs_mode,
+                            int num_threads ){
 
 	cout << "Parsing structs file (" << rr_structs_file << ") in mode " << g_rr_structs_mode_string[rr_structs_mode] << endl;
 
-	/* open the file for reading */
-	fstream file;
-	open_file(&file, rr_structs_file, ios::in);
+	/* map the file for reading */
+	Mapped_File mapped_file(rr_structs_file);
+	Text_Scanner file(mapped_file.data, mapped_file.data + mapped_file.size);
 
 	/* the rr structs file contains data to fill Wotan's routing and architecture structures. based on the rr_structs_mode, Wotan expects
 	   the rr structs file to contain different subsets of structures (see comment of the e_rr_structs_mode enum) */
 
 	/* step through each line of the rr_structs_file and parse it */
 	string section_line;
-	while ( getline(file, section_line) ){
+	while ( file.get_line(section_line) ){
 		e_file_section section = get_line_section(section_line);
 
 		if (rr_structs_mode == RR_STRUCTS_SIMPLE){
@@ -72,7 +167,7 @@ void parse_rr_structs_file( std::string rr_structs_file, Arch_Structs *arch_stru
 			}
 		}
 
-		make_struct_and_parse_section(section, section_line, file, arch_structs, routing_structs);
+		make_struct_and_parse_section(section, section_line, file, arch_structs, routing_structs, num_threads);
 	}
 }
 
@@ -104,8 +199,8 @@ static e_file_section get_line_section(string header_line){
 /* parses lines of the referenced file, expecting that they belong to the specified section.
    continues parsing until the .end directive is hit. 
    creates the structure(s) into which the section is parsed */
-static void make_struct_and_parse_section(e_file_section section, string header_line, fstream &file, 
-		Arch_Structs *arch_structs, Routing_Structs *routing_structs){
+static void make_struct_and_parse_section(e_file_section section, string header_line, Text_Scanner &file, 
+		Arch_Structs *arch_structs, Routing_Structs *routing_structs, int num_threads){
 
 	/* check which section of the dumped VPR structs file the header line represents, create
 	   the corresponding data structure, and then parse that section */
@@ -117,7 +212,8 @@ static void make_struct_and_parse_section(e_file_section section, string header_
 
 		routing_structs->alloc_and_create_rr_node(num_rr_nodes);
 
-		parse_rr_node_section(num_rr_nodes, rr_node, file);
+		parse_rr_node_section(num_rr_nodes, rr_node, routing_structs->out_edge_table, file, num_threads);
+		routing_structs->link_rr_node_edges();
 
 	} else if (section == SWITCH_SECTION) {
 		/* rr switch inf */
@@ -176,109 +272,236 @@ static void make_struct_and_parse_section(e_file_section section, string header_
 	}
 }
 
-/* parses rr node section of file into created rr_node structure */
-static void parse_rr_node_section(int num_rr_nodes, t_rr_node &rr_node, fstream &file){
+/* parses rr node section of file into created rr_node structure and the out-edge table. the section is split into chunks which are parsed in parallel */
+static void parse_rr_node_section(int num_rr_nodes, t_rr_node &rr_node, RR_Edge_Table &out_edge_table, Text_Scanner &file, int num_threads){
 
-	int inode = 0;
-	string line;
-	getline(file, line);
-	while (line != ".end rr_node"){
-
-		int num_read;
-		int num_expected;
-
-		int node_num;
-		int xlow, ylow, xhigh, yhigh, ptc_num, fan_in;
-		int direction;
-		e_rr_type rr_type;
-		float R, C;
-		char rr_type_buf[20];
+	/* find where the node section ends */
+	const char *section_begin = file.get_pos();
+	const char *section_end = file.find_line(".end rr_node");
+	if (section_end == NULL){
+		WTHROW(EX_INIT, "Could not find the end of the rr node section ('.end rr_node')");
+	}
 
-		/* scan-in values from the line.  */
-		num_expected = 11;
-		num_read = sscanf(line.c_str(), " node_%d: rr_type(%[^()]) xlow(%d) xhigh(%d) ylow(%d) yhigh(%d) ptc_num(%d) fan_in(%d) direction(%d) R(%f) C(%f)",
-				&node_num, rr_type_buf, &xlow, &xhigh, &ylow, &yhigh, &ptc_num, &fan_in, 
-				&direction, &R, &C);
+	/* split the section into roughly equally-sized chunks. each chunk has to start at the beginning of a node record */
+	size_t section_size = (size_t)(section_end - section_begin);
+	int num_chunks = max(1, min(num_threads, (int)(section_size / MIN_NODE_CHUNK_SIZE)));
+
+	vector<Node_Chunk> chunks;
+	const char *chunk_begin = section_begin;
+	for (int ichunk = 0; ichunk < num_chunks; ichunk++){
+		const char *chunk_end = section_end;
+		if (ichunk < num_chunks-1){
+			const char *target = section_begin + (section_size / num_chunks) * (ichunk+1);
+			chunk_end = file.find_line_starting_with(max(target, chunk_begin), " node_");
+			if (chunk_end == NULL || chunk_end > section_end){
+				chunk_end = section_end;
+			}
+		}
 
-		check_expected_vs_read(num_expected, num_read, line);			
+		if (chunk_end > chunk_begin){
+			Node_Chunk chunk;
+			chunk.begin = chunk_begin;
+			chunk.end = chunk_end;
+			chunk.rr_node = &rr_node;
+			chunk.num_rr_nodes = num_rr_nodes;
+			chunks.push_back(chunk);
+		}
+		chunk_begin = chunk_end;
+	}
 
-		/* check rr type */
-		if (0 == strcmp(rr_type_buf, "SINK")){
-			rr_type = SINK;
-		} else if (0 == strcmp(rr_type_buf, "SOURCE")){
-			rr_type = SOURCE;
-		} else if (0 == strcmp(rr_type_buf, "IPIN")){
-			rr_type = IPIN;
-		} else if (0 == strcmp(rr_type_buf, "OPIN")){
-			rr_type = OPIN;
-		} else if (0 == strcmp(rr_type_buf, "CHANX")){
-			rr_type = CHANX;
-		} else if (0 == strcmp(rr_type_buf, "CHANY")){
-			rr_type = CHANY;
-		} else {
-			WTHROW(EX_INIT, "Unexpected rr_type: " << rr_type_buf);
+	/* parse the chunks. the first chunk is parsed by this thread */
+	num_chunks = (int)chunks.size();
+	vector<pthread_t> threads(num_chunks);
+	for (int ichunk = 1; ichunk < num_chunks; ichunk++){
+		int result = pthread_create(&threads[ichunk], NULL, parse_rr_node_chunk, (void*) &chunks[ichunk]);
+		if (result != 0){
+			WTHROW(EX_INIT, "Failed to create thread!");
 		}
+	}
+	if (num_chunks > 0){
+		parse_rr_node_chunk( (void*) &chunks[0] );
+	}
+	for (int ichunk = 1; ichunk < num_chunks; ichunk++){
+		int result = pthread_join(threads[ichunk], NULL);
+		if (result != 0){
+			WTHROW(EX_INIT, "Failed to join thread!");
+		}
+	}
 
-		if (inode != node_num){
+	/* the chunks must have covered the nodes in ascending order by index, without gaps */
+	int next_node = 0;
+	for (int ichunk = 0; ichunk < num_chunks; ichunk++){
+		Node_Chunk &chunk = chunks[ichunk];
+		if (chunk.failed){
+			WTHROW(EX_INIT, chunk.error_message);
+		}
+		if (chunk.num_nodes_parsed > 0 && chunk.first_node != next_node){
 			WTHROW(EX_INIT, "Expected the dumped rr nodes to be in ascending order by index");
 		}
+		next_node += chunk.num_nodes_parsed;
+	}
 
-		/* assign values to rr node */
-		rr_node[inode].set_rr_type(rr_type);
-		rr_node[inode].set_coordinates(xlow, ylow, xhigh, yhigh);
-		rr_node[inode].set_R(R);
-		rr_node[inode].set_C(C);
-		rr_node[inode].set_ptc_num(ptc_num);
-		rr_node[inode].set_fan_in(fan_in);
-
-		rr_node[inode].set_direction((e_direction)direction);
-
-		/* the next line tells us how many edges there are */
-		getline(file, line);
-		int num_edges;
-		sscanf(line.c_str(), "  .edges(%d)", &num_edges);
-
-		/* allocate the edge and switch arrays */
-		rr_node[inode].alloc_out_edges_and_switches(num_edges);
+	/* the chunks' edge lists are in node order, so they just have to be concatenated into the out-edge table */
+	vector<int> num_node_edges(num_rr_nodes, 0);
+	for (int ichunk = 0; ichunk < num_chunks; ichunk++){
+		Node_Chunk &chunk = chunks[ichunk];
+		for (int inode = 0; inode < chunk.num_nodes_parsed; inode++){
+			num_node_edges[chunk.first_node + inode] = chunk.num_node_edges[inode];
+		}
+	}
+	out_edge_table.alloc_from_edge_counts(num_node_edges);
+	for (int ichunk = 0; ichunk < num_chunks; ichunk++){
+		Node_Chunk &chunk = chunks[ichunk];
+		if (chunk.num_nodes_parsed > 0){
+			int offset = out_edge_table.offsets[chunk.first_node];
+			copy(chunk.edges.begin(), chunk.edges.end(), out_edge_table.edges.begin() + offset);
+			copy(chunk.switches.begin(), chunk.switches.end(), out_edge_table.switches.begin() + offset);
+		}
+		vector<int>().swap(chunk.edges);
+		vector<short>().swap(chunk.switches);
+	}
 
-		/* the subsequent lines list all the edges, and which switch an edge uses */
-		int iedge = 0;
-		getline(file, line);
-		while (line != "  .end edges"){
+	/* continue after the '.end rr_node' line */
+	file.set_pos(section_end);
+	file.next_line();
+}
 
-			if (iedge >= num_edges){
-				WTHROW(EX_INIT, "Expected number of edges to not exceed " << num_edges);
+/* thread function. parses the nodes in the specified Node_Chunk */
+static void* parse_rr_node_chunk(void *ptr){
+	Node_Chunk *chunk = (Node_Chunk*)ptr;
+	Text_Scanner scanner(chunk->begin, chunk->end);
+
+	try{
+		while ( !scanner.at_end() ){
+			int num_edges_before = (int)chunk->edges.size();
+			int node_num = parse_rr_node_record(scanner, *chunk->rr_node, chunk->num_rr_nodes, chunk->edges, chunk->switches);
+			chunk->num_node_edges.push_back( (int)chunk->edges.size() - num_edges_before );
+
+			if (chunk->num_nodes_parsed == 0){
+				chunk->first_node = node_num;
+			} else if (node_num != chunk->first_node + chunk->num_nodes_parsed){
+				WTHROW(EX_INIT, "Expected the dumped rr nodes to be in ascending order by index");
 			}
+			chunk->num_nodes_parsed++;
+		}
+	} catch (Wotan_Exception &ex){
+		/* exceptions can't cross the thread boundary -- rethrown by the parent once all threads are joined */
+		chunk->failed = true;
+		chunk->error_message = ex.what();
+	}
 
-			int edge_num, edge, sw;
-
-			num_expected = 3;
-			num_read = sscanf(line.c_str(), "   %d: edge(%d) switch(%d)", &edge_num, &edge, &sw);
+	return (void*) NULL;
+}
 
-			check_expected_vs_read(num_expected, num_read, line);			
+/* parses a single rr node record (node line + edge list) at the current scanner position. the node's edges and switches are
+   appended to 'edges' and 'switches'. returns the node's index */
+static int parse_rr_node_record(Text_Scanner &scanner, t_rr_node &rr_node, int num_rr_nodes, vector<int> &edges, vector<short> &switches){
+	int node_num;
+	int xlow, ylow, xhigh, yhigh, ptc_num, fan_in;
+	int direction;
+	e_rr_type rr_type;
+	float R, C;
+	char rr_type_buf[20];
+
+	/* scan-in values from the node line. format: " node_%d: rr_type(%[^()]) xlow(%d) xhigh(%d) ylow(%d) yhigh(%d) ptc_num(%d) fan_in(%d) direction(%d) R(%f) C(%f)" */
+	scanner.expect(" node_");
+	node_num = scanner.read_int();
+	scanner.expect(": rr_type(");
+	scanner.read_token(rr_type_buf, sizeof(rr_type_buf), "()");
+	scanner.expect(") xlow(");
+	xlow = scanner.read_int();
+	scanner.expect(") xhigh(");
+	xhigh = scanner.read_int();
+	scanner.expect(") ylow(");
+	ylow = scanner.read_int();
+	scanner.expect(") yhigh(");
+	yhigh = scanner.read_int();
+	scanner.expect(") ptc_num(");
+	ptc_num = scanner.read_int();
+	scanner.expect(") fan_in(");
+	fan_in = scanner.read_int();
+	scanner.expect(") direction(");
+	direction = scanner.read_int();
+	scanner.expect(") R(");
+	R = scanner.read_float();
+	scanner.expect(") C(");
+	C = scanner.read_float();
+	scanner.expect(")");
+	scanner.next_line();
+
+	/* check rr type */
+	if (0 == strcmp(rr_type_buf, "SINK")){
+		rr_type = SINK;
+	} else if (0 == strcmp(rr_type_buf, "SOURCE")){
+		rr_type = SOURCE;
+	} else if (0 == strcmp(rr_type_buf, "IPIN")){
+		rr_type = IPIN;
+	} else if (0 == strcmp(rr_type_buf, "OPIN")){
+		rr_type = OPIN;
+	} else if (0 == strcmp(rr_type_buf, "CHANX")){
+		rr_type = CHANX;
+	} else if (0 == strcmp(rr_type_buf, "CHANY")){
+		rr_type = CHANY;
+	} else {
+		WTHROW(EX_INIT, "Unexpected rr_type: " << rr_type_buf);
+	}
 
-			if (iedge != edge_num){
-				WTHROW(EX_INIT, "Expected edges of dumped rr nodes to be printed in ascending order by index");
-			}
+	if (node_num < 0 || node_num >= num_rr_nodes){
+		WTHROW(EX_INIT, "Node index " << node_num << " is out of range of the " << num_rr_nodes << " nodes specified in the rr node section header");
+	}
 
-			rr_node[inode].out_edges[iedge] = edge;
-			rr_node[inode].out_switches[iedge] = sw;
+	/* assign values to rr node */
+	RR_Node &node = rr_node[node_num];
+	node.set_rr_type(rr_type);
+	node.set_coordinates(xlow, ylow, xhigh, yhigh);
+	node.set_R(R);
+	node.set_C(C);
+	node.set_ptc_num(ptc_num);
+	node.set_fan_in(fan_in);
+	node.set_direction((e_direction)direction);
+
+	/* the next line tells us how many edges there are */
+	scanner.expect("  .edges(");
+	int num_edges = scanner.read_int();
+	scanner.expect(")");
+	scanner.next_line();
+
+	/* the subsequent lines list all the edges, and which switch an edge uses. format: "   %d: edge(%d) switch(%d)" */
+	int iedge = 0;
+	while ( !scanner.line_is("  .end edges") ){
+		if (iedge >= num_edges){
+			WTHROW(EX_INIT, "Expected number of edges to not exceed " << num_edges);
+		}
 
-			iedge++;
-			getline(file, line);
+		scanner.expect(" ");
+		int edge_num = scanner.read_int();
+		scanner.expect(": edge(");
+		int edge = scanner.read_int();
+		scanner.expect(") switch(");
+		int sw = scanner.read_int();
+		scanner.expect(")");
+		scanner.next_line();
+
+		if (iedge != edge_num){
+			WTHROW(EX_INIT, "Expected edges of dumped rr nodes to be printed in ascending order by index");
 		}
 
-		inode++;
-		getline(file, line);
+		edges.push_back(edge);
+		switches.push_back((short)sw);
+
+		iedge++;
 	}
+	scanner.next_line();
+
+	return node_num;
 }
 
 /* parses rr switch section of file into created rr_switch_inf structure */
-static void parse_rr_switch_inf_section(int num_rr_switches, t_rr_switch_inf &rr_switch_inf, fstream &file){
+static void parse_rr_switch_inf_section(int num_rr_switches, t_rr_switch_inf &rr_switch_inf, Text_Scanner &file){
 
 	int iswitch = 0;
 	string line;
-	getline(file, line);		
+	file.get_line(line);		
 	/* parse the rr switch inf section */
 	while (line != ".end rr_switch"){
 
@@ -308,16 +531,16 @@ static void parse_rr_switch_inf_section(int num_rr_switches, t_rr_switch_inf &rr
 		rr_switch_inf[iswitch].set_buffered((bool)buffered);
 
 		iswitch++;
-		getline(file, line);		
+		file.get_line(line);		
 	}
 }
 
 /* parses block types section of file into created block_type structure */
-static void parse_block_type_section(int num_block_types, t_block_type &block_type, fstream &file){
+static void parse_block_type_section(int num_block_types, t_block_type &block_type, Text_Scanner &file){
 
 	int itype = 0;
 	string line;
-	getline(file, line);
+	file.get_line(line);
 	while(line != ".end block_type"){
 
 		int num_read, num_expected;
@@ -347,8 +570,8 @@ static void parse_block_type_section(int num_block_types, t_block_type &block_ty
 		/* next read-in the class info arrays */
 		block_type[itype].class_inf.assign(num_class, Pin_Class());
 		int iclass = 0;
-		getline(file, line);	//header line for class inf section
-		getline(file, line);	//first line in class inf section
+		file.get_line(line);	//header line for class inf section
+		file.get_line(line);	//first line in class inf section
 		while(line != "  .end classes"){
 			int class_num, pin_type, num_class_pins;
 
@@ -369,8 +592,8 @@ static void parse_block_type_section(int num_block_types, t_block_type &block_ty
 	
 			/* now read the pin list */
 			int ipin = 0;
-			getline(file, line);	//header line for pinlist section
-			getline(file, line);	//first line in pinlist section
+			file.get_line(line);	//header line for pinlist section
+			file.get_line(line);	//first line in pinlist section
 			while(line != "    .end pinlist"){
 
 				int pin_num, pin;
@@ -388,18 +611,18 @@ static void parse_block_type_section(int num_block_types, t_block_type &block_ty
 				block_type[itype].class_inf[iclass].pinlist[ipin] = pin;
 
 				ipin++;
-				getline(file, line);
+				file.get_line(line);
 			}
 
 			iclass++;
-			getline(file, line);
+			file.get_line(line);
 		}	
 
 		/* next read in which pin belongs to which class */
 		block_type[itype].pin_class.assign(num_pins, UNDEFINED);
 		int ipin = 0;
-		getline(file, line);	//header line for pin_class section
-		getline(file, line);	//first line of pin_class section
+		file.get_line(line);	//header line for pin_class section
+		file.get_line(line);	//first line of pin_class section
 		while(line != "  .end pin_class"){
 			int pin_num, pin_class;
 
@@ -415,14 +638,14 @@ static void parse_block_type_section(int num_block_types, t_block_type &block_ty
 			block_type[itype].pin_class[ipin] = pin_class;
 
 			ipin++;
-			getline(file, line);
+			file.get_line(line);
 		}
 		
 		/* finally, read in which pins are global */
 		block_type[itype].is_global_pin.assign(num_pins, true);
 		ipin = 0;
-		getline(file, line);	//header line for is_global_pin section
-		getline(file, line);	//first line of is_global_pin section
+		file.get_line(line);	//header line for is_global_pin section
+		file.get_line(line);	//first line of is_global_pin section
 		while(line != "  .end is_global_pin"){
 			int pin_num, is_global;
 
@@ -438,22 +661,22 @@ static void parse_block_type_section(int num_block_types, t_block_type &block_ty
 			block_type[itype].is_global_pin[ipin] = (bool) is_global;
 
 			ipin++;
-			getline(file, line);
+			file.get_line(line);
 		}
 
 		itype++;
-		getline(file, line);
+		file.get_line(line);
 	}
 }
 
 /* parses grid section of file into the created grid structure */
-static void parse_grid_section(int x_size, int y_size, t_grid &grid, fstream &file){
+static void parse_grid_section(int x_size, int y_size, t_grid &grid, Text_Scanner &file){
 	
 	int expected_grid_elements = x_size*y_size;
 	int read_grid_elements = 0;
 	
 	string line;
-	getline(file, line);	//first line of the grid section
+	file.get_line(line);	//first line of the grid section
 	while (line != ".end grid"){
 		int num_expected, num_read;
 		int x, y, block_type_index, width_offset, height_offset;
@@ -470,7 +693,7 @@ static void parse_grid_section(int x_size, int y_size, t_grid &grid, fstream &fi
 		grid[x][y].set_width_offset(width_offset);
 		grid[x][y].set_height_offset(height_offset);
 
-		getline(file, line);
+		file.get_line(line);
 		read_grid_elements++;
 	}
 	
@@ -481,50 +704,55 @@ static void parse_grid_section(int x_size, int y_size, t_grid &grid, fstream &fi
 
 
 /* parses rr node indices section of file into the created rr_node_index structure */
-static void parse_rr_node_index_section(int num_rr_types, int x_size, int y_size, t_rr_node_index &rr_node_index, fstream &file){
+static void parse_rr_node_index_section(int num_rr_types, int x_size, int y_size, t_rr_node_index &rr_node_index, Text_Scanner &file){
 
-	string line;
-	getline(file, line);	//first line of rr node index section
-	while(line != ".end rr_node_indices"){
-		
-		int num_expected, num_read;
-		int rr_type, x, y;
-
-		/* get the rr_type/x/y coordinate */
-		num_expected = 3;
-		num_read = sscanf(line.c_str(), " rr_node_index_type%d_x%d_y%d", 
-				&rr_type, &x, &y);
+	while( !file.line_is(".end rr_node_indices") ){
+		if (file.at_end()){
+			WTHROW(EX_INIT, "Could not find the end of the rr node indices section ('.end rr_node_indices')");
+		}
 
-		check_expected_vs_read(num_expected, num_read, line);
+		/* get the rr_type/x/y coordinate. format: " rr_node_index_type%d_x%d_y%d" */
+		file.expect(" rr_node_index_type");
+		int rr_type = file.read_int();
+		file.expect("_x");
+		int x = file.read_int();
+		file.expect("_y");
+		int y = file.read_int();
+		file.next_line();
+
+		if (rr_type < 0 || rr_type >= num_rr_types || x < 0 || x >= x_size || y < 0 || y >= y_size){
+			WTHROW(EX_INIT, "rr node index entry (type " << rr_type << ", x " << x << ", y " << y << ") is out of range");
+		}
 
 		/* what is the number of nodes this rr_type/x/y location? */
-		getline(file, line);
-		int num_nodes = 0;
-		num_expected = 1;
-		num_read = sscanf(line.c_str(), "  .nodes(%d)", &num_nodes);
-
-		check_expected_vs_read(num_expected, num_read, line);
+		file.expect("  .nodes(");
+		int num_nodes = file.read_int();
+		file.expect(")");
+		file.next_line();
 
 		/* create the node vector */
-		rr_node_index[rr_type][x][y].assign(num_nodes, UNDEFINED);
+		vector<int> &index_nodes = rr_node_index[rr_type][x][y];
+		index_nodes.assign(num_nodes, UNDEFINED);
 		
-		/* read in the list of nodes at this rr_type/x/y location */
-		getline(file, line);
-		while(line != "  .end nodes"){
-			int node_num, node;
-
-			num_expected = 2;
-			num_read = sscanf(line.c_str(), "   %d: %d", &node_num, &node);
-
-			check_expected_vs_read(num_expected, num_read, line);
-
-			rr_node_index[rr_type][x][y][node_num] = node;
+		/* read in the list of nodes at this rr_type/x/y location. format: "   %d: %d" */
+		while( !file.line_is("  .end nodes") ){
+			file.expect(" ");
+			int node_num = file.read_int();
+			file.expect(":");
+			int node = file.read_int();
+			file.next_line();
+
+			if (node_num < 0 || node_num >= num_nodes){
+				WTHROW(EX_INIT, "rr node index entry " << node_num << " is out of range of the " << num_nodes << " nodes at type " << rr_type <<
+				                ", x " << x << ", y " << y);
+			}
 
-			getline(file, line);
+			index_nodes[node_num] = node;
 		}
 
-		getline(file, line);
+		file.next_line();
 	}
+	file.next_line();
 }
 
 
@@ -540,56 +768,308 @@ static void check_expected_vs_read(int num_expected, int num_read, string line){
    for each node as a post-processing step. Do this for the pins specified by 'node_type'. if node_type == UNDEFINED,
    then do this for all nodes  */
 void initialize_reverse_node_edges_and_switches( Routing_Structs *routing_structs, int node_type ){
-	/* setting the incoming edges/switches for each node can be done in two passes over the graph. once to determine the list of switches/edges
-	   for each node, and once to set this information for each node */
+	/* the in-edge table is the transpose of the out-edge table. it is built in two passes over the out-edge table: once to count
+	   the incoming edges of each node, and once to fill them in */
 
 	int num_nodes = routing_structs->get_num_rr_nodes();
+	t_rr_node &rr_node = routing_structs->rr_node;
+	RR_Edge_Table &out_table = routing_structs->out_edge_table;
+	RR_Edge_Table &old_in_table = routing_structs->in_edge_table;
+	int num_out_table_nodes = out_table.get_num_nodes();
+	int num_old_in_table_nodes = old_in_table.get_num_nodes();
+
+	/* determine which nodes get new incoming edges/switches. the rest keep the ones they have */
+	vector<bool> set_node(num_nodes, true);
+	if (node_type != UNDEFINED){
+		for (int inode = 0; inode < num_nodes; inode++){
+			set_node[inode] = (rr_node[inode].get_rr_type() == (e_rr_type)node_type);
+		}
+	}
 
-	/* vector of vectors to hold incoming edges and switches for each node */
-	vector< vector<int> > inc_switches, inc_edges;
-	inc_switches.assign(num_nodes, vector<int>());
-	inc_edges.assign(num_nodes, vector<int>());
-
-	/* pass 1 - determine what the incoming edges/switches are for each node */
+	/* pass 1 - count the incoming edges of each node */
+	vector<int> num_inc_edges(num_nodes, 0);
+	for (int iedge = 0; iedge < out_table.get_num_edges(); iedge++){
+		num_inc_edges[ out_table.edges[iedge] ]++;
+	}
 	for (int inode = 0; inode < num_nodes; inode++){
-		int from_node_ind = inode;
-		RR_Node &rr_node = routing_structs->rr_node[from_node_ind];
-		
-		/* for each destination node mark which node the connection is coming from and which switch it uses */
-		for (int i_out_edge = 0; i_out_edge < rr_node.get_num_out_edges(); i_out_edge++){
-			int to_node_ind = rr_node.out_edges[i_out_edge];
-			int switch_ind = rr_node.out_switches[i_out_edge];
-
-			inc_switches[to_node_ind].push_back(switch_ind);
-			inc_edges[to_node_ind].push_back(from_node_ind);
+		if (!set_node[inode]){
+			num_inc_edges[inode] = (inode < num_old_in_table_nodes ? old_in_table.get_num_node_edges(inode) : 0);
 		}
 	}
 
-	/* pass 2 - allocate and set incoming switch/edge structures for each node */
-	for (int inode = 0; inode < num_nodes; inode++){
-		RR_Node *rr_node = &routing_structs->rr_node[inode];
+	RR_Edge_Table in_table;
+	in_table.alloc_from_edge_counts(num_inc_edges);
 
-		if (node_type != UNDEFINED){
-			/* skip nodes that aren't of 'node_type' */
-			if (rr_node->get_rr_type() != (e_rr_type)node_type){
+	/* pass 2 - for each destination node mark which node the connection is coming from and which switch it uses */
+	vector<int> next_edge(in_table.offsets.begin(), in_table.offsets.end()-1);
+	for (int from_node_ind = 0; from_node_ind < num_out_table_nodes; from_node_ind++){
+		for (int iedge = out_table.offsets[from_node_ind]; iedge < out_table.offsets[from_node_ind+1]; iedge++){
+			int to_node_ind = out_table.edges[iedge];
+			if (!set_node[to_node_ind]){
 				continue;
 			}
+
+			int ind = next_edge[to_node_ind]++;
+			in_table.edges[ind] = from_node_ind;
+			in_table.switches[ind] = out_table.switches[iedge];
+		}
+	}
+
+	/* nodes that aren't of 'node_type' keep their incoming edges/switches */
+	for (int inode = 0; inode < num_nodes; inode++){
+		if (!set_node[inode] && num_inc_edges[inode] > 0){
+			copy(old_in_table.edges.begin() + old_in_table.offsets[inode], old_in_table.edges.begin() + old_in_table.offsets[inode+1],
+			     in_table.edges.begin() + in_table.offsets[inode]);
+			copy(old_in_table.switches.begin() + old_in_table.offsets[inode], old_in_table.switches.begin() + old_in_table.offsets[inode+1],
+			     in_table.switches.begin() + in_table.offsets[inode]);
+		}
+	}
+
+	routing_structs->in_edge_table.swap(in_table);
+	routing_structs->link_rr_node_edges();
+}
+
+
+/*==== Mapped_File Class ====*/
+/* maps the specified file for reading */
+Mapped_File::Mapped_File(string path){
+	this->mapping = NULL;
+	this->data = NULL;
+	this->size = 0;
+
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0){
+		WTHROW(EX_OTHER, "Could not open file: " << path);
+	}
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0){
+		close(fd);
+		WTHROW(EX_OTHER, "Could not stat file: " << path);
+	}
+
+	this->size = (size_t)file_stat.st_size;
+	if (this->size > 0){
+		void *mapped = mmap(NULL, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapped == MAP_FAILED){
+			close(fd);
+			WTHROW(EX_OTHER, "Could not memory-map file: " << path);
+		}
+		this->mapping = mapped;
+		this->data = (const char*)mapped;
+	}
+	close(fd);
+}
+
+Mapped_File::~Mapped_File(){
+	if (this->mapping != NULL){
+		munmap(this->mapping, this->size);
+	}
+}
+/*==== END Mapped_File Class ====*/
+
+
+/*==== Text_Scanner Class ====*/
+Text_Scanner::Text_Scanner(const char *set_begin, const char *set_end){
+	this->begin = set_begin;
+	this->pos = set_begin;
+	this->end = set_end;
+}
+
+/* returns true if the whole region has been consumed */
+bool Text_Scanner::at_end() const{
+	return this->pos >= this->end;
+}
+
+/* returns current position within the mapped file */
+const char *Text_Scanner::get_pos() const{
+	return this->pos;
+}
+
+/* moves to the specified position within the region */
+void Text_Scanner::set_pos(const char *new_pos){
+	this->pos = new_pos;
+}
+
+/* returns pointer to the end of the current line (the '\n' character, or end of the region) */
+const char *Text_Scanner::get_line_end() const{
+	const char *line_end = (const char*)memchr(this->pos, '\n', this->end - this->pos);
+	if (line_end == NULL){
+		line_end = this->end;
+	}
+	return line_end;
+}
+
+/* throws an exception that shows the current line */
+void Text_Scanner::throw_scan_error(string what) const{
+	/* back up to the start of the line for the error message */
+	const char *line_begin = this->pos;
+	while (line_begin > this->begin && line_begin[-1] != '\n'){
+		line_begin--;
+	}
+	string line(line_begin, this->get_line_end() - line_begin);
+	WTHROW(EX_INIT, what << endl << "Line: " << line);
+}
+
+/* copies the current line into 'line' (without the newline) and moves to the next line. returns false if there are no more lines */
+bool Text_Scanner::get_line(string &line){
+	if (this->at_end()){
+		return false;
+	}
+
+	const char *line_end = this->get_line_end();
+	line.assign(this->pos, line_end - this->pos);
+	this->pos = min(line_end + 1, this->end);
+	return true;
+}
+
+/* moves to the start of the next line */
+void Text_Scanner::next_line(){
+	if ( !this->at_end() ){
+		this->pos = min(this->get_line_end() + 1, this->end);
+	}
+}
+
+/* returns true if the current line is exactly 'str' */
+bool Text_Scanner::line_is(const char *str) const{
+	size_t len = strlen(str);
+	if ((size_t)(this->end - this->pos) < len){
+		return false;
+	}
+	if (memcmp(this->pos, str, len) != 0){
+		return false;
+	}
+	return (this->pos + len == this->end || this->pos[len] == '\n');
+}
+
+/* returns the start of the first line at/after the current position that is exactly 'str', or NULL if there is no such line */
+const char *Text_Scanner::find_line(const char *str) const{
+	Text_Scanner scanner(this->pos, this->end);
+	while ( !scanner.at_end() ){
+		if ( scanner.line_is(str) ){
+			return scanner.get_pos();
 		}
+		scanner.next_line();
+	}
+	return NULL;
+}
 
-		int num_inc_edges = (int)inc_edges[inode].size();
+/* returns the start of the first line at/after 'from' that begins with 'prefix', or NULL if there is no such line */
+const char *Text_Scanner::find_line_starting_with(const char *from, const char *prefix) const{
+	size_t len = strlen(prefix);
 
-		rr_node->free_in_edges_and_switches();
+	/* 'from' may be in the middle of a line -- start searching at the next line start */
+	const char *line_begin = from;
+	if (line_begin > this->pos && line_begin[-1] != '\n'){
+		line_begin = (const char*)memchr(line_begin, '\n', this->end - line_begin);
+		if (line_begin == NULL){
+			return NULL;
+		}
+		line_begin++;
+	}
 
-		if (num_inc_edges > 0 && rr_node->get_num_in_edges() == UNDEFINED){
-			/* allocate the incoming switches/edges for this node */
-			rr_node->alloc_in_edges_and_switches( num_inc_edges );
+	while (line_begin < this->end){
+		if ((size_t)(this->end - line_begin) >= len && memcmp(line_begin, prefix, len) == 0){
+			return line_begin;
+		}
+		line_begin = (const char*)memchr(line_begin, '\n', this->end - line_begin);
+		if (line_begin == NULL){
+			return NULL;
+		}
+		line_begin++;
+	}
+	return NULL;
+}
 
-			/* set incoming switches/edges */
-			for (int iedge = 0; iedge < num_inc_edges; iedge++){
-				rr_node->in_edges[iedge] = inc_edges[inode][iedge];
-				rr_node->in_switches[iedge] = inc_switches[inode][iedge];
+/* consumes the specified literal. a space matches any number of spaces/tabs */
+void Text_Scanner::expect(const char *literal){
+	for (const char *c = literal; *c != '\0'; c++){
+		if (*c == ' '){
+			while (this->pos < this->end && (*this->pos == ' ' || *this->pos == '\t')){
+				this->pos++;
 			}
+		} else if (this->pos < this->end && *this->pos == *c){
+			this->pos++;
+		} else {
+			this->throw_scan_error("Expected '" + string(literal) + "'");
 		}
 	}
 }
 
+/* scans an integer */
+int Text_Scanner::read_int(){
+	this->expect(" ");
+
+	bool negative = false;
+	if (this->pos < this->end && (*this->pos == '-' || *this->pos == '+')){
+		negative = (*this->pos == '-');
+		this->pos++;
+	}
+
+	const char *digits_begin = this->pos;
+	long value = 0;
+	while (this->pos < this->end && *this->pos >= '0' && *this->pos <= '9'){
+		value = value*10 + (*this->pos - '0');
+		this->pos++;
+	}
+	if (this->pos == digits_begin){
+		this->throw_scan_error("Expected an integer");
+	}
+
+	return (int)(negative ? -value : value);
+}
+
+/* scans a floating point number. the number is converted with strtof, same as sscanf's %f */
+float Text_Scanner::read_float(){
+	this->expect(" ");
+
+	/* the mapped file isn't null-terminated, so copy the number into a local buffer */
+	char buf[MAX_NUMBER_TOKEN_LENGTH];
+	int length = 0;
+	while (this->pos + length < this->end && length < MAX_NUMBER_TOKEN_LENGTH-1 &&
+	       this->pos[length] != '\0' && strchr("0123456789+-.eEinfaINFA", this->pos[length]) != NULL){
+		buf[length] = this->pos[length];
+		length++;
+	}
+	buf[length] = '\0';
+
+	char *num_end;
+	float value = strtof(buf, &num_end);
+	if (num_end == buf){
+		this->throw_scan_error("Expected a number");
+	}
+	this->pos += (num_end - buf);
+
+	return value;
+}
+
+/* copies characters into 'buf' until one of the characters in 'delimiters' is hit */
+void Text_Scanner::read_token(char *buf, int buf_size, const char *delimiters){
+	int length = 0;
+	while (this->pos < this->end && *this->pos != '\n' && strchr(delimiters, *this->pos) == NULL){
+		if (length >= buf_size-1){
+			this->throw_scan_error("Token is too long");
+		}
+		buf[length] = *this->pos;
+		length++;
+		this->pos++;
+	}
+	if (length == 0){
+		this->throw_scan_error("Expected a token");
+	}
+	buf[length] = '\0';
+}
+/*==== END Text_Scanner Class ====*/
+
+
+/*==== Node_Chunk Class ====*/
+Node_Chunk::Node_Chunk(){
+	this->begin = NULL;
+	this->end = NULL;
+	this->rr_node = NULL;
+	this->num_rr_nodes = 0;
+	this->first_node = UNDEFINED;
+	this->num_nodes_parsed = 0;
+	this->failed = false;
+}
+/*==== END Node_Chunk Class ====*/
@@ -0,0 +1,628 @@
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "exception.h"
+#include "io.h"
+#include "wotan_types.h"
+#include "rr_graph_cache.h"
+
+using namespace std;
+
+
+/**** Defines ****/
+/* identifies a file as a Wotan rr graph cache */
+#define RR_GRAPH_CACHE_MAGIC "WOTANRRG"
+/* has to be incremented whenever the layout of the cache file changes */
+#define RR_GRAPH_CACHE_VERSION 1
+/* written to the cache header; reads back differently on a machine with different endianness */
+#define RR_GRAPH_CACHE_ENDIAN_MARKER 0x01020304
+
+
+/**** Classes ****/
+/* the header at the start of every cache file */
+class Cache_Header{
+public:
+	char magic[8];
+	uint32_t version;
+	uint32_t endian_marker;
+	uint32_t rr_structs_mode;
+	uint32_t num_rr_types;
+	uint64_t source_file_size;	/* size of the rr structs file from which the cache was created */
+	int64_t source_file_mtime;	/* modification time of the rr structs file from which the cache was created */
+	uint64_t cache_file_size;	/* total size of the cache file, used to detect truncated caches */
+};
+
+/* per-node record in the cache. edges and switches of all nodes are stored separately as flat arrays */
+class Cache_Node{
+public:
+	int32_t type;
+	int32_t direction;
+	int16_t xlow;
+	int16_t ylow;
+	int16_t xhigh;
+	int16_t yhigh;
+	int16_t ptc_num;
+	int16_t fan_in;
+	int16_t num_out_edges;
+	int16_t num_in_edges;
+	float R;
+	float C;
+	int32_t virtual_source_node_ind;
+	int32_t is_virtual_source;
+};
+
+/* sequentially writes values to a binary cache file */
+class Cache_Writer{
+private:
+	fstream file;
+public:
+	Cache_Writer(string path);
+
+	template<typename T> void write_value(const T &value);
+	template<typename T> void write_array(const T *values, int num_values);
+	void write_string(const string &str);
+	void close();
+};
+
+/* sequentially reads values out of a memory-mapped cache file */
+class Cache_Reader{
+private:
+	const char *data;
+	uint64_t size;
+	uint64_t offset;
+
+	/* throws an exception if 'num_bytes' more bytes can't be read */
+	void check_remaining(uint64_t num_bytes) const;
+public:
+	Cache_Reader(const char *set_data, uint64_t set_size);
+
+	template<typename T> T read_value();
+	template<typename T> void read_array(T *values, int num_values);
+	string read_string();
+	uint64_t get_offset() const;
+};
+
+
+/**** Function Declarations ****/
+/* gets size and modification time of the specified file. returns false if the file could not be stat'd */
+static bool get_file_stats(string path, uint64_t *size, int64_t *mtime);
+/* fills in the cache header according to the current rr structs file and mode */
+static void set_cache_header(Cache_Header &header, User_Options *user_opts);
+/* returns true if the header read from a cache file matches the current cache version, rr structs file and mode */
+static bool cache_header_is_current(Cache_Header &header, uint64_t mapped_size, User_Options *user_opts, string cache_file);
+/* writes/reads the block type and grid structures */
+static void write_arch_structs(Cache_Writer &writer, Arch_Structs *arch_structs);
+static void read_arch_structs(Cache_Reader &reader, Arch_Structs *arch_structs);
+/* writes/reads the rr node, rr switch and rr node index structures */
+static void write_routing_structs(Cache_Writer &writer, Routing_Structs *routing_structs);
+static void read_routing_structs(Cache_Reader &reader, Routing_Structs *routing_structs);
+
+
+/**** Function Definitions ****/
+/* Attempts to initialize the architecture and routing structures from the specified cache file. Returns false (leaving
+   the structures untouched) if the cache file does not exist, was written by a different cache version, or is stale w.r.t.
+   the user-specified rr structs file / mode. If no rr structs mode was specified by the user, it is taken from the cache */
+bool load_rr_graph_cache( string cache_file, User_Options *user_opts, Arch_Structs *arch_structs, Routing_Structs *routing_structs ){
+
+	int fd = open(cache_file.c_str(), O_RDONLY);
+	if (fd < 0){
+		cout << "No rr graph cache found at " << cache_file << endl;
+		return false;
+	}
+
+	struct stat cache_stat;
+	if (fstat(fd, &cache_stat) != 0 || (uint64_t)cache_stat.st_size < sizeof(Cache_Header)){
+		close(fd);
+		cout << "Ignoring invalid rr graph cache " << cache_file << endl;
+		return false;
+	}
+
+	uint64_t mapped_size = (uint64_t)cache_stat.st_size;
+	void *mapped = mmap(NULL, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapped == MAP_FAILED){
+		WTHROW(EX_INIT, "Could not memory-map rr graph cache: " << cache_file);
+	}
+
+	bool loaded = false;
+	try{
+		Cache_Reader reader((const char*)mapped, mapped_size);
+
+		Cache_Header header = reader.read_value<Cache_Header>();
+		if ( cache_header_is_current(header, mapped_size, user_opts, cache_file) ){
+			cout << "Loading rr graph cache (" << cache_file << ")" << endl;
+
+			if (user_opts->rr_structs_mode == RR_STRUCTS_UNDEFINED){
+				user_opts->rr_structs_mode = (e_rr_structs_mode)header.rr_structs_mode;
+			}
+
+			read_arch_structs(reader, arch_structs);
+			read_routing_structs(reader, routing_structs);
+
+			if (reader.get_offset() != mapped_size){
+				WTHROW(EX_INIT, "Unexpected trailing data in rr graph cache " << cache_file);
+			}
+			loaded = true;
+		}
+	} catch (Wotan_Exception &ex){
+		munmap(mapped, mapped_size);
+		throw;
+	}
+
+	munmap(mapped, mapped_size);
+
+	return loaded;
+}
+
+/* Writes the architecture and routing structures to the specified cache file. Should be called once reverse edges and
+   virtual sources have been created */
+void write_rr_graph_cache( string cache_file, User_Options *user_opts, Arch_Structs *arch_structs, Routing_Structs *routing_structs ){
+
+	cout << "Writing rr graph cache (" << cache_file << ")" << endl;
+
+	/* write to a temporary file first so that an interrupted write never leaves behind a partial cache */
+	string tmp_file = cache_file + ".tmp";
+
+	Cache_Header header;
+	set_cache_header(header, user_opts);
+
+	Cache_Writer writer(tmp_file);
+	writer.write_value(header);
+	write_arch_structs(writer, arch_structs);
+	write_routing_structs(writer, routing_structs);
+	writer.close();
+
+	/* now that the size of the cache is known, patch it into the header */
+	uint64_t cache_file_size;
+	int64_t cache_file_mtime;
+	if ( !get_file_stats(tmp_file, &cache_file_size, &cache_file_mtime) ){
+		WTHROW(EX_INIT, "Could not stat rr graph cache file " << tmp_file);
+	}
+	header.cache_file_size = cache_file_size;
+
+	fstream file;
+	open_file(&file, tmp_file, ios::in | ios::out | ios::binary);
+	file.seekp(0);
+	file.write((const char*)&header, sizeof(Cache_Header));
+	file.close();
+
+	if (rename(tmp_file.c_str(), cache_file.c_str()) != 0){
+		WTHROW(EX_INIT, "Could not move rr graph cache into place at " << cache_file);
+	}
+}
+
+
+/* gets size and modification time of the specified file. returns false if the file could not be stat'd */
+static bool get_file_stats(string path, uint64_t *size, int64_t *mtime){
+	struct stat file_stat;
+	if (stat(path.c_str(), &file_stat) != 0){
+		return false;
+	}
+
+	(*size) = (uint64_t)file_stat.st_size;
+	(*mtime) = (int64_t)file_stat.st_mtime;
+	return true;
+}
+
+/* fills in the cache header according to the current rr structs file and mode */
+static void set_cache_header(Cache_Header &header, User_Options *user_opts){
+	memset(&header, 0, sizeof(Cache_Header));
+	memcpy(header.magic, RR_GRAPH_CACHE_MAGIC, sizeof(header.magic));
+	header.version = RR_GRAPH_CACHE_VERSION;
+	header.endian_marker = RR_GRAPH_CACHE_ENDIAN_MARKER;
+	header.rr_structs_mode = (uint32_t)user_opts->rr_structs_mode;
+	header.num_rr_types = NUM_RR_TYPES;
+
+	if ( !get_file_stats(user_opts->rr_structs_file, &header.source_file_size, &header.source_file_mtime) ){
+		WTHROW(EX_INIT, "Could not stat rr structs file " << user_opts->rr_structs_file);
+	}
+}
+
+/* returns true if the header read from a cache file matches the current cache version, rr structs file and mode */
+static bool cache_header_is_current(Cache_Header &header, uint64_t mapped_size, User_Options *user_opts, string cache_file){
+	bool is_current = true;
+
+	if (memcmp(header.magic, RR_GRAPH_CACHE_MAGIC, sizeof(header.magic)) != 0){
+		WTHROW(EX_INIT, "File " << cache_file << " is not an rr graph cache");
+	}
+
+	if (header.version != RR_GRAPH_CACHE_VERSION || header.endian_marker != RR_GRAPH_CACHE_ENDIAN_MARKER ||
+	    header.num_rr_types != NUM_RR_TYPES){
+		cout << "Ignoring rr graph cache " << cache_file << " written by an incompatible version of Wotan" << endl;
+		is_current = false;
+	} else if (header.cache_file_size != mapped_size){
+		cout << "Ignoring truncated rr graph cache " << cache_file << endl;
+		is_current = false;
+	} else if (header.rr_structs_mode == RR_STRUCTS_UNDEFINED || header.rr_structs_mode >= NUM_RR_STRUCTS_MODES){
+		cout << "Ignoring rr graph cache " << cache_file << " with unrecognized rr structs mode" << endl;
+		is_current = false;
+	} else if (user_opts->rr_structs_mode != RR_STRUCTS_UNDEFINED && header.rr_structs_mode != (uint32_t)user_opts->rr_structs_mode){
+		cout << "Ignoring rr graph cache " << cache_file << " written in a different rr structs mode" << endl;
+		is_current = false;
+	} else if ( !user_opts->rr_structs_file.empty() ){
+		/* the cache has to have been created from the current version of the rr structs file */
+		uint64_t source_file_size;
+		int64_t source_file_mtime;
+		if ( !get_file_stats(user_opts->rr_structs_file, &source_file_size, &source_file_mtime) ){
+			WTHROW(EX_INIT, "Could not stat rr structs file " << user_opts->rr_structs_file);
+		}
+
+		if (source_file_size != header.source_file_size || source_file_mtime != header.source_file_mtime){
+			cout << "Ignoring stale rr graph cache " << cache_file << endl;
+			is_current = false;
+		}
+	}
+
+	return is_current;
+}
+
+
+/* writes the block type and grid structures */
+static void write_arch_structs(Cache_Writer &writer, Arch_Structs *arch_structs){
+	/* block types */
+	int num_block_types = arch_structs->get_num_block_types();
+	writer.write_value<int32_t>(num_block_types);
+	for (int itype = 0; itype < num_block_types; itype++){
+		Physical_Type_Descriptor &type = arch_structs->block_type[itype];
+
+		writer.write_string(type.get_name());
+		writer.write_value<int32_t>(type.get_index());
+		writer.write_value<int32_t>(type.get_num_pins());
+		writer.write_value<int32_t>(type.get_width());
+		writer.write_value<int32_t>(type.get_height());
+		writer.write_value<int32_t>(type.get_num_drivers());
+		writer.write_value<int32_t>(type.get_num_receivers());
+
+		int num_classes = (int)type.class_inf.size();
+		writer.write_value<int32_t>(num_classes);
+		for (int iclass = 0; iclass < num_classes; iclass++){
+			Pin_Class &pin_class = type.class_inf[iclass];
+			int num_class_pins = (int)pin_class.pinlist.size();
+
+			writer.write_value<int32_t>(pin_class.get_pin_type());
+			writer.write_value<int32_t>(num_class_pins);
+			for (int ipin = 0; ipin < num_class_pins; ipin++){
+				writer.write_value<int32_t>(pin_class.pinlist[ipin]);
+			}
+		}
+
+		int num_pin_class_entries = (int)type.pin_class.size();
+		writer.write_value<int32_t>(num_pin_class_entries);
+		for (int ipin = 0; ipin < num_pin_class_entries; ipin++){
+			writer.write_value<int32_t>(type.pin_class[ipin]);
+		}
+
+		int num_global_pin_entries = (int)type.is_global_pin.size();
+		writer.write_value<int32_t>(num_global_pin_entries);
+		for (int ipin = 0; ipin < num_global_pin_entries; ipin++){
+			writer.write_value<uint8_t>(type.is_global_pin[ipin] ? 1 : 0);
+		}
+	}
+
+	/* grid */
+	int grid_size_x, grid_size_y;
+	arch_structs->get_grid_size(&grid_size_x, &grid_size_y);
+	writer.write_value<int32_t>(grid_size_x);
+	writer.write_value<int32_t>(grid_size_y);
+	for (int ix = 0; ix < grid_size_x; ix++){
+		for (int iy = 0; iy < grid_size_y; iy++){
+			Grid_Tile &tile = arch_structs->grid[ix][iy];
+			writer.write_value<int32_t>(tile.get_type_index());
+			writer.write_value<int32_t>(tile.get_width_offset());
+			writer.write_value<int32_t>(tile.get_height_offset());
+		}
+	}
+}
+
+/* reads the block type and grid structures */
+static void read_arch_structs(Cache_Reader &reader, Arch_Structs *arch_structs){
+	/* block types */
+	int num_block_types = reader.read_value<int32_t>();
+	arch_structs->alloc_and_create_block_type(num_block_types);
+	for (int itype = 0; itype < num_block_types; itype++){
+		Physical_Type_Descriptor &type = arch_structs->block_type[itype];
+
+		type.set_name( reader.read_string() );
+		type.set_index( reader.read_value<int32_t>() );
+		type.set_num_pins( reader.read_value<int32_t>() );
+		type.set_width( reader.read_value<int32_t>() );
+		type.set_height( reader.read_value<int32_t>() );
+		type.set_num_drivers( reader.read_value<int32_t>() );
+		type.set_num_receivers( reader.read_value<int32_t>() );
+
+		int num_classes = reader.read_value<int32_t>();
+		type.class_inf.assign(num_classes, Pin_Class());
+		for (int iclass = 0; iclass < num_classes; iclass++){
+			Pin_Class &pin_class = type.class_inf[iclass];
+
+			pin_class.set_pin_type( (e_pin_type)reader.read_value<int32_t>() );
+			int num_class_pins = reader.read_value<int32_t>();
+			pin_class.pinlist.assign(num_class_pins, UNDEFINED);
+			reader.read_array<int32_t>((int32_t*)pin_class.pinlist.data(), num_class_pins);
+		}
+
+		int num_pin_class_entries = reader.read_value<int32_t>();
+		type.pin_class.assign(num_pin_class_entries, UNDEFINED);
+		reader.read_array<int32_t>((int32_t*)type.pin_class.data(), num_pin_class_entries);
+
+		int num_global_pin_entries = reader.read_value<int32_t>();
+		type.is_global_pin.assign(num_global_pin_entries, true);
+		for (int ipin = 0; ipin < num_global_pin_entries; ipin++){
+			type.is_global_pin[ipin] = (reader.read_value<uint8_t>() != 0);
+		}
+	}
+
+	/* grid */
+	int grid_size_x = reader.read_value<int32_t>();
+	int grid_size_y = reader.read_value<int32_t>();
+	arch_structs->alloc_and_create_grid(grid_size_x, grid_size_y);
+	for (int ix = 0; ix < grid_size_x; ix++){
+		for (int iy = 0; iy < grid_size_y; iy++){
+			Grid_Tile &tile = arch_structs->grid[ix][iy];
+			tile.set_type_index( reader.read_value<int32_t>() );
+			tile.set_width_offset( reader.read_value<int32_t>() );
+			tile.set_height_offset( reader.read_value<int32_t>() );
+		}
+	}
+
+	/* the fill type is derived from the grid, same as when parsing the structs file */
+	if (grid_size_x > 0){
+		arch_structs->set_fill_type();
+	}
+}
+
+/* writes the rr node, rr switch and rr node index structures */
+static void write_routing_structs(Cache_Writer &writer, Routing_Structs *routing_structs){
+	t_rr_node &rr_node = routing_structs->rr_node;
+	int num_nodes = routing_structs->get_num_rr_nodes();
+
+	/* rr nodes. the node records come first, followed by the flattened out-edge/switch and in-edge/switch arrays of all nodes */
+	writer.write_value<int32_t>(num_nodes);
+	int64_t total_out_edges = 0;
+	int64_t total_in_edges = 0;
+	for (int inode = 0; inode < num_nodes; inode++){
+		RR_Node &node = rr_node[inode];
+
+		Cache_Node record;
+		memset(&record, 0, sizeof(Cache_Node));
+		record.type = node.get_rr_type();
+		record.direction = node.get_direction();
+		record.xlow = node.get_xlow();
+		record.ylow = node.get_ylow();
+		record.xhigh = node.get_xhigh();
+		record.yhigh = node.get_yhigh();
+		record.ptc_num = node.get_ptc_num();
+		record.fan_in = node.get_fan_in();
+		record.num_out_edges = max((short)0, node.get_num_out_edges());
+		record.num_in_edges = max((short)0, node.get_num_in_edges());
+		record.R = node.get_R();
+		record.C = node.get_C();
+		record.virtual_source_node_ind = node.get_virtual_source_node_ind();
+		record.is_virtual_source = node.get_is_virtual_source() ? 1 : 0;
+		writer.write_value(record);
+
+		total_out_edges += record.num_out_edges;
+		total_in_edges += record.num_in_edges;
+	}
+
+	/* the edge tables store the edges of all nodes back-to-back, in node order */
+	RR_Edge_Table &out_table = routing_structs->out_edge_table;
+	RR_Edge_Table &in_table = routing_structs->in_edge_table;
+	if (total_out_edges != out_table.get_num_edges() || total_in_edges != in_table.get_num_edges()){
+		WTHROW(EX_INIT, "Edge tables are inconsistent with the rr nodes");
+	}
+
+	writer.write_value<int64_t>(total_out_edges);
+	writer.write_array<int32_t>(out_table.edges.data(), out_table.get_num_edges());
+	writer.write_array<int16_t>(out_table.switches.data(), out_table.get_num_edges());
+
+	writer.write_value<int64_t>(total_in_edges);
+	writer.write_array<int32_t>(in_table.edges.data(), in_table.get_num_edges());
+	writer.write_array<int16_t>(in_table.switches.data(), in_table.get_num_edges());
+
+	/* rr switches */
+	int num_switches = (int)routing_structs->rr_switch_inf.size();
+	writer.write_value<int32_t>(num_switches);
+	for (int iswitch = 0; iswitch < num_switches; iswitch++){
+		RR_Switch_Inf &rr_switch = routing_structs->rr_switch_inf[iswitch];
+		writer.write_value<uint8_t>(rr_switch.get_buffered() ? 1 : 0);
+		writer.write_value<float>(rr_switch.get_R());
+		writer.write_value<float>(rr_switch.get_Cin());
+		writer.write_value<float>(rr_switch.get_Cout());
+		writer.write_value<float>(rr_switch.get_Tdel());
+		writer.write_value<float>(rr_switch.get_mux_trans_size());
+		writer.write_value<float>(rr_switch.get_buf_size());
+	}
+
+	/* rr node indices */
+	t_rr_node_index &rr_node_index = routing_structs->rr_node_index;
+	int num_rr_types = (int)rr_node_index.size();
+	int x_size = (num_rr_types > 0 ? (int)rr_node_index[0].size() : 0);
+	int y_size = (x_size > 0 ? (int)rr_node_index[0][0].size() : 0);
+	writer.write_value<int32_t>(num_rr_types);
+	writer.write_value<int32_t>(x_size);
+	writer.write_value<int32_t>(y_size);
+	for (int itype = 0; itype < num_rr_types; itype++){
+		for (int ix = 0; ix < x_size; ix++){
+			for (int iy = 0; iy < y_size; iy++){
+				vector<int> &nodes = rr_node_index[itype][ix][iy];
+				writer.write_value<int32_t>((int)nodes.size());
+				writer.write_array<int32_t>((const int32_t*)nodes.data(), (int)nodes.size());
+			}
+		}
+	}
+}
+
+/* reads the rr node, rr switch and rr node index structures */
+static void read_routing_structs(Cache_Reader &reader, Routing_Structs *routing_structs){
+	t_rr_node &rr_node = routing_structs->rr_node;
+
+	/* rr nodes */
+	int num_nodes = reader.read_value<int32_t>();
+	routing_structs->alloc_and_create_rr_node(num_nodes);
+	vector<int> num_out_edges(num_nodes, 0);
+	vector<int> num_in_edges(num_nodes, 0);
+	for (int inode = 0; inode < num_nodes; inode++){
+		RR_Node &node = rr_node[inode];
+		Cache_Node record = reader.read_value<Cache_Node>();
+
+		node.set_rr_type( (e_rr_type)record.type );
+		node.set_direction( (e_direction)record.direction );
+		node.set_coordinates(record.xlow, record.ylow, record.xhigh, record.yhigh);
+		node.set_ptc_num(record.ptc_num);
+		node.set_fan_in(record.fan_in);
+		node.set_R(record.R);
+		node.set_C(record.C);
+		node.set_virtual_source_node_ind(record.virtual_source_node_ind);
+		node.set_is_virtual_source(record.is_virtual_source != 0);
+
+		num_out_edges[inode] = max((int16_t)0, record.num_out_edges);
+		num_in_edges[inode] = max((int16_t)0, record.num_in_edges);
+	}
+
+	/* the edge arrays are stored in node order, so they are read straight into the edge tables */
+	RR_Edge_Table &out_table = routing_structs->out_edge_table;
+	RR_Edge_Table &in_table = routing_structs->in_edge_table;
+	out_table.alloc_from_edge_counts(num_out_edges);
+	in_table.alloc_from_edge_counts(num_in_edges);
+
+	int64_t total_out_edges = reader.read_value<int64_t>();
+	if (total_out_edges != out_table.get_num_edges()){
+		WTHROW(EX_INIT, "Edge counts in rr graph cache are inconsistent with node records");
+	}
+	reader.read_array<int32_t>(out_table.edges.data(), out_table.get_num_edges());
+	reader.read_array<int16_t>(out_table.switches.data(), out_table.get_num_edges());
+
+	int64_t total_in_edges = reader.read_value<int64_t>();
+	if (total_in_edges != in_table.get_num_edges()){
+		WTHROW(EX_INIT, "Edge counts in rr graph cache are inconsistent with node records");
+	}
+	reader.read_array<int32_t>(in_table.edges.data(), in_table.get_num_edges());
+	reader.read_array<int16_t>(in_table.switches.data(), in_table.get_num_edges());
+
+	routing_structs->link_rr_node_edges();
+
+	/* rr switches */
+	int num_switches = reader.read_value<int32_t>();
+	routing_structs->alloc_and_create_rr_switch_inf(num_switches);
+	for (int iswitch = 0; iswitch < num_switches; iswitch++){
+		RR_Switch_Inf &rr_switch = routing_structs->rr_switch_inf[iswitch];
+		rr_switch.set_buffered( reader.read_value<uint8_t>() != 0 );
+		rr_switch.set_R( reader.read_value<float>() );
+		rr_switch.set_Cin( reader.read_value<float>() );
+		rr_switch.set_Cout( reader.read_value<float>() );
+		rr_switch.set_Tdel( reader.read_value<float>() );
+		rr_switch.set_mux_trans_size( reader.read_value<float>() );
+		rr_switch.set_buf_size( reader.read_value<float>() );
+	}
+
+	/* rr node indices */
+	int num_rr_types = reader.read_value<int32_t>();
+	int x_size = reader.read_value<int32_t>();
+	int y_size = reader.read_value<int32_t>();
+	if (num_rr_types > 0){
+		routing_structs->alloc_and_create_rr_node_index(num_rr_types, x_size, y_size);
+	}
+	t_rr_node_index &rr_node_index = routing_structs->rr_node_index;
+	for (int itype = 0; itype < num_rr_types; itype++){
+		for (int ix = 0; ix < x_size; ix++){
+			for (int iy = 0; iy < y_size; iy++){
+				vector<int> &nodes = rr_node_index[itype][ix][iy];
+				int num_index_nodes = reader.read_value<int32_t>();
+				nodes.assign(num_index_nodes, UNDEFINED);
+				reader.read_array<int32_t>((int32_t*)nodes.data(), num_index_nodes);
+			}
+		}
+	}
+}
+
+
+/*==== Cache_Writer Class ====*/
+Cache_Writer::Cache_Writer(string path){
+	open_file(&this->file, path, ios::out | ios::binary | ios::trunc);
+}
+
+/* writes a single value */
+template<typename T> void Cache_Writer::write_value(const T &value){
+	this->file.write((const char*)&value, sizeof(T));
+}
+
+/* writes an array of values */
+template<typename T> void Cache_Writer::write_array(const T *values, int num_values){
+	if (num_values > 0){
+		this->file.write((const char*)values, sizeof(T) * num_values);
+	}
+}
+
+/* writes a length-prefixed string */
+void Cache_Writer::write_string(const string &str){
+	this->write_value<uint32_t>((uint32_t)str.size());
+	this->write_array<char>(str.data(), (int)str.size());
+}
+
+/* flushes and closes the cache file */
+void Cache_Writer::close(){
+	this->file.flush();
+	if (!this->file.good()){
+		WTHROW(EX_INIT, "Failed to write rr graph cache");
+	}
+	this->file.close();
+}
+/*==== END Cache_Writer Class ====*/
+
+
+/*==== Cache_Reader Class ====*/
+Cache_Reader::Cache_Reader(const char *set_data, uint64_t set_size){
+	this->data = set_data;
+	this->size = set_size;
+	this->offset = 0;
+}
+
+/* throws an exception if 'num_bytes' more bytes can't be read */
+void Cache_Reader::check_remaining(uint64_t num_bytes) const{
+	if (num_bytes > this->size - this->offset){
+		WTHROW(EX_INIT, "Unexpected end of rr graph cache at offset " << this->offset);
+	}
+}
+
+/* reads a single value. values are copied out of the mapping since they are not necessarily aligned */
+template<typename T> T Cache_Reader::read_value(){
+	T value;
+	this->check_remaining(sizeof(T));
+	memcpy(&value, this->data + this->offset, sizeof(T));
+	this->offset += sizeof(T);
+	return value;
+}
+
+/* reads an array of values into 'values' */
+template<typename T> void Cache_Reader::read_array(T *values, int num_values){
+	if (num_values <= 0){
+		return;
+	}
+	uint64_t num_bytes = sizeof(T) * (uint64_t)num_values;
+	this->check_remaining(num_bytes);
+	memcpy(values, this->data + this->offset, num_bytes);
+	this->offset += num_bytes;
+}
+
+/* reads a length-prefixed string */
+string Cache_Reader::read_string(){
+	uint32_t length = this->read_value<uint32_t>();
+	this->check_remaining(length);
+	string str(this->data + this->offset, length);
+	this->offset += length;
+	return str;
+}
+
+/* returns the number of bytes read so far */
+uint64_t Cache_Reader::get_offset() const{
+	return this->offset;
+}
+/*==== END Cache_Reader Class ====*/
@@ -0,0 +1,31 @@
+#ifndef RR_GRAPH_CACHE_H
+#define RR_GRAPH_CACHE_H
+
+#include <string>
+#include "wotan_types.h"
+
+/*
+	The rr graph cache is a versioned binary image of Wotan's architecture and routing structures as they
+exist at the end of graph initialization -- that is, *after* reverse edges have been computed and virtual
+sources have been created. Parsing a text structs dump involves a getline/sscanf call for every node, edge
+and index entry; the cache instead stores these structures as flat arrays which are read back through
+a memory mapping of the cache file.
+
+	A cache records the rr structs mode as well as the size and modification time of the rr structs file
+from which it was created. A cache that doesn't match the rr structs file specified on the command line
+is considered stale and is ignored (and rewritten).
+*/
+
+
+/**** Function Declarations ****/
+/* Attempts to initialize the architecture and routing structures from the specified cache file. Returns false (leaving
+   the structures untouched) if the cache file does not exist, was written by a different cache version, or is stale w.r.t.
+   the user-specified rr structs file / mode. If no rr structs mode was specified by the user, it is taken from the cache */
+bool load_rr_graph_cache( std::string cache_file, User_Options *user_opts, Arch_Structs *arch_structs, Routing_Structs *routing_structs );
+
+/* Writes the architecture and routing structures to the specified cache file. Should be called once reverse edges and
+   virtual sources have been created */
+void write_rr_graph_cache( std::string cache_file, User_Options *user_opts, Arch_Structs *arch_structs, Routing_Structs *routing_structs );
+
+
+#endif
@@ -492,11 +492,17 @@ class Wotan_Tester:
 				target_regex = None,
 				demand_mult_low = 0.0,
 				demand_mult_high = 10,
-				max_tries = 30):
+				max_tries = 30,
+				demand_mult_guess = None):	#if not None, the search starts here (i.e. the result for a similar architecture)
 		
 		if '-demand_multiplier' in wotan_opts:
 			print('-demand_multiplier option already included in wotan_opts -- can\'t do binary search for pin demand')
 			sys.exit()
+
+		#only parse the rr structs file on the first iteration of the search; later iterations load the binary rr graph cache
+		if '-rr_graph_cache' not in wotan_opts and '-rr_structs_file' in wotan_opts:
+			rr_structs_file = wotan_opts.split('-rr_structs_file')[1].split()[0]
+			wotan_opts = wotan_opts + ' -rr_graph_cache ' + rr_structs_file + '.cache'
 		
 		#true if increasing, false if decreasing
 		monotonic_increasing = True
@@ -520,6 +526,23 @@ class Wotan_Tester:
 			print('unexpected test_type passed-in to binary search: ' + test_type)
 			sys.exit()
 
+		#wotan can search for the routability metric itself, which avoids reading the rr graph and starting wotan for every try
+		if test_type == 'binary_search_routability_metric':
+			search_opts = ' -search_for_reliability ' + str(target) + ' -search_tolerance ' + str(target_tolerance)
+			if demand_mult_guess:
+				search_opts += ' -search_start_multiplier ' + str(demand_mult_guess)
+			#wotan's search stays within the same bracket and number of tries as the binary search below
+			if demand_mult_low > 0:
+				search_opts += ' -search_min_multiplier ' + str(demand_mult_low)
+			search_opts += ' -search_max_multiplier ' + str(demand_mult_high) + ' -search_max_tries ' + str(max_tries)
+
+			self.make_wotan()
+			wotan_out = self.run_wotan(wotan_opts + search_opts)
+			current = float( regex_last_token(wotan_out, '.*search_result: .*reliability=(\d*\.*\d+).*') )
+			demand_mult_current = float( regex_last_token(wotan_out, '.*search_result: demand_multiplier=(\d*\.*\d+).*') )
+			print( '\tat demand mult ' + str(demand_mult_current) + ' current val is ' + str(current) )
+			return (current, demand_mult_current, wotan_out)
+
 
 		current = 0
 		wotan_out = ''
@@ -638,6 +661,9 @@ class Wotan_Tester:
 		wotan_results = []
 		vpr_results = []
 
+		#the demand multiplier found for the previous channel width / architecture is used as the starting point of the next search
+		prev_demand_mult = None
+
 		#for each architecture point:
 		#- evaluate with wotan 
 		#- evaluate with VPR if enabled
@@ -672,12 +698,13 @@ class Wotan_Tester:
 												       target = target_prob,
 												       target_tolerance = target_tolerance,
 												       target_regex = target_regex,
-												       demand_mult_high = 200)
+												       demand_mult_high = 200,
+												       demand_mult_guess = prev_demand_mult)
+				prev_demand_mult = demand_mult
 
 				#get metric used for evaluating the architecture
-				metric_regex = '.*Demand multiplier: (\d*\.*\d+).*'		#TODO: put this value into arch point info based on test suites? don't want to be hard-coding...
 				metric_label = 'Demand Multiplier'
-				metric_value_list += [float(regex_last_token(wotan_out, metric_regex))]
+				metric_value_list += [demand_mult]
 
 			#add metric to list of wotan results
 			metric_value = get_geomean(metric_value_list)